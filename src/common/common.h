@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <memory>
@@ -146,6 +147,81 @@ struct DateTime{
     }
 };
 
+/**
+ * @description: 16字节的定长值，执行器热路径上代替Value使用
+ * 数值类型直接保存在union中，字符串只保存指向记录或常量的指针和长度，不复制，
+ * 因此ValueRef的生命周期不能超过它所指向的记录或Value
+ */
+struct ValueRef {
+    ColType type;       // 值的类型
+    int len;            // 字符串的最大长度，遇到'\0'提前结束
+    union {
+        int int_val;
+        float float_val;
+        int64_t bigint_val;
+        uint64_t datetime_val;  // DateTime::encode()的结果，可以直接比较大小
+        const char *str_val;
+    };
+
+    // 从记录中的字段构造，data指向字段起始位置
+    static ValueRef from_raw(const char *data, ColType type, int len) {
+        ValueRef ret;
+        ret.type = type;
+        ret.len = len;
+        switch (type) {
+            case TYPE_INT: memcpy(&ret.int_val, data, sizeof(int)); break;
+            case TYPE_FLOAT: memcpy(&ret.float_val, data, sizeof(float)); break;
+            case TYPE_BIGINT: memcpy(&ret.bigint_val, data, sizeof(int64_t)); break;
+            case TYPE_DATETIME: memcpy(&ret.datetime_val, data, sizeof(uint64_t)); break;
+            case TYPE_STRING: ret.str_val = data; break;
+            default: throw InvalidTypeError();
+        }
+        return ret;
+    }
+};
+
+static_assert(sizeof(ValueRef) == 16, "ValueRef should stay 16 bytes");
+
+/**
+ * @description: 比较两个ValueRef
+ * @return {int} 小于0表示lhs<rhs，等于0表示相等，大于0表示lhs>rhs
+ * 类型相同时只需要一次分派，int/float/bigint之间的比较和Value的比较运算符语义相同，
+ * 字符串按C字符串比较，补齐的'\0'不影响结果
+ */
+inline int compare_value_ref(const ValueRef &lhs, const ValueRef &rhs) {
+    if (lhs.type == rhs.type) {
+        switch (lhs.type) {
+            case TYPE_INT: return (lhs.int_val > rhs.int_val) - (lhs.int_val < rhs.int_val);
+            case TYPE_FLOAT: return (lhs.float_val > rhs.float_val) - (lhs.float_val < rhs.float_val);
+            case TYPE_BIGINT: return (lhs.bigint_val > rhs.bigint_val) - (lhs.bigint_val < rhs.bigint_val);
+            case TYPE_DATETIME: return (lhs.datetime_val > rhs.datetime_val) - (lhs.datetime_val < rhs.datetime_val);
+            case TYPE_STRING: {
+                size_t lhs_len = strnlen(lhs.str_val, lhs.len);
+                size_t rhs_len = strnlen(rhs.str_val, rhs.len);
+                int res = memcmp(lhs.str_val, rhs.str_val, std::min(lhs_len, rhs_len));
+                if (res != 0) {
+                    return res;
+                }
+                return (lhs_len > rhs_len) - (lhs_len < rhs_len);
+            }
+            default: throw InvalidTypeError();
+        }
+    }
+    if (!check_type(lhs.type, rhs.type)) {
+        throw IncompatibleTypeError(coltype2str(lhs.type), coltype2str(rhs.type));
+    }
+    if (lhs.type == TYPE_FLOAT || rhs.type == TYPE_FLOAT) {
+        // int和float比较
+        double l = lhs.type == TYPE_FLOAT ? lhs.float_val : lhs.int_val;
+        double r = rhs.type == TYPE_FLOAT ? rhs.float_val : rhs.int_val;
+        return (l > r) - (l < r);
+    }
+    // int和bigint比较
+    int64_t l = lhs.type == TYPE_BIGINT ? lhs.bigint_val : lhs.int_val;
+    int64_t r = rhs.type == TYPE_BIGINT ? rhs.bigint_val : rhs.int_val;
+    return (l > r) - (l < r);
+}
+
 struct Value {
     ColType type;  // type of value
     union {
@@ -255,6 +331,22 @@ struct Value {
         }
     }
 
+    // 转换为ValueRef，字符串指向str_val，返回值不能比当前Value活得更久
+    ValueRef ref() const {
+        ValueRef ret;
+        ret.type = type;
+        ret.len = 0;
+        switch (type) {
+            case TYPE_INT: ret.int_val = int_val; break;
+            case TYPE_FLOAT: ret.float_val = float_val; break;
+            case TYPE_BIGINT: ret.bigint_val = bigint_val; break;
+            case TYPE_DATETIME: ret.datetime_val = datetime_val.encode(); break;
+            case TYPE_STRING: ret.str_val = str_val.c_str(); ret.len = str_val.size(); break;
+            default: throw InvalidTypeError();
+        }
+        return ret;
+    }
+
     // 重载value的比较运算符 > < == != >= <=
     bool operator>(const Value& rhs) const {
         if (!check_type(type, rhs.type)) {
@@ -505,6 +597,9 @@ struct Condition {
     bool is_rhs_val;  // true if right-hand side is a value (not a column)
     TabCol rhs_col;   // right-hand side column
     Value rhs_val;    // right-hand side value
+
+    // 右侧常量的定长表示，每次调用时由rhs_val生成，因此Condition被复制后依然有效
+    ValueRef rhs_ref() const { return rhs_val.ref(); }
 };
 
 struct SetClause {
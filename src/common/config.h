@@ -36,6 +36,13 @@ static constexpr int BUFFER_POOL_SIZE = 262144;                                /
 // static constexpr int BUFFER_POOL_SIZE = 262144;                                // size of buffer pool 1GB
 static constexpr int LOG_BUFFER_SIZE = (1024 * PAGE_SIZE);                    // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int VACUUM_BATCH_SIZE = 256;                                 // vacuum每一批最多搬移的记录个数
+static constexpr int IX_DEFAULT_FILL_FACTOR = 90;                             // 索引默认的填充率(%)，批量建树和顺序插入时最右结点的分裂都按它填充
+static constexpr size_t IX_BULK_SORT_BUFFER_SIZE = 64 * 1024 * 1024;          // 批量建索引时内存排序的最大字节数，超出部分写入临时文件
+static constexpr double IX_COMPACT_FILL_THRESHOLD = 0.5;                      // vacuum时叶子平均填充率低于该值的B+树索引重建
+static constexpr int IX_SKIP_SCAN_STEPS = 256;                                 // 跳跃扫描换到首字段的下一个取值时，先顺序向后看的键值对个数（约一片叶子），仍没找到再从根结点重新定位
+static constexpr int IX_STATS_SAMPLE_LEAVES = 1024;                            // show index stats最多读取的叶子个数，叶子更多时抽样估计
+static constexpr int IX_ART_RECLAIM_BATCH = 64;                               // ART索引退役的结点攒够这么多个之后尝试推进epoch并回收
 
 using frame_id_t = int32_t;  // frame id type, 帧页ID, 页在BufferPool中的存储单元称为帧,一帧对应一页
 using page_id_t = int32_t;   // page id type , 页ID
@@ -47,6 +47,7 @@ struct ColDef {
     std::string name;  // Column name
     ColType type;      // Type of column
     int len;           // Length of column
+    bool dict = false; // Whether the column is dictionary encoded
 };
 
 // 定义了check type
@@ -31,6 +31,9 @@ private:
         // 对外输出的cols需要将offset修正为0
         std::vector<ColMeta> output_cols_;
         bool is_end_;
+        // MIN/MAX直接取索引区间的端点时使用，此时没有rids_
+        bool use_index_ = false;
+        IndexMeta index_meta_;
 
 public:
         AggregationExecutor(SmManager *sm_manager, const std::string &tab_name, std::vector<Condition> conds, AggreMeta aggre_meta, std::vector<Rid> rids, Context *context)
@@ -43,19 +46,32 @@ public:
                 conds_ = conds;
                 rids_ = rids;
                 context_ = context;
-                if(aggre_meta_.op_ == AG_COUNT) {
-                        ColMeta col_meta_ = {.tab_name = tab_name_, .name = "*", .type = TYPE_INT, .len = sizeof(int), .offset = 0, .index = false};
-                        output_cols_.push_back(col_meta_);
-                }else {
-                        ColMeta col_meta_ = *tab_.get_col(aggre_meta_.tabcol_.col_name);
-                        // 对外输出的col_meta需要修改offset字段
-                        col_meta_.offset = 0;
-                        output_cols_.push_back(col_meta_);
-                }
+                init_output_cols();
                 
                 is_end_ = false;
         }
 
+        // MIN/MAX(col)，index_meta中col之前的字段都有等值条件，其余条件都是col上的范围条件
+        AggregationExecutor(SmManager *sm_manager, const std::string &tab_name, std::vector<Condition> conds, AggreMeta aggre_meta, IndexMeta index_meta, Context *context)
+        {
+                aggre_meta_ = aggre_meta;
+                sm_manager_ = sm_manager;
+                tab_name_ = tab_name;
+                tab_ = sm_manager_->db_.get_table(tab_name);
+                fh_ = sm_manager_->fhs_.at(tab_name).get();
+                conds_ = std::move(conds);
+                context_ = context;
+                use_index_ = true;
+                index_meta_ = std::move(index_meta);
+                init_output_cols();
+                // 不经过扫描算子，需要自己加表的S锁，同时阻塞vacuum搬移记录和compact索引
+                if(context_ != nullptr) {
+                        context_->lock_mgr_->lock_shared_on_table_wait_time(context_->txn_, fh_->GetFd());
+                }
+
+                is_end_ = false;
+        }
+
         // conds_条件已经在scan里用过了，现在直接用rids_即可
         std::unique_ptr<RmRecord> Next() override
         {
@@ -69,6 +85,10 @@ public:
         std::string getType() { return "AggregationExecutor"; };
 
         void beginTuple() override {
+                if(use_index_) {
+                        index_endpoint();
+                        return;
+                }
 
 
                 switch (aggre_meta_.op_)
@@ -85,10 +105,11 @@ public:
                         float sum_float_value = 0;
                         auto col_meta = tab_.get_col(aggre_meta_.tabcol_.col_name);
                         int offset = col_meta->offset;
-                        // int len = col_meta->len;
+                        int len = col_meta->len;
+                        // 只读取聚合字段，PAX布局下不需要拼出整条记录
+                        char data[len];
                         for(auto &rid: rids_){
-                                auto rec = fh_->get_record(rid, nullptr);
-                                char *data = rec->data + offset;
+                                fh_->get_field(rid, offset, len, data);
                                 if(col_meta->type == TYPE_INT){
                                         int value = *reinterpret_cast<int *>(data);
                                         sum_int_value += value;
@@ -125,12 +146,12 @@ public:
                         auto col_meta = tab_.get_col(aggre_meta_.tabcol_.col_name);
                         int offset = col_meta->offset;
                         int len = col_meta->len;
+                        char data[len];
                         switch(col_meta->type){
                                 case TYPE_INT:{
                                         int max_value = INT_MIN;
                                         for(auto &rid: rids_){
-                                                auto rec = fh_->get_record(rid, nullptr);
-                                                char *data = rec->data + offset;
+                                                fh_->get_field(rid, offset, len, data);
                                                 int value = *reinterpret_cast<int *>(data);
                                                 if(value > max_value){
                                                         max_value = value;
@@ -145,8 +166,7 @@ public:
                                        
                                         float max_value = FLT_MIN;
                                         for(auto &rid: rids_){
-                                                auto rec = fh_->get_record(rid, nullptr);
-                                                char *data = rec->data + offset;
+                                                fh_->get_field(rid, offset, len, data);
                                                 float value = *reinterpret_cast<float *>(data);
                                                 if(value > max_value){
                                                         max_value = value;
@@ -161,8 +181,7 @@ public:
                                         auto rec_begin = fh_->get_record(*rids_.begin(), nullptr);
                                         std::string max_value(rec_begin->data+offset,len);
                                         for (auto &rid : rids_) {
-                                                auto rec = fh_->get_record(rid, nullptr);
-                                                char *data = rec->data + offset;
+                                                fh_->get_field(rid, offset, len, data);
                                                 std::string value(data, len);
                                                 if (value > max_value) {
                                                         max_value.assign(value);
@@ -188,12 +207,12 @@ public:
                         auto col_meta = tab_.get_col(aggre_meta_.tabcol_.col_name);
                         int offset = col_meta->offset;
                         int len = col_meta->len;
+                        char data[len];
                         switch(col_meta->type){
                                 case TYPE_INT:{
                                         int min_value = INT_MAX;
                                         for(auto &rid: rids_){
-                                                auto rec = fh_->get_record(rid, nullptr);
-                                                char *data = rec->data + offset;
+                                                fh_->get_field(rid, offset, len, data);
                                                 int value = *reinterpret_cast<int *>(data);
                                                 if(value < min_value){
                                                         min_value = value;
@@ -209,8 +228,7 @@ public:
                                        
                                         float min_value = FLT_MAX;
                                         for(auto &rid: rids_){
-                                                auto rec = fh_->get_record(rid, nullptr);
-                                                char *data = rec->data + offset;
+                                                fh_->get_field(rid, offset, len, data);
                                                 float value = *reinterpret_cast<float *>(data);
                                                 if(value < min_value){
                                                         min_value = value;
@@ -225,8 +243,7 @@ public:
                                         auto rec_begin = fh_->get_record(*rids_.begin(), nullptr);
                                         std::string min_value(rec_begin->data+offset,len);
                                         for (auto &rid : rids_) {
-                                                auto rec = fh_->get_record(rid, nullptr);
-                                                char *data = rec->data + offset;
+                                                fh_->get_field(rid, offset, len, data);
                                                 std::string value(data, len);
                                                 if (value < min_value) {
                                                         min_value.assign(value);
@@ -264,5 +281,139 @@ public:
                 return output_cols_;
         };
 
+private:
+        void init_output_cols() {
+                if(aggre_meta_.op_ == AG_COUNT) {
+                        ColMeta col_meta_ = {.tab_name = tab_name_, .name = "*", .type = TYPE_INT, .len = sizeof(int), .offset = 0, .index = false};
+                        output_cols_.push_back(col_meta_);
+                }else {
+                        ColMeta col_meta_ = *tab_.get_col(aggre_meta_.tabcol_.col_name);
+                        // 对外输出的col_meta需要修改offset字段
+                        col_meta_.offset = 0;
+                        output_cols_.push_back(col_meta_);
+                }
+        }
+
+        // 字段类型的最小值和最大值
+        static void col_bounds(const ColMeta &col, Value *min_val, Value *max_val) {
+                switch (col.type) {
+                        case TYPE_INT:
+                                max_val->set_int(INT32_MAX);
+                                min_val->set_int(INT32_MIN);
+                                break;
+                        case TYPE_FLOAT:
+                                max_val->set_float(__FLT_MAX__);
+                                min_val->set_float(-__FLT_MAX__);
+                                break;
+                        case TYPE_STRING:
+                                max_val->set_str(std::string(col.len, 255));
+                                min_val->set_str(std::string(col.len, 0));
+                                break;
+                        case TYPE_DATETIME:
+                                max_val->set_datetime(std::string("9999-12-31 23:59:59"));
+                                min_val->set_datetime(std::string("1000-01-01 00:00:00"));
+                                break;
+                        case TYPE_BIGINT:
+                                max_val->set_bigint(INT64_MAX);
+                                min_val->set_bigint(INT64_MIN);
+                                break;
+                        default:
+                                throw InvalidTypeError();
+                }
+                max_val->init_raw(col.len);
+                min_val->init_raw(col.len);
+        }
+
+        /**
+         * 满足条件的key在索引中连续，并且按聚合字段有序：MIN正向扫描取第一个key，MAX反向扫描取最后一个key。
+         * 区间按闭区间定位，聚合字段上的>和<条件在取到的key上再检查，只会跳过等于边界值的key
+         */
+        void index_endpoint() {
+                auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index_meta_.cols)).get();
+                auto agg_col = tab_.get_col(aggre_meta_.tabcol_.col_name);
+                RmRecord lower_key(index_meta_.col_tot_len), upper_key(index_meta_.col_tot_len);
+                bool empty = false;
+                size_t offset = 0, agg_offset = 0;
+                for(auto &col : index_meta_.cols) {
+                        Value min_val, max_val;
+                        col_bounds(col, &min_val, &max_val);
+                        for(auto &cond : conds_) {
+                                if(cond.lhs_col.col_name != col.name) {
+                                        continue;
+                                }
+                                if((cond.op == OP_EQ || cond.op == OP_GT || cond.op == OP_GE) && cond.rhs_val > min_val) {
+                                        min_val = cond.rhs_val;
+                                }
+                                if((cond.op == OP_EQ || cond.op == OP_LT || cond.op == OP_LE) && cond.rhs_val < max_val) {
+                                        max_val = cond.rhs_val;
+                                }
+                        }
+                        empty |= min_val > max_val;
+                        memcpy(lower_key.data + offset, min_val.raw->data, col.len);
+                        memcpy(upper_key.data + offset, max_val.raw->data, col.len);
+                        if(col.name == agg_col->name) {
+                                agg_offset = offset;
+                        }
+                        offset += col.len;
+                }
+
+                const char *value = nullptr;
+                std::unique_ptr<IxScan> scan;
+                if(!empty) {
+                        Iid lower = ih->lower_bound(lower_key.data);
+                        Iid upper = ih->upper_bound(upper_key.data);
+                        scan = std::make_unique<IxScan>(ih, lower, upper, sm_manager_->get_bpm(), true, aggre_meta_.op_ == AG_MAX);
+                        for(; !scan->is_end(); scan->next()) {
+                                if(agg_col_fits(scan->key() + agg_offset, *agg_col)) {
+                                        value = scan->key() + agg_offset;
+                                        break;
+                                }
+                        }
+                }
+
+                // 没有满足条件的记录时和逐条比较的结果一致
+                bool is_max = aggre_meta_.op_ == AG_MAX;
+                switch(agg_col->type) {
+                        case TYPE_INT:
+                                val_.set_int(value ? *reinterpret_cast<const int *>(value) : (is_max ? INT_MIN : INT_MAX));
+                                val_.init_raw(sizeof(int));
+                                break;
+                        case TYPE_FLOAT:
+                                val_.set_float(value ? *reinterpret_cast<const float *>(value) : (is_max ? FLT_MIN : FLT_MAX));
+                                val_.init_raw(sizeof(float));
+                                break;
+                        case TYPE_STRING:
+                                val_.set_str(value ? std::string(value, agg_col->len) : std::string());
+                                val_.init_raw(agg_col->len);
+                                break;
+                        default:
+                                throw RMDBError("In execution_aggregation, we don't implement bigint and datetime type");
+                }
+        }
+
+        // 检查聚合字段的值是否满足该字段上的条件
+        bool agg_col_fits(const char *value, const ColMeta &col) const {
+                for(auto &cond : conds_) {
+                        if(cond.lhs_col.col_name != col.name) {
+                                continue;
+                        }
+                        int cmp = ix_compare(value, cond.rhs_val.raw->data, col.type, col.len);
+                        bool fit = true;
+                        switch(cond.op) {
+                                case OP_EQ: fit = cmp == 0; break;
+                                case OP_NE: fit = cmp != 0; break;
+                                case OP_LT: fit = cmp < 0; break;
+                                case OP_GT: fit = cmp > 0; break;
+                                case OP_LE: fit = cmp <= 0; break;
+                                case OP_GE: fit = cmp >= 0; break;
+                                default: break;
+                        }
+                        if(!fit) {
+                                return false;
+                        }
+                }
+                return true;
+        }
+
 
 };
\ No newline at end of file
@@ -16,6 +16,9 @@ See the Mulan PSL v2 for more details. */
 #include "index/ix.h"
 #include "system/sm.h"
 
+// 跳跃扫描：索引(a, b, ...)上只有b等后面字段的条件时，不逐个枚举a的所有可能取值，
+// 而是从索引中读出a实际存在的下一个取值v，在[(v, b的下界...), (v, b的上界...)]中扫描，扫描完再跳到a的下一个取值。
+// 每个取值对应一段区间，区间之间通过重新定位跳过；a的取值很多时先在当前叶子中顺序向后看，避免每个取值都从根结点下降
 class IndexScanModeOneExecutor : public AbstractExecutor {
    private:
     std::string tab_name_;                      // 表名称
@@ -29,11 +32,18 @@ class IndexScanModeOneExecutor : public AbstractExecutor {
     std::vector<std::string> index_col_names_;  // index scan涉及到的索引包含的字段
     IndexMeta index_meta_;                      // index scan涉及到的索引元数据
 
-    std::unique_ptr<RecScan> scan_;
+    std::unique_ptr<IxScan> scan_;
     IxIndexHandle *ih_;
 
-    std::vector<Rid> rids_;
-    size_t rid_index = 0;
+    Rid rid_;
+    std::vector<char> lower_key_, upper_key_;   // 查询的上下界
+    std::vector<char> max_key_;                 // 每个字段都取类型的最大值，用于跳过第一个字段的当前取值
+    std::vector<char> lo_, hi_;                 // 第一个字段取当前值时的扫描区间[lo_, hi_]，其余字段取查询的上下界
+    bool has_range_;                            // lo_和hi_中是否已经有第一个字段的取值
+    std::vector<char> skip_key_;                // 第一个字段取当前值、其余字段取最大值，upper_bound之后到达下一个取值
+    std::vector<ColType> col_types_;            // 索引各字段的类型，用于比较scan_返回的key
+    std::vector<int> col_lens_;
+    Iid end_;                                   // 整个扫描的终点
 
     SmManager *sm_manager_;
 
@@ -88,7 +98,8 @@ class IndexScanModeOneExecutor : public AbstractExecutor {
     // (a, b, c)，先查找a的上下界
     void beginTuple() override {
         // 1. 根据cond初始化lower_key和upper_key
-        RmRecord lower_key(index_meta_.col_tot_len), upper_key(index_meta_.col_tot_len);
+        RmRecord lower_key(index_meta_.col_tot_len), upper_key(index_meta_.col_tot_len), max_key(index_meta_.col_tot_len);
+        is_end_ = false;
 
         size_t offset = 0;
         for(auto col : index_meta_.cols) {
@@ -121,7 +132,9 @@ class IndexScanModeOneExecutor : public AbstractExecutor {
                 }
 
                 case TYPE_BIGINT : {
-                    throw RMDBError("还没实现type bigint, 在index_scan中");
+                    tmp_max.set_bigint(INT64_MAX); tmp_max.init_raw(col.len);
+                    tmp_min.set_bigint(INT64_MIN); tmp_min.init_raw(col.len);
+                    break;
                 }
 
                 default:{
@@ -129,6 +142,8 @@ class IndexScanModeOneExecutor : public AbstractExecutor {
                 }
             }
             
+            memcpy(max_key.data + offset, tmp_max.raw->data, col.len);
+
             // 根据cond更新upper和lower
             for(auto cond : fed_conds_) {
                 if(cond.lhs_col.col_name == col.name && cond.is_rhs_val) {
@@ -177,58 +192,38 @@ class IndexScanModeOneExecutor : public AbstractExecutor {
             offset += col.len;
         }
 
-        // 取第一个值的lower key和upper key
-        auto [min_exist, min_key] = ih_->get_min_key(context_->txn_);
-        auto [max_exist, max_key] = ih_->get_max_key(context_->txn_);
-        int min_a = INT32_MIN, max_a = INT32_MAX;
-        if(min_exist && max_exist) {
-            min_a = *(int*)min_key->data;
-            max_a = *(int*)max_key->data;
-        }else {
-            throw InternalError("Mode1 incorrect!!");
-        }
-        for(int i = min_a; i <= max_a; i++) {
-            memcpy(lower_key.data, (char*)&i, sizeof(int));
-            memcpy(upper_key.data, (char*)&i, sizeof(int));
-            auto lower_id = ih_->lower_bound(lower_key.data);
-            auto upper_id = ih_->upper_bound(upper_key.data);
-            scan_ = std::make_unique<IxScan>(ih_, lower_id, upper_id, sm_manager_->get_bpm());
-            while(!scan_->is_end()) {
-                auto rid = scan_->rid();
-                auto record = fh_->get_record(rid, nullptr);
-                bool is_fit = true;
-                for(auto fond : fed_conds_) {
-                    auto col = *get_col(cols_, fond.lhs_col);
-                    auto value = fetch_value(record, col);
-                    if(fond.is_rhs_val && !compare_value(value, fond.rhs_val, fond.op)) {
-                        is_fit = false;
-                        break;
-                    }
-                }
-                if(is_fit) {
-                    rids_.push_back(rid);
-                    break ;
-                }else {
-                    scan_->next();
-                }
-            }
+        lower_key_.assign(lower_key.data, lower_key.data + lower_key.size);
+        upper_key_.assign(upper_key.data, upper_key.data + upper_key.size);
+        max_key_.assign(max_key.data, max_key.data + max_key.size);
+        col_types_.clear();
+        col_lens_.clear();
+        for(auto &col : index_meta_.cols) {
+            col_types_.push_back(col.type);
+            col_lens_.push_back(col.len);
         }
-
-        rid_index = 0;
-
+        lo_ = lower_key_;
+        hi_ = upper_key_;
+        skip_key_ = max_key_;
+        has_range_ = false;
+
+        // 2. 第一个字段的取值由索引中实际存在的key得到，边扫描边输出，不预先收集rid
+        end_ = ih_->upper_bound(upper_key_.data());
+        seek(ih_->lower_bound(lower_key_.data()));
+        find_next_valid_tuple();
     }
 
     void nextTuple() override {
         assert(!is_end());
-        rid_index++;
+        scan_->next();
+        find_next_valid_tuple();
     }
 
     std::unique_ptr<RmRecord> Next() override {
         assert(!is_end());
-        return fh_->get_record(rids_[rid_index], nullptr);
+        return fh_->get_record(rid_, nullptr);
     }
 
-    Rid &rid() override { return rids_[rid_index]; }
+    Rid &rid() override { return rid_; }
 
 
     size_t tupleLen() const { return len_; };
@@ -239,8 +234,79 @@ class IndexScanModeOneExecutor : public AbstractExecutor {
 
     std::string getType() { return "IndexScanModeOneExecutor"; };
 
-    bool is_end() const { return rid_index >= rids_.size(); };
+    bool is_end() const { return is_end_; };
 
 private:
+    void seek(const Iid &lower) {
+        scan_ = std::make_unique<IxScan>(ih_, lower, end_, sm_manager_->get_bpm(), true);
+    }
+
+    int compare_key(const char *a, const std::vector<char> &b) const {
+        return ix_compare(a, b.data(), col_types_, col_lens_);
+    }
+
+    int compare_first_col(const char *a, const std::vector<char> &b) const {
+        return ix_compare(a, b.data(), col_types_[0], col_lens_[0]);
+    }
+
+    // 顺序向后最多看IX_SKIP_SCAN_STEPS个键值对，直到key >= target（past时为key > target）
+    // 返回false表示没有找到，需要调用者重新定位
+    bool step_to(const std::vector<char> &target, bool past) {
+        for(int i = 0; i < IX_SKIP_SCAN_STEPS && !scan_->is_end(); i++) {
+            int cmp = compare_key(scan_->key(), target);
+            if(cmp > 0 || (cmp == 0 && !past)) {
+                return true;
+            }
+            scan_->next();
+        }
+        return scan_->is_end();
+    }
+
+    // 从scan_的当前位置开始找到第一条满足条件的记录，第一个字段的当前取值扫描完之后跳到下一个取值
+    void find_next_valid_tuple() {
+        size_t first_len = col_lens_[0];
+        while(!scan_->is_end()) {
+            const char *key = scan_->key();
+            if(!has_range_ || compare_first_col(key, lo_) != 0) {
+                has_range_ = true;
+                // 1. 进入第一个字段的新取值，更新扫描区间，key还没有到区间下界时跳到下界
+                memcpy(lo_.data(), key, first_len);
+                memcpy(hi_.data(), key, first_len);
+                if(compare_key(key, lo_) < 0) {
+                    if(!step_to(lo_, false)) {
+                        seek(ih_->lower_bound(lo_.data()));
+                    }
+                    continue;
+                }
+            }
+            if(compare_key(key, hi_) > 0) {
+                // 2. 当前取值的区间已经扫描完，跳过第一个字段等于当前取值的所有key
+                if(compare_first_col(key, upper_key_) >= 0) {
+                    break;
+                }
+                memcpy(skip_key_.data(), key, first_len);
+                if(!step_to(skip_key_, true)) {
+                    seek(ih_->upper_bound(skip_key_.data()));
+                }
+                continue;
+            }
+            // 3. key在区间中，中间的字段不一定满足条件，用记录检查全部条件
+            rid_ = scan_->rid();
+            auto record = fh_->get_record(rid_, nullptr);
+            bool is_fit = true;
+            for(auto &fond : fed_conds_) {
+                auto &col = *get_col(cols_, fond.lhs_col);
+                if(fond.is_rhs_val && !compare_ref(fetch_ref(*record, col), fond.rhs_ref(), fond.op)) {
+                    is_fit = false;
+                    break;
+                }
+            }
+            if(is_fit) {
+                return;
+            }
+            scan_->next();
+        }
+        is_end_ = true;
+    }
 
 };
\ No newline at end of file
@@ -66,7 +66,7 @@ class LoadExecutor : public AbstractExecutor {
         std::string line;
         while(std::getline(*ifs_, line)) {
             // 取一行数据后，生成record并插入
-            auto rec = std::make_unique<RmRecord>(fh_->get_file_hdr().record_size);
+            auto rec = std::make_unique<RmRecord>(fh_->get_record_size());
             std::stringstream ss(line);
             for(auto &col : tab_.cols) {
                 std::string token;
@@ -110,18 +110,23 @@ class LoadExecutor : public AbstractExecutor {
         fh_->massive_insert(&records, &rids, nullptr);
         assert(rids.size() == records.size());
 
-        // 批量插入索引
-        for(auto &index : tab_.indexes) {
-            auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-            for(size_t i = 0; i < records.size(); i++) {
+        // 批量插入索引：排序后空索引自底向上建树，非空索引按key顺序插入
+        // 有重复的key时撤销这次load，已经加入索引的key和插入的记录都删除，表和索引保持load之前的状态
+        size_t loaded = 0;
+        try {
+            for(; loaded < tab_.indexes.size(); loaded++) {
+                auto &index = tab_.indexes[loaded];
+                IxBulkSorter sorter(get_index(index)->get_file_hdr());
                 char key[index.col_tot_len];
-                int offset = 0;
-                for(int j = 0; j < index.col_num; ++j) {
-                    memcpy(key + offset, records[i]->data + index.cols[j].offset, index.cols[j].len);
-                    offset += index.cols[j].len;
+                for(size_t i = 0; i < records.size(); i++) {
+                    sorter.add(get_key(index, records[i]->data, key), rids[i]);
                 }
-                ih->insert_entry(key, rids[i], context_->txn_);
+                sorter.finish();
+                get_index(index)->bulk_load(&sorter, context_->txn_);
             }
+        } catch(RMDBError &) {
+            rollback(records, rids, loaded);
+            throw;
         }
         // for(size_t i = 0; i < tab_.indexes.size(); ++i) {
         //     auto& index = tab_.indexes[i];
@@ -182,4 +187,41 @@ class LoadExecutor : public AbstractExecutor {
         }
 
     Rid &rid() override { return rid_; }
+
+   private:
+    IxIndexHandle *get_index(const IndexMeta &index) {
+        return sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
+    }
+
+    const char *get_key(const IndexMeta &index, const char *record, char *key) {
+        int offset = 0;
+        for(int j = 0; j < index.col_num; ++j) {
+            memcpy(key + offset, record + index.cols[j].offset, index.cols[j].len);
+            offset += index.cols[j].len;
+        }
+        return key;
+    }
+
+    /**
+     * 撤销插入了一部分的load：前failed个索引已经加入了所有记录，第failed个索引只加入了一部分；
+     * 只删除索引中指向本次插入的rid的key，原有的同值key保留，最后删除插入的记录
+     */
+    void rollback(const std::vector<std::unique_ptr<RmRecord>> &records, const std::vector<Rid> &rids, size_t failed) {
+        for(size_t k = 0; k <= failed && k < tab_.indexes.size(); k++) {
+            auto &index = tab_.indexes[k];
+            auto ih = get_index(index);
+            char key[index.col_tot_len];
+            std::vector<Rid> result;
+            for(size_t i = 0; i < records.size(); i++) {
+                get_key(index, records[i]->data, key);
+                result.clear();
+                if(ih->get_value(key, &result, context_->txn_) && result[0] == rids[i]) {
+                    ih->delete_entry(key, context_->txn_);
+                }
+            }
+        }
+        for(auto &rid : rids) {
+            fh_->delete_record(rid, nullptr);
+        }
+    }
 };
\ No newline at end of file
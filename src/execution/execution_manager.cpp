@@ -22,16 +22,19 @@ See the Mulan PSL v2 for more details. */
 const char *help_info = "Supported SQL syntax:\n"
                    "  command ;\n"
                    "command:\n"
-                   "  CREATE TABLE table_name (column_name type [, column_name type ...])\n"
+                   "  CREATE TABLE table_name (column_name type [, column_name type ...]) [USING PAX]\n"
                    "  DROP TABLE table_name\n"
-                   "  CREATE INDEX table_name (column_name)\n"
+                   "  CREATE INDEX table_name (column_name) [USING {BLINK | HASH | ART}]\n"
                    "  DROP INDEX table_name (column_name)\n"
                    "  INSERT INTO table_name VALUES (value [, value ...])\n"
                    "  DELETE FROM table_name [WHERE where_clause]\n"
                    "  UPDATE table_name SET column_name = value [, column_name = value ...] [WHERE where_clause]\n"
                    "  SELECT selector FROM table_name [WHERE where_clause]\n"
+                   "  VACUUM table_name\n"
+                   "  REINDEX table_name\n"
+                   "  SHOW INDEX STATS table_name\n"
                    "type:\n"
-                   "  {INT | FLOAT | CHAR(n)}\n"
+                   "  {INT | FLOAT | CHAR(n) [DICT]}\n"
                    "where_clause:\n"
                    "  condition [AND condition ...]\n"
                    "condition:\n"
@@ -49,7 +52,7 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
         switch(x->tag) {
             case T_CreateTable:
             {
-                sm_manager_->create_table(x->tab_name_, x->cols_, context);
+                sm_manager_->create_table(x->tab_name_, x->cols_, context, x->is_pax_);
 
                 // 将创建表的操作写入日志
                 auto txn = context->txn_;
@@ -67,7 +70,8 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
             }
             case T_CreateIndex:
             {
-                sm_manager_->create_index(x->tab_name_, x->tab_col_names_, context);
+                sm_manager_->create_index(x->tab_name_, x->tab_col_names_, context, x->is_blink_, x->is_hash_,
+                                          x->fill_factor_, x->is_art_, x->is_lazy_delete_);
                 break;
             }
             case T_DropIndex:
@@ -108,6 +112,34 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
                 sm_manager_->show_index(x->tab_name_, context);
                 break;
             }
+            case T_ShowIndexStats:
+            {
+                sm_manager_->show_index_stats(x->tab_name_, context);
+                break;
+            }
+            case T_Vacuum:
+            {
+                // 每一批都是一个单独的短事务，在显式事务中执行时外层事务持有的表锁会和批事务的X锁冲突
+                if(context->txn_->get_txn_mode()) {
+                    throw RMDBError("VACUUM cannot run inside a transaction block");
+                }
+                RmVacuumCursor cursor{RM_FIRST_RECORD_PAGE, RM_NO_PAGE};
+                bool has_more = true;
+                while(has_more) {
+                    run_in_own_txn(context, [&](Context *txn_context) {
+                        has_more = sm_manager_->vacuum_batch(x->tab_name_, &cursor, txn_context);
+                    });
+                }
+                run_in_own_txn(context, [&](Context *txn_context) {
+                    sm_manager_->vacuum_finish(x->tab_name_, txn_context);
+                });
+                break;
+            }
+            case T_Reindex:
+            {
+                sm_manager_->reindex_table(x->tab_name_, context);
+                break;
+            }
             case T_DescTable:
             {
                 sm_manager_->desc_table(x->tab_name_, context);
@@ -246,4 +278,24 @@ void QlManager::select_from(std::unique_ptr<AbstractExecutor> executorTreeRoot,
 // 执行DML语句
 void QlManager::run_dml(std::unique_ptr<AbstractExecutor> exec){
     exec->Next();
-}
\ No newline at end of file
+}
+/**
+ * @description: 开启一个单独的短事务执行func，执行完立即提交并释放该事务持有的锁；出错时回滚该事务，异常继续向上抛出
+ * @param {Context*} context 当前语句的上下文，新事务沿用其中的锁管理器和日志管理器
+ * @param {function<void(Context *)>&} func 在新事务中执行的操作，参数是新事务的上下文
+ */
+void QlManager::run_in_own_txn(Context *context, const std::function<void(Context *)> &func) {
+    Transaction *txn = txn_mgr_->begin(nullptr, context->log_mgr_);
+    txn->set_txn_mode(false);
+    Context txn_context(context->lock_mgr_, context->log_mgr_, txn, context->data_send_, context->offset_);
+    txn_context.outputFile_ = context->outputFile_;
+    try {
+        func(&txn_context);
+    } catch(...) {
+        txn_mgr_->abort(txn, context->log_mgr_);
+        txn_mgr_->delete_transaction(txn->get_transaction_id());
+        throw;
+    }
+    txn_mgr_->commit(txn, context->log_mgr_);
+    txn_mgr_->delete_transaction(txn->get_transaction_id());
+}
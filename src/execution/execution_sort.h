@@ -135,25 +135,20 @@ class RmCompare : AbstractExecutor {
                 for (auto &tab_col : order_cols_)
                 {
                     
-                    auto cols = prev_->cols();
-                    auto col_meta = *get_col(cols, tab_col.tabcol);
+                    auto &cols = prev_->cols();
+                    auto &col_meta = *get_col(cols, tab_col.tabcol);
 
-                    auto left_value = fetch_value(lhs, col_meta);
-                    auto right_value = fetch_value(rhs, col_meta);
-                    bool flag = compare_value(left_value, right_value, {OP_GT});
-                    bool is_equal = compare_value(left_value, right_value, {OP_EQ});
+                    // 一次比较同时得到大小和相等关系，不构造Value
+                    int cmp = compare_value_ref(fetch_ref(*lhs, col_meta), fetch_ref(*rhs, col_meta));
                     // int flag = ix_compare(current_tuple.data+col_meta->offset, buf, col_meta->type, col_meta->len);
                     // 后面符合条件的元组根据排序顺序 (降序 / 升序)
-                    if(is_equal) {
+                    if(cmp == 0) {
                         continue;
-                    }else if((!flag && tab_col.is_desc) || (flag && !tab_col.is_desc))
-                    {
-                        return false;
-                    }else{
-                        return true;
                     }
+                    return tab_col.is_desc ? cmp > 0 : cmp < 0;
                 }
-                return true;
+                // 全部相等时返回false，std::sort要求严格弱序
+                return false;
             }
 
             Rid &rid() override { return _abstract_rid; }
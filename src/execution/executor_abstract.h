@@ -88,6 +88,26 @@ class AbstractExecutor {
         return ret;
     }
 
+    // 从Record中取出某一列的ValueRef，不分配内存，字符串直接指向record
+    ValueRef fetch_ref(const RmRecord &record, const ColMeta& col) const {
+        return ValueRef::from_raw(record.data + col.offset, col.type, col.len);
+    }
+
+    // 同compare_value，比较两个ValueRef是否符合op
+    bool compare_ref(const ValueRef& left_value, const ValueRef& right_value, CompOp op) const {
+        int cmp = compare_value_ref(left_value, right_value);
+        switch (op)
+        {
+            case OP_EQ: return cmp == 0;
+            case OP_NE: return cmp != 0;
+            case OP_LT: return cmp < 0;
+            case OP_GT: return cmp > 0;
+            case OP_LE: return cmp <= 0;
+            case OP_GE: return cmp >= 0;
+        }
+        throw IncompatibleTypeError(coltype2str(left_value.type), coltype2str(right_value.type));
+    }
+
     // compare_value的功能是比较left_vlaue和right_value的值是否符合CompOp中定义的op
     bool compare_value(const Value& left_value, const Value& right_value, CompOp op) const {
         // 检查type是否一致
@@ -122,25 +122,25 @@ private:
                         auto right_record = (*right_join_buffer_)->get_record();
                         // 检查是否符合fed_cond
                         bool is_fit = true;
-                        for(auto cond : fed_conds_) {
+                        for(auto &cond : fed_conds_) {
                             // 取left value
                             
-                            auto left_cols = left_->cols();
-                            auto left_col = *(left_->get_col(left_cols, cond.lhs_col));
-                            auto left_value = fetch_value(*left_record, left_col);
+                            auto &left_cols = left_->cols();
+                            auto &left_col = *(left_->get_col(left_cols, cond.lhs_col));
+                            auto left_value = fetch_ref(**left_record, left_col);
 
                             // 取right value
-                            Value right_value;
+                            ValueRef right_value;
                             if(cond.is_rhs_val) {
-                                right_value = cond.rhs_val;
+                                right_value = cond.rhs_ref();
                             }else {
-                                auto right_cols = right_->cols();
-                                auto right_col = *(right_->get_col(right_cols, cond.rhs_col));
-                                right_value = fetch_value(*right_record, right_col);
+                                auto &right_cols = right_->cols();
+                                auto &right_col = *(right_->get_col(right_cols, cond.rhs_col));
+                                right_value = fetch_ref(**right_record, right_col);
                             }
 
                             // 比较是否符合条件
-                            if(!compare_value(left_value, right_value, cond.op)) {
+                            if(!compare_ref(left_value, right_value, cond.op)) {
                                 is_fit = false;
                                 break;
                             }
@@ -0,0 +1,137 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+// 哈希索引或ART索引等值查找：索引的每个字段都有等值条件，用条件中的值拼出key，一次查找得到rid
+class HashIndexScanExecutor : public AbstractExecutor {
+   private:
+    std::string tab_name_;                      // 表名称
+    TabMeta tab_;                               // 表的元数据
+    std::vector<Condition> conds_;              // 扫描条件
+    RmFileHandle *fh_;                          // 表的数据文件句柄
+    std::vector<ColMeta> cols_;                 // 需要读取的字段
+    size_t len_;                                // 选取出来的一条记录的长度
+    std::vector<Condition> fed_conds_;          // 扫描条件，和conds_字段相同
+
+    IndexMeta index_meta_;                      // 哈希索引或ART索引的元数据
+    IxIndexHandle *ih_;
+
+    std::vector<Rid> rids_;                     // 查找得到的rid
+    size_t pos_;                                // 当前rid在rids_中的下标
+    Rid rid_;
+
+    SmManager *sm_manager_;
+
+   public:
+    HashIndexScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds, IndexMeta index_meta,
+                          Context *context) {
+        sm_manager_ = sm_manager;
+        context_ = context;
+        tab_name_ = std::move(tab_name);
+        tab_ = sm_manager_->db_.get_table(tab_name_);
+        conds_ = std::move(conds);
+        index_meta_ = index_meta;
+        fh_ = sm_manager_->fhs_.at(tab_name_).get();
+        auto index_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index_meta_.cols);
+        ih_ = sm_manager_->ihs_.at(index_name).get();
+        cols_ = tab_.cols;
+        len_ = cols_.back().offset + cols_.back().len;
+        std::map<CompOp, CompOp> swap_op = {
+            {OP_EQ, OP_EQ}, {OP_NE, OP_NE}, {OP_LT, OP_GT}, {OP_GT, OP_LT}, {OP_LE, OP_GE}, {OP_GE, OP_LE},
+        };
+
+        for (auto &cond : conds_) {
+            if (cond.lhs_col.tab_name != tab_name_) {
+                // lhs is on other table, now rhs must be on this table
+                assert(!cond.is_rhs_val && cond.rhs_col.tab_name == tab_name_);
+                // swap lhs and rhs
+                std::swap(cond.lhs_col, cond.rhs_col);
+                cond.op = swap_op.at(cond.op);
+            }
+        }
+        fed_conds_ = conds_;
+        pos_ = 0;
+
+        // index scan加S锁
+        if(context_ != nullptr) {
+            context_->lock_mgr_->lock_shared_on_table_wait_time(context_->txn_, fh_->GetFd());
+        }
+    }
+
+    void beginTuple() override {
+        // 1. 用每个字段的等值条件拼出key，同一字段有多个等值条件时用第一个，其余的在过滤时检查
+        char key[index_meta_.col_tot_len];
+        size_t offset = 0;
+        for(auto &col : index_meta_.cols) {
+            for(auto &cond : fed_conds_) {
+                if(cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.col_name == col.name) {
+                    memcpy(key + offset, cond.rhs_val.raw->data, col.len);
+                    break;
+                }
+            }
+            offset += col.len;
+        }
+
+        // 2. 查找哈希索引，再用全部条件过滤
+        rids_.clear();
+        pos_ = 0;
+        ih_->get_value(key, &rids_, nullptr);
+        find_next_valid_tuple();
+    }
+
+    void nextTuple() override {
+        assert(!is_end());
+        pos_++;
+        find_next_valid_tuple();
+    }
+
+    std::unique_ptr<RmRecord> Next() override {
+        assert(!is_end());
+        return fh_->get_record(rid_, nullptr);
+    }
+
+    Rid &rid() override { return rid_; }
+
+    size_t tupleLen() const { return len_; };
+
+    const std::vector<ColMeta> &cols() const {
+        return tab_.cols;
+    };
+
+    std::string getType() { return "HashIndexScanExecutor"; };
+
+    bool is_end() const { return pos_ >= rids_.size(); };
+
+   private:
+    void find_next_valid_tuple() {
+        for(; pos_ < rids_.size(); pos_++) {
+            rid_ = rids_[pos_];
+            auto record = fh_->get_record(rid_, nullptr);
+            bool is_fit = true;
+            for(auto &fond : fed_conds_) {
+                auto &col = *get_col(cols_, fond.lhs_col);
+                if(fond.is_rhs_val && !compare_ref(fetch_ref(*record, col), fond.rhs_ref(), fond.op)) {
+                    is_fit = false;
+                    break;
+                }
+            }
+            if(is_fit) {
+                return;
+            }
+        }
+    }
+};
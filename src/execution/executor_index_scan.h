@@ -30,7 +30,7 @@ class IndexScanExecutor : public AbstractExecutor {
     IndexMeta index_meta_;                      // index scan涉及到的索引元数据
 
     Rid rid_;
-    std::unique_ptr<RecScan> scan_;
+    std::unique_ptr<IxScan> scan_;
     IxIndexHandle *ih_;
 
     SmManager *sm_manager_;
@@ -38,9 +38,16 @@ class IndexScanExecutor : public AbstractExecutor {
     // 用is_end表示是否为end
     bool is_end_;
 
+    int limit_;                                 // 下推的limit，-1表示没有limit
+    int emitted_;                               // 已经输出的元组个数
+    bool index_only_;                           // 输出和过滤的字段都在索引中，直接用key构造元组，不读表
+    std::vector<size_t> index_col_offsets_;     // 索引的各个字段在记录中的offset
+    bool reverse_;                              // 按索引顺序从大到小输出
+
    public:
     IndexScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds, std::vector<std::string> index_col_names,
-                    IndexMeta index_meta, Context *context) {
+                    IndexMeta index_meta, Context *context, int limit = -1, bool index_only = false,
+                    bool reverse = false) {
         sm_manager_ = sm_manager;
         context_ = context;
         tab_name_ = std::move(tab_name);
@@ -73,6 +80,13 @@ class IndexScanExecutor : public AbstractExecutor {
 
         // is_end_初始为false
         is_end_ = false;
+        limit_ = limit;
+        emitted_ = 0;
+        index_only_ = index_only;
+        reverse_ = reverse;
+        for(auto &col : index_meta_.cols) {
+            index_col_offsets_.push_back(tab_.get_col(col.name)->offset);
+        }
 
         // index scan加S锁
         if(context_ != nullptr) {
@@ -118,7 +132,9 @@ class IndexScanExecutor : public AbstractExecutor {
                 }
 
                 case TYPE_BIGINT : {
-                    throw RMDBError("还没实现type bigint, 在index_scan中");
+                    tmp_max.set_bigint(INT64_MAX); tmp_max.init_raw(col.len);
+                    tmp_min.set_bigint(INT64_MIN); tmp_min.init_raw(col.len);
+                    break;
                 }
 
                 default:{
@@ -182,21 +198,24 @@ class IndexScanExecutor : public AbstractExecutor {
         // for(auto col : index_meta_.cols) {
 
         // }
+        emitted_ = 0;
+        if(limit_ == 0) {
+            return;
+        }
         auto lower_id = ih_->lower_bound(lower_key.data);
         auto upper_id = ih_->upper_bound(upper_key.data);
-        scan_ = std::make_unique<IxScan>(ih_, lower_id, upper_id, sm_manager_->get_bpm());
+        scan_ = std::make_unique<IxScan>(ih_, lower_id, upper_id, sm_manager_->get_bpm(), index_only_, reverse_);
 
         // 3.直接取rid，不经过cond过滤
         // TODO: 用cond过滤
         // find_next_valid_tuple();
         while(!scan_->is_end()) {
             rid_ = scan_->rid();
-            auto record = fh_->get_record(rid_, nullptr);
+            auto record = current_record();
             bool is_fit = true;
-            for(auto fond : fed_conds_) {
-                auto col = *get_col(cols_, fond.lhs_col);
-                auto value = fetch_value(record, col);
-                if(fond.is_rhs_val && !compare_value(value, fond.rhs_val, fond.op)) {
+            for(auto &fond : fed_conds_) {
+                auto &col = *get_col(cols_, fond.lhs_col);
+                if(fond.is_rhs_val && !compare_ref(fetch_ref(*record, col), fond.rhs_ref(), fond.op)) {
                     is_fit = false;
                     break;
                 }
@@ -211,15 +230,18 @@ class IndexScanExecutor : public AbstractExecutor {
 
     void nextTuple() override {
         assert(!is_end());
+        // 达到limit之后不再读取后续的叶子
+        if(limit_ != -1 && ++emitted_ >= limit_) {
+            return;
+        }
         scan_->next();
         while(!scan_->is_end()) {
             rid_ = scan_->rid();
-            auto record = fh_->get_record(rid_, nullptr);
+            auto record = current_record();
             bool is_fit = true;
-            for(auto fond : fed_conds_) {
-                auto col = *get_col(cols_, fond.lhs_col);
-                auto value = fetch_value(record, col);
-                if(fond.is_rhs_val && !compare_value(value, fond.rhs_val, fond.op)) {
+            for(auto &fond : fed_conds_) {
+                auto &col = *get_col(cols_, fond.lhs_col);
+                if(fond.is_rhs_val && !compare_ref(fetch_ref(*record, col), fond.rhs_ref(), fond.op)) {
                     is_fit = false;
                     break;
                 }
@@ -235,7 +257,7 @@ class IndexScanExecutor : public AbstractExecutor {
 
     std::unique_ptr<RmRecord> Next() override {
         assert(!is_end());
-        return fh_->get_record(rid_,nullptr);
+        return current_record();
     }
 
     Rid &rid() override { return rid_; }
@@ -249,11 +271,25 @@ class IndexScanExecutor : public AbstractExecutor {
 
     std::string getType() { return "IndexScanExecutor"; };
 
-    bool is_end() const { return scan_->is_end(); };
+    bool is_end() const { return (limit_ != -1 && emitted_ >= limit_) || scan_->is_end(); };
 
     // ColMeta get_col_offset(const TabCol &target) { return ColMeta();};
 
 private:
+    // index-only扫描时把key中的各个字段拷贝到记录中对应的位置，其余字段不会被上层读取
+    std::unique_ptr<RmRecord> current_record() {
+        if(!index_only_) {
+            return fh_->get_record(rid_, nullptr);
+        }
+        auto record = std::make_unique<RmRecord>(len_);
+        const char *key = scan_->key();
+        for(size_t i = 0; i < index_meta_.cols.size(); i++) {
+            memcpy(record->data + index_col_offsets_[i], key, index_meta_.cols[i].len);
+            key += index_meta_.cols[i].len;
+        }
+        return record;
+    }
+
     // void find_next_valid_tuple() {
     //     while(!scan_->is_end()) {
     //         rid_ = scan_->rid();
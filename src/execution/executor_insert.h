@@ -44,7 +44,7 @@ class InsertExecutor : public AbstractExecutor {
 
     std::unique_ptr<RmRecord> Next() override {
         // 1. 获取record
-        RmRecord rec(fh_->get_file_hdr().record_size);
+        RmRecord rec(fh_->get_record_size());
         for (size_t i = 0; i < values_.size(); i++) {
             auto &col = tab_.cols[i];
             auto &val = values_[i];
@@ -55,24 +55,32 @@ class InsertExecutor : public AbstractExecutor {
             memcpy(rec.data + col.offset, val.raw->data, col.len);
         }
 
-        // 2. 检查是否满足唯一索引的要求
+        // 2. 先插入到fh_中, Insert into record file
+        rid_ = fh_->insert_record(rec.data, context_,tab_name_);
+
+        // 3. 插入到索引中，插入时检查唯一性：某个索引中key已经存在时，撤销已经插入的索引项和记录
+        std::vector<std::vector<char>> keys;
         for(size_t i = 0; i < tab_.indexes.size(); ++i) {
             auto& index = tab_.indexes[i];
             auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-            char key[index.col_tot_len];
+            std::vector<char> key(index.col_tot_len);
             int offset = 0;
-            for(int i = 0; i < index.col_num; ++i) {
-                memcpy(key + offset, rec.data + index.cols[i].offset, index.cols[i].len);
-                offset += index.cols[i].len;
+            for(int j = 0; j < index.col_num; ++j) {
+                memcpy(key.data() + offset, rec.data + index.cols[j].offset, index.cols[j].len);
+                offset += index.cols[j].len;
             }
-            if(ih->get_value(key, nullptr, context_->txn_)) {
+            if(!ih->insert_entry_if_absent(key.data(), rid_, context_->txn_)) {
+                for(size_t k = 0; k < keys.size(); ++k) {
+                    auto &inserted = tab_.indexes[k];
+                    sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, inserted.cols))
+                        ->delete_entry(keys[k].data(), context_->txn_);
+                }
+                fh_->delete_record(rid_, context_);
                 throw InternalError("Non-unique index!");
             }
+            keys.push_back(std::move(key));
         }
 
-        // 3. 先插入到fh_中, Insert into record file
-        rid_ = fh_->insert_record(rec.data, context_,tab_name_);
-
         // 将插入操作写入日志
         Transaction* txn = context_->txn_;
         InsertLogRecord* insert_log_rcd = new InsertLogRecord(txn->get_transaction_id(),rec,rid_,tab_name_);
@@ -87,19 +95,9 @@ class InsertExecutor : public AbstractExecutor {
         TableWriteRecord *write_rcd = new TableWriteRecord(WType::INSERT_TUPLE, tab_name_, rid_, rec);
         context_->txn_->append_table_write_record(write_rcd);
         
-        // 5. 插入到索引中, 没有事务恢复部分，我们先用异常处理record和索引的一致性问题
+        // 5. 索引项加入transaction的index write set，用于abort
         for(size_t i = 0; i < tab_.indexes.size(); ++i) {
-            auto& index = tab_.indexes[i];
-            auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-            char key[index.col_tot_len];
-            int offset = 0;
-            for(int j = 0; j < index.col_num; ++j) {
-                memcpy(key + offset, rec.data + index.cols[j].offset, index.cols[j].len);
-                offset += index.cols[j].len;
-            }
-            ih->insert_entry(key, rid_, context_->txn_);
-
-            IndexWriteRecord *index_rcd = new IndexWriteRecord(WType::INSERT_TUPLE,tab_name_,rid_,key,index.col_tot_len);
+            IndexWriteRecord *index_rcd = new IndexWriteRecord(WType::INSERT_TUPLE,tab_name_,rid_,keys[i].data(),tab_.indexes[i].col_tot_len);
             context_->txn_->append_index_write_record(index_rcd);
         }
 
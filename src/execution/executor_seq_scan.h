@@ -24,6 +24,9 @@ class SeqScanExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;         // scan后生成的记录的字段
     size_t len_;                        // scan后生成的每条记录的长度
     std::vector<Condition> fed_conds_;  // 同conds_，两个字段相同
+    std::vector<std::pair<int, int>> dict_eq_conds_;    // 字典编码字段上的等值条件，(字段下标, 编码)，直接比较编码
+    bool no_match_;                     // 等值条件的值不在字典中，不可能有满足条件的记录
+    std::vector<RmZonePred> zone_preds_;    // 数值和datetime字段上的范围条件，用于根据zone map跳过整个页面
 
     Rid rid_;
     std::unique_ptr<RecScan> scan_;     // table_iterator
@@ -42,13 +45,62 @@ class SeqScanExecutor : public AbstractExecutor {
 
         context_ = context;
 
-        fed_conds_ = conds_;
+        // 字典编码字段上的等值条件改为比较编码，不需要解码记录
+        no_match_ = false;
+        for(auto &cond : conds_) {
+            if(cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.tab_name == tab_name_ && cond.rhs_val.raw != nullptr) {
+                auto lhs_col = get_col(cols_, cond.lhs_col);
+                int col_idx = fh_->get_dict_col(lhs_col->offset);
+                if(col_idx != -1) {
+                    int code = fh_->lookup_code(col_idx, cond.rhs_val.raw->data);
+                    no_match_ = no_match_ || code == -1;
+                    dict_eq_conds_.emplace_back(col_idx, code);
+                    continue;
+                }
+            }
+            fed_conds_.push_back(cond);
+            add_zone_pred(cond);
+        }
         // sequential scan加S锁
         if(context != nullptr) {
             context->lock_mgr_->lock_shared_on_table_wait_time(context->txn_, fh_->GetFd());
         }
     }
 
+    // 把字段和常量比较的条件转换为zone map上的范围，不能转换的条件只在逐条记录判断时使用
+    void add_zone_pred(const Condition &cond) {
+        if(!cond.is_rhs_val || cond.op == OP_NE || cond.lhs_col.tab_name != tab_name_) {
+            return;
+        }
+        auto lhs_col = get_col(cols_, cond.lhs_col);
+        int zone_col = fh_->get_zone_col(lhs_col->offset);
+        if(zone_col == -1) {
+            return;
+        }
+        RmZonePred pred;
+        pred.zone_col = zone_col;
+        auto &val = cond.rhs_val;
+        if(lhs_col->type == TYPE_FLOAT) {
+            if(val.type != TYPE_FLOAT && val.type != TYPE_INT) {
+                return;
+            }
+            pred.float_lo = pred.float_hi = val.type == TYPE_FLOAT ? val.float_val : val.int_val;
+        } else if(lhs_col->type == TYPE_DATETIME) {
+            if(val.type != TYPE_DATETIME) {
+                return;
+            }
+            pred.int_lo = pred.int_hi = static_cast<int64_t>(val.datetime_val.encode());
+        } else {
+            if(val.type != TYPE_INT && val.type != TYPE_BIGINT) {
+                return;
+            }
+            pred.int_lo = pred.int_hi = val.type == TYPE_INT ? val.int_val : val.bigint_val;
+        }
+        pred.has_lo = cond.op == OP_EQ || cond.op == OP_GT || cond.op == OP_GE;
+        pred.has_hi = cond.op == OP_EQ || cond.op == OP_LT || cond.op == OP_LE;
+        zone_preds_.push_back(pred);
+    }
+
     // 判断一个col是否满足指定条件
     bool is_fed_cond(const std::vector<ColMeta> &rec_cols,const Condition &cond,const RmRecord *target){
         // 1. 获取左操作数的colMeta
@@ -63,44 +115,52 @@ class SeqScanExecutor : public AbstractExecutor {
             rhs_col_meta = *get_col(rec_cols,rhs_col);
         }
         
-        // 3. 比较lhs和rhs的值
-        auto rcd_ptr = std::make_unique<RmRecord>(*target);
-        auto lhs_val = fetch_value(rcd_ptr,lhs_col_meta);
-        Value rhs_val;
+        // 3. 比较lhs和rhs的值，直接引用target中的字段，不复制记录
+        auto lhs_val = fetch_ref(*target,lhs_col_meta);
+        ValueRef rhs_val;
         if(cond.is_rhs_val){
-            rhs_val = cond.rhs_val;
+            rhs_val = cond.rhs_ref();
         }else{
-            rhs_val = fetch_value(rcd_ptr,rhs_col_meta);
+            rhs_val = fetch_ref(*target,rhs_col_meta);
         }
 
-        return compare_value(lhs_val,rhs_val,cond.op);
+        return compare_ref(lhs_val,rhs_val,cond.op);
 
     }
 
+    // 判断rid对应的记录是否满足所有条件，先比较字典编码，编码不等时不需要读取整条记录
+    bool is_fed_all_conds(const Rid &rid) {
+        for(auto &dict_cond : dict_eq_conds_) {
+            if(!fh_->match_code(rid, dict_cond.first, dict_cond.second)) {
+                return false;
+            }
+        }
+        if(fed_conds_.empty()) {
+            return true;
+        }
+        // 不用传context进去，因为已经加过表锁了
+        auto rcd = fh_->get_record(rid, nullptr);
+        for(auto it = fed_conds_.begin();it!=fed_conds_.end();++it){
+            if(!is_fed_cond(cols_,*it,rcd.get())){
+                return false;
+            }
+        }
+        return true;
+    }
+
     void beginTuple() override {
         // 1. 获取一个RmScan对象的指针,赋值给算子的变量scan_
-        scan_ = std::make_unique<RmScan>(fh_);
+        scan_ = std::make_unique<RmScan>(fh_, &zone_preds_);
         
         // 2. 用seq_scan来对表中的所有非空闲字段进行遍历，逐个判断是否满足所有条件
-        while(!scan_->is_end()){
-            // 2.1 通过RmFileHandle获取到seq_scan扫描到的record并封装为RmRecord对象
-            // 不用传context进去，因为已经加过表锁了
-            auto rcd = fh_->get_record(scan_->rid(), nullptr);
-            
-            // 2.2 用一个变量记录是否该rcd满足所有条件
-            bool fed_all_conds = true;
-            // 2.3 因为是所有条件，要对每个条件进行验证
-            for(auto it = fed_conds_.begin();it!=fed_conds_.end();++it){
-                if(!is_fed_cond(cols_,*it,rcd.get())){
-                   fed_all_conds = false;
-                   break;
-                }
-            }
-            // 2.4 如果不满足所有条件，RmScan遍历下一个record
+        while(!no_match_ && !scan_->is_end()){
+            // 2.1 判断seq_scan扫描到的record是否满足所有条件
+            bool fed_all_conds = is_fed_all_conds(scan_->rid());
+            // 2.2 如果不满足所有条件，RmScan遍历下一个record
             if(!fed_all_conds){
                 scan_->next();
             }else{
-            // 2.5 如果满足所有条件，break并且将该算子现在指向的rid_标记为找到的record的rid
+            // 2.3 如果满足所有条件，break并且将该算子现在指向的rid_标记为找到的record的rid
                 rid_ = scan_->rid();
                 break;
             }
@@ -113,20 +173,10 @@ class SeqScanExecutor : public AbstractExecutor {
         assert(!is_end());
         // 1. 继续查询下一个满足conds的record
         for (scan_->next(); !scan_->is_end(); scan_->next()) {
-            // 1.1 通过RmFileHandle获取到seq_scan扫描到的record并封装为RmRecord对象
-            auto rcd = fh_->get_record(scan_->rid(), nullptr);
-            
-            // 1.2 用一个变量记录是否该rcd满足所有条件
-            bool fed_all_conds = true;
-            // 1.3 因为是所有条件，要对每个条件进行验证
-            for(auto it = fed_conds_.begin();it!=fed_conds_.end();++it){
-                if(!is_fed_cond(cols_,*it,rcd.get())){
-                   fed_all_conds = false;
-                   break;
-                }
-            }
+            // 1.1 判断seq_scan扫描到的record是否满足所有条件
+            bool fed_all_conds = is_fed_all_conds(scan_->rid());
 
-            // 1.4 如果满足所有条件，将当前扫描的RmScan的rid赋值给算子的rid，并break
+            // 1.2 如果满足所有条件，将当前扫描的RmScan的rid赋值给算子的rid，并break
             if(fed_all_conds){
                 rid_ = scan_->rid();
                 break;
@@ -140,7 +190,7 @@ class SeqScanExecutor : public AbstractExecutor {
 
     Rid &rid() override { return rid_; }
 
-    bool is_end() const override { return scan_->is_end(); }
+    bool is_end() const override { return no_match_ || scan_->is_end(); }
 
     const std::vector<ColMeta> &cols() const override { return cols_; }
 
@@ -48,8 +48,8 @@ class UpdateExecutor : public AbstractExecutor {
             auto old_rec = fh_->get_record(rid, context_);
 
             // 2. 计算new record
-            auto new_rec = std::make_unique<RmRecord>(fh_->get_file_hdr().record_size);
-            memcpy(new_rec->data, old_rec->data, fh_->get_file_hdr().record_size);
+            auto new_rec = std::make_unique<RmRecord>(fh_->get_record_size());
+            memcpy(new_rec->data, old_rec->data, fh_->get_record_size());
             for(auto &set_clause: set_clauses_) {
                 auto lhs_col = tab_.get_col(set_clause.lhs.col_name);
                 // 将new rec中的相关值设置为新的值
@@ -89,7 +89,8 @@ class UpdateExecutor : public AbstractExecutor {
                 }
             }
             
-            // 3. 检查是否满足索引的一致性
+            // 3. 把新key插入索引，插入时检查唯一性；某个索引中新key已经存在时，删除已经插入的新key
+            std::vector<std::pair<IxIndexHandle *, std::vector<char>>> inserted;
             for(size_t i = 0; i < tab_.indexes.size(); ++i) {
                 auto& index = tab_.indexes[i];
                 // update之前和之后的key，如果相同，则跳过本次索引的检测（因为不检测也知道不会重复）
@@ -106,9 +107,13 @@ class UpdateExecutor : public AbstractExecutor {
                     continue;
                 }
                 auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-                if(ih->get_value(new_key, nullptr, context_->txn_)) {
+                if(!ih->insert_entry_if_absent(new_key, rid, context_->txn_)) {
+                    for(auto &[inserted_ih, inserted_key] : inserted) {
+                        inserted_ih->delete_entry(inserted_key.data(), context_->txn_);
+                    }
                     throw InternalError("Non-unique index!");
                 }
+                inserted.emplace_back(ih, std::vector<char>(new_key, new_key + index.col_tot_len));
             }
 
             // 4. 满足一致性，update record 将update操作写入transaction里面
@@ -127,7 +132,7 @@ class UpdateExecutor : public AbstractExecutor {
             context_->txn_->append_table_write_record(write_rcd);
 
             // 5. update index
-            // 将rid插入在内存中更新后的新的record的cols对应key的index
+            // 新key已经在第3步插入，这里删除原来的old_key
             for(size_t i = 0; i < tab_.indexes.size(); ++i) {
                 auto& index = tab_.indexes[i];
                 // update之前和之后的key，如果相同，则跳过本次索引的更新（因为不用更新）
@@ -143,10 +148,8 @@ class UpdateExecutor : public AbstractExecutor {
                 if(memcmp(old_key, new_key, index.col_tot_len) == 0) {
                     continue;
                 }
-                // 先删除原来的old_key，再插入新的new_key
                 auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
                 ih->delete_entry(old_key, context_->txn_);
-                ih->insert_entry(new_key, rid, context_->txn_);
                 // 写入两条record
                 IndexWriteRecord *delete_index_rcd = new IndexWriteRecord(WType::DELETE_TUPLE,tab_name_,rid, old_key,index.col_tot_len);
                 context_->txn_->append_index_write_record(delete_index_rcd);
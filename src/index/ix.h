@@ -10,5 +10,6 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "ix_bulk_sorter.h"
 #include "ix_scan.h"
 #include "ix_manager.h"
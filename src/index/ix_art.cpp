@@ -0,0 +1,744 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_art.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+enum IxArtNodeType : uint8_t { ART_NODE4, ART_NODE16, ART_NODE48, ART_NODE256 };
+
+constexpr uint8_t ART_NODE48_EMPTY = 48;    // Node48的child_index中表示没有孩子
+
+}  // namespace
+
+/**
+ * 版本号的第0位表示结点已经被替换（obsolete），第1位表示结点被写者锁住，其余位是修改次数
+ * 孩子指针的最低位为1时指向叶子IxArtLeaf，否则指向内部结点
+ */
+struct IxArtNode {
+    std::atomic<uint64_t> version{0};
+    uint8_t type;
+    uint16_t count = 0;                     // 孩子个数
+    int prefix_len;                         // 压缩前缀的长度，前缀只会变短
+    char *prefix;                           // 压缩前缀，长度为key_len的缓冲区
+};
+
+struct IxArtNode4 : IxArtNode {
+    uint8_t keys[4];                        // 按字节从小到大排列
+    void *children[4];
+};
+
+struct IxArtNode16 : IxArtNode {
+    uint8_t keys[16];
+    void *children[16];
+};
+
+struct IxArtNode48 : IxArtNode {
+    uint8_t child_index[256];               // 字节b对应的孩子在children中的下标
+    void *children[48];
+};
+
+struct IxArtNode256 : IxArtNode {
+    void *children[256];
+};
+
+struct IxArtLeaf {
+    Rid rid;
+    char key[1];                            // 实际长度为key_len
+};
+
+namespace {
+
+/* 孩子指针 */
+
+bool is_leaf(const void *child) { return reinterpret_cast<uintptr_t>(child) & 1; }
+
+IxArtLeaf *as_leaf(void *child) { return reinterpret_cast<IxArtLeaf *>(reinterpret_cast<uintptr_t>(child) & ~(uintptr_t)1); }
+
+void *tag_leaf(IxArtLeaf *leaf) { return reinterpret_cast<void *>(reinterpret_cast<uintptr_t>(leaf) | 1); }
+
+// 读者不加锁读取孩子指针，写者在锁内修改，指针本身的读写需要是原子的
+void *load_child(void *const *slot) { return __atomic_load_n(slot, __ATOMIC_ACQUIRE); }
+
+void store_child(void **slot, void *child) { __atomic_store_n(slot, child, __ATOMIC_RELEASE); }
+
+/* 乐观锁 */
+
+// 读取结点的版本号，结点被锁住或已被替换时返回false
+bool read_lock(IxArtNode *node, uint64_t *version) {
+    uint64_t v = node->version.load(std::memory_order_acquire);
+    if(v & 3) {
+        return false;
+    }
+    *version = v;
+    return true;
+}
+
+// 检查读取结点内容期间版本号没有变化，此时读到的内容是一致的
+bool check_version(IxArtNode *node, uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return node->version.load(std::memory_order_relaxed) == version;
+}
+
+bool upgrade_to_write_lock(IxArtNode *node, uint64_t version) {
+    return node->version.compare_exchange_strong(version, version + 2, std::memory_order_acquire);
+}
+
+void write_unlock(IxArtNode *node) { node->version.fetch_add(2, std::memory_order_release); }
+
+// 解锁并标记结点已被替换，之后的read_lock都会失败
+void write_unlock_obsolete(IxArtNode *node) { node->version.fetch_add(3, std::memory_order_release); }
+
+/* 结点操作，除find_child之外都在写锁内调用 */
+
+void *find_child(IxArtNode *node, uint8_t byte) {
+    switch(node->type) {
+        case ART_NODE4: {
+            auto n = static_cast<IxArtNode4 *>(node);
+            int count = std::min<int>(n->count, 4);
+            for(int i = 0; i < count; i++) {
+                if(n->keys[i] == byte) {
+                    return load_child(&n->children[i]);
+                }
+            }
+            return nullptr;
+        }
+        case ART_NODE16: {
+            auto n = static_cast<IxArtNode16 *>(node);
+            int count = std::min<int>(n->count, 16);
+            for(int i = 0; i < count; i++) {
+                if(n->keys[i] == byte) {
+                    return load_child(&n->children[i]);
+                }
+            }
+            return nullptr;
+        }
+        case ART_NODE48: {
+            auto n = static_cast<IxArtNode48 *>(node);
+            uint8_t idx = n->child_index[byte];
+            return idx < ART_NODE48_EMPTY ? load_child(&n->children[idx]) : nullptr;
+        }
+        default:
+            return load_child(&static_cast<IxArtNode256 *>(node)->children[byte]);
+    }
+}
+
+bool is_full(const IxArtNode *node) {
+    switch(node->type) {
+        case ART_NODE4:
+            return node->count == 4;
+        case ART_NODE16:
+            return node->count == 16;
+        case ART_NODE48:
+            return node->count == 48;
+        default:
+            return false;
+    }
+}
+
+int capacity(const IxArtNode *node) {
+    static const int caps[] = {4, 16, 48, 256};
+    return caps[node->type];
+}
+
+// Node4和Node16的keys有序，插入时把后面的孩子向后移动
+template <typename NodeT>
+void add_sorted(NodeT *n, uint8_t byte, void *child) {
+    int pos = 0;
+    while(pos < n->count && n->keys[pos] < byte) {
+        pos++;
+    }
+    memmove(n->keys + pos + 1, n->keys + pos, n->count - pos);
+    memmove(n->children + pos + 1, n->children + pos, (n->count - pos) * sizeof(void *));
+    n->keys[pos] = byte;
+    store_child(&n->children[pos], child);
+    n->count++;
+}
+
+template <typename NodeT>
+void remove_sorted(NodeT *n, uint8_t byte) {
+    for(int i = 0; i < n->count; i++) {
+        if(n->keys[i] == byte) {
+            memmove(n->keys + i, n->keys + i + 1, n->count - i - 1);
+            memmove(n->children + i, n->children + i + 1, (n->count - i - 1) * sizeof(void *));
+            n->count--;
+            return;
+        }
+    }
+}
+
+void add_child(IxArtNode *node, uint8_t byte, void *child) {
+    switch(node->type) {
+        case ART_NODE4:
+            add_sorted(static_cast<IxArtNode4 *>(node), byte, child);
+            break;
+        case ART_NODE16:
+            add_sorted(static_cast<IxArtNode16 *>(node), byte, child);
+            break;
+        case ART_NODE48: {
+            auto n = static_cast<IxArtNode48 *>(node);
+            // 删除会在children中间留下空位，找第一个空位
+            uint8_t slot = 0;
+            while(n->children[slot] != nullptr) {
+                slot++;
+            }
+            store_child(&n->children[slot], child);
+            n->child_index[byte] = slot;
+            n->count++;
+            break;
+        }
+        default:
+            store_child(&static_cast<IxArtNode256 *>(node)->children[byte], child);
+            node->count++;
+    }
+}
+
+void change_child(IxArtNode *node, uint8_t byte, void *child) {
+    switch(node->type) {
+        case ART_NODE4: {
+            auto n = static_cast<IxArtNode4 *>(node);
+            for(int i = 0; i < n->count; i++) {
+                if(n->keys[i] == byte) {
+                    store_child(&n->children[i], child);
+                }
+            }
+            break;
+        }
+        case ART_NODE16: {
+            auto n = static_cast<IxArtNode16 *>(node);
+            for(int i = 0; i < n->count; i++) {
+                if(n->keys[i] == byte) {
+                    store_child(&n->children[i], child);
+                }
+            }
+            break;
+        }
+        case ART_NODE48: {
+            auto n = static_cast<IxArtNode48 *>(node);
+            store_child(&n->children[n->child_index[byte]], child);
+            break;
+        }
+        default:
+            store_child(&static_cast<IxArtNode256 *>(node)->children[byte], child);
+    }
+}
+
+void remove_child(IxArtNode *node, uint8_t byte) {
+    switch(node->type) {
+        case ART_NODE4:
+            remove_sorted(static_cast<IxArtNode4 *>(node), byte);
+            break;
+        case ART_NODE16:
+            remove_sorted(static_cast<IxArtNode16 *>(node), byte);
+            break;
+        case ART_NODE48: {
+            auto n = static_cast<IxArtNode48 *>(node);
+            store_child(&n->children[n->child_index[byte]], nullptr);
+            n->child_index[byte] = ART_NODE48_EMPTY;
+            n->count--;
+            break;
+        }
+        default:
+            store_child(&static_cast<IxArtNode256 *>(node)->children[byte], nullptr);
+            node->count--;
+    }
+}
+
+// 按字节从小到大的顺序访问结点的每个孩子
+template <typename F>
+void for_each_child(IxArtNode *node, F &&f) {
+    switch(node->type) {
+        case ART_NODE4: {
+            auto n = static_cast<IxArtNode4 *>(node);
+            for(int i = 0; i < n->count; i++) {
+                f(n->keys[i], n->children[i]);
+            }
+            break;
+        }
+        case ART_NODE16: {
+            auto n = static_cast<IxArtNode16 *>(node);
+            for(int i = 0; i < n->count; i++) {
+                f(n->keys[i], n->children[i]);
+            }
+            break;
+        }
+        case ART_NODE48: {
+            auto n = static_cast<IxArtNode48 *>(node);
+            for(int b = 0; b < 256; b++) {
+                if(n->child_index[b] != ART_NODE48_EMPTY) {
+                    f((uint8_t)b, n->children[n->child_index[b]]);
+                }
+            }
+            break;
+        }
+        default: {
+            auto n = static_cast<IxArtNode256 *>(node);
+            for(int b = 0; b < 256; b++) {
+                if(n->children[b] != nullptr) {
+                    f((uint8_t)b, n->children[b]);
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+/**
+ * @brief 读写操作期间所在的epoch，析构时退出
+ */
+class IxArt::EpochGuard {
+   public:
+    explicit EpochGuard(IxArt *art) : art_(art), gen_(art->enter_epoch()) {}
+
+    ~EpochGuard() { art_->exit_epoch(gen_); }
+
+   private:
+    IxArt *art_;
+    uint64_t gen_;
+};
+
+IxArt::IxArt(IxFileHdr *file_hdr) : file_hdr_(file_hdr), key_len_(file_hdr->col_tot_len_) {
+    root_ = make_node(ART_NODE256, nullptr, 0);
+}
+
+IxArt::~IxArt() {
+    free_tree(root_);
+    for(auto &[gen, ptr] : retired_) {
+        free_ptr(ptr);
+    }
+}
+
+/**
+ * @brief 查找key对应的rid，key唯一，最多只有一个结果
+ */
+bool IxArt::get_value(const char *key, std::vector<Rid> *result) {
+    EpochGuard guard(this);
+    Rid rid;
+    int ret;
+    while((ret = try_get(key, &rid)) < 0) {
+    }
+    if(ret == 0) {
+        return false;
+    }
+    result->push_back(rid);
+    return true;
+}
+
+/**
+ * @brief 插入(key, rid)，下降过程中遇到相同key的叶子时不插入
+ * @return key已经存在时返回false
+ */
+bool IxArt::insert_entry(const char *key, const Rid &value) {
+    EpochGuard guard(this);
+    int ret;
+    while((ret = try_insert(key, value)) < 0) {
+    }
+    return ret == 1;
+}
+
+/**
+ * @brief 删除key，只摘除叶子；结点只剩这一个孩子时把结点也从父结点中摘除，其余情况结点不收缩
+ */
+bool IxArt::delete_entry(const char *key) {
+    EpochGuard guard(this);
+    int ret;
+    while((ret = try_delete(key)) < 0) {
+    }
+    return ret == 1;
+}
+
+/**
+ * @brief 从根结点逐字节下降，每下降一层先读孩子的版本号，再检查父结点的版本号没有变化
+ * @return 1表示找到，0表示不存在，-1表示需要重新开始
+ */
+int IxArt::try_get(const char *key, Rid *rid) {
+    IxArtNode *node = root_;
+    uint64_t v;
+    if(!read_lock(node, &v)) {
+        return -1;
+    }
+    int depth = 0;
+    while(true) {
+        int prefix_len = node->prefix_len;
+        if(depth + prefix_len >= key_len_) {
+            return -1;
+        }
+        if(memcmp(node->prefix, key + depth, prefix_len) != 0) {
+            return check_version(node, v) ? 0 : -1;
+        }
+        depth += prefix_len;
+        void *child = find_child(node, key[depth]);
+        if(!check_version(node, v)) {
+            return -1;
+        }
+        if(child == nullptr) {
+            return 0;
+        }
+        if(is_leaf(child)) {
+            // 叶子创建之后不再修改，退役之后也要等epoch结束才释放，可以直接读取
+            IxArtLeaf *leaf = as_leaf(child);
+            if(memcmp(leaf->key, key, key_len_) != 0) {
+                return 0;
+            }
+            *rid = leaf->rid;
+            return 1;
+        }
+        depth++;
+        auto next = static_cast<IxArtNode *>(child);
+        uint64_t next_v;
+        if(!read_lock(next, &next_v) || !check_version(node, v)) {
+            return -1;
+        }
+        node = next;
+        v = next_v;
+    }
+}
+
+/**
+ * @brief 乐观下降到插入位置，只对要修改的结点加写锁：
+ * 1. 前缀不匹配：新建Node4代替该结点，前缀在不匹配处分开，需要锁住父结点和该结点
+ * 2. 没有对应的孩子：结点未满时直接插入叶子；满了先换成更大的结点，旧结点标记为obsolete并退役
+ * 3. 孩子是另一个叶子：新建Node4保存两个叶子，前缀为两个key从当前深度开始的公共部分
+ * @return 1表示插入成功，0表示key已经存在，-1表示需要重新开始
+ */
+int IxArt::try_insert(const char *key, const Rid &value) {
+    IxArtNode *node = root_;
+    IxArtNode *parent = nullptr;
+    uint8_t parent_byte = 0;
+    uint64_t v, parent_v = 0;
+    if(!read_lock(node, &v)) {
+        return -1;
+    }
+    int depth = 0;
+    while(true) {
+        int prefix_len = node->prefix_len;
+        if(depth + prefix_len >= key_len_) {
+            return -1;
+        }
+        int p = 0;
+        while(p < prefix_len && node->prefix[p] == key[depth + p]) {
+            p++;
+        }
+        if(p < prefix_len) {
+            // 根结点没有前缀，这里parent一定不为空
+            if(!upgrade_to_write_lock(parent, parent_v)) {
+                return -1;
+            }
+            if(!upgrade_to_write_lock(node, v)) {
+                write_unlock(parent);
+                return -1;
+            }
+            IxArtNode *split = make_node(ART_NODE4, node->prefix, p);
+            add_child(split, node->prefix[p], node);
+            add_child(split, key[depth + p], tag_leaf(make_leaf(key, value)));
+            memmove(node->prefix, node->prefix + p + 1, prefix_len - p - 1);
+            node->prefix_len = prefix_len - p - 1;
+            change_child(parent, parent_byte, split);
+            write_unlock(node);
+            write_unlock(parent);
+            return 1;
+        }
+        depth += prefix_len;
+        uint8_t byte = key[depth];
+        void *child = find_child(node, byte);
+        if(!check_version(node, v)) {
+            return -1;
+        }
+
+        if(child == nullptr) {
+            if(!is_full(node)) {
+                if(!upgrade_to_write_lock(node, v)) {
+                    return -1;
+                }
+                add_child(node, byte, tag_leaf(make_leaf(key, value)));
+                write_unlock(node);
+                return 1;
+            }
+            if(!upgrade_to_write_lock(parent, parent_v)) {
+                return -1;
+            }
+            if(!upgrade_to_write_lock(node, v)) {
+                write_unlock(parent);
+                return -1;
+            }
+            IxArtNode *bigger = make_node(node->type + 1, node->prefix, node->prefix_len);
+            for_each_child(node, [&](uint8_t b, void *c) { add_child(bigger, b, c); });
+            add_child(bigger, byte, tag_leaf(make_leaf(key, value)));
+            change_child(parent, parent_byte, bigger);
+            write_unlock_obsolete(node);
+            write_unlock(parent);
+            retire(node);
+            return 1;
+        }
+
+        if(is_leaf(child)) {
+            // 从根结点到这里的字节都和key相同，只需要比较depth之后的部分
+            IxArtLeaf *leaf = as_leaf(child);
+            int i = depth + 1;
+            while(i < key_len_ && leaf->key[i] == key[i]) {
+                i++;
+            }
+            if(i == key_len_) {
+                return 0;
+            }
+            if(!upgrade_to_write_lock(node, v)) {
+                return -1;
+            }
+            IxArtNode *split = make_node(ART_NODE4, key + depth + 1, i - depth - 1);
+            add_child(split, leaf->key[i], child);
+            add_child(split, key[i], tag_leaf(make_leaf(key, value)));
+            change_child(node, byte, split);
+            write_unlock(node);
+            return 1;
+        }
+
+        depth++;
+        parent = node;
+        parent_v = v;
+        parent_byte = byte;
+        node = static_cast<IxArtNode *>(child);
+        if(!read_lock(node, &v) || !check_version(parent, parent_v)) {
+            return -1;
+        }
+    }
+}
+
+/**
+ * @brief 乐观下降找到key的叶子，锁住叶子所在的结点后摘除
+ * @return 1表示删除成功，0表示key不存在，-1表示需要重新开始
+ */
+int IxArt::try_delete(const char *key) {
+    IxArtNode *node = root_;
+    IxArtNode *parent = nullptr;
+    uint8_t parent_byte = 0;
+    uint64_t v, parent_v = 0;
+    if(!read_lock(node, &v)) {
+        return -1;
+    }
+    int depth = 0;
+    while(true) {
+        int prefix_len = node->prefix_len;
+        if(depth + prefix_len >= key_len_) {
+            return -1;
+        }
+        if(memcmp(node->prefix, key + depth, prefix_len) != 0) {
+            return check_version(node, v) ? 0 : -1;
+        }
+        depth += prefix_len;
+        uint8_t byte = key[depth];
+        void *child = find_child(node, byte);
+        if(!check_version(node, v)) {
+            return -1;
+        }
+        if(child == nullptr) {
+            return 0;
+        }
+
+        if(is_leaf(child)) {
+            if(memcmp(as_leaf(child)->key, key, key_len_) != 0) {
+                return 0;
+            }
+            if(parent != nullptr && node->count == 1) {
+                // 结点删除后为空，整个结点从父结点中摘除
+                if(!upgrade_to_write_lock(parent, parent_v)) {
+                    return -1;
+                }
+                if(!upgrade_to_write_lock(node, v)) {
+                    write_unlock(parent);
+                    return -1;
+                }
+                remove_child(parent, parent_byte);
+                write_unlock_obsolete(node);
+                write_unlock(parent);
+                retire(node);
+            } else {
+                if(!upgrade_to_write_lock(node, v)) {
+                    return -1;
+                }
+                remove_child(node, byte);
+                write_unlock(node);
+            }
+            retire(child);
+            return 1;
+        }
+
+        depth++;
+        parent = node;
+        parent_v = v;
+        parent_byte = byte;
+        node = static_cast<IxArtNode *>(child);
+        if(!read_lock(node, &v) || !check_version(parent, parent_v)) {
+            return -1;
+        }
+    }
+}
+
+/**
+ * @brief 按字节顺序深度优先遍历整棵树，叶子按key从小到大访问，统计值都是精确的
+ * 叶子个数和键值对个数相同，填充率为内部结点的孩子个数占结点容量的比例
+ */
+void IxArt::get_stats(IxIndexStats *stats) {
+    EpochGuard guard(this);
+    int col_num = file_hdr_->col_num_;
+    stats->distinct.assign(col_num, 0);
+    // prefix_lens[c]为前c+1个字段的总长度
+    std::vector<int> prefix_lens(col_num);
+    for(int c = 0, len = 0; c < col_num; c++) {
+        len += file_hdr_->col_lens_[c];
+        prefix_lens[c] = len;
+    }
+
+    int64_t children = 0;
+    int64_t slots = 0;
+    const char *prev = nullptr;
+    // 栈中保存(孩子指针, 层数)，孩子逆序入栈，出栈的叶子按key从小到大排列
+    std::vector<std::pair<void *, int>> stack{{root_, 1}};
+    while(!stack.empty()) {
+        auto [ptr, level] = stack.back();
+        stack.pop_back();
+        if(is_leaf(ptr)) {
+            const char *key = as_leaf(ptr)->key;
+            stats->num_leaves++;
+            for(int c = 0; c < col_num; c++) {
+                if(prev == nullptr || memcmp(prev, key, prefix_lens[c]) != 0) {
+                    stats->distinct[c]++;
+                }
+            }
+            prev = key;
+            continue;
+        }
+        auto node = static_cast<IxArtNode *>(ptr);
+        stats->num_inner++;
+        stats->height = std::max(stats->height, level + 1);
+        children += node->count;
+        slots += capacity(node);
+        size_t begin = stack.size();
+        for_each_child(node, [&](uint8_t, void *c) { stack.push_back({c, level + 1}); });
+        std::reverse(stack.begin() + begin, stack.end());
+    }
+    stats->sampled_leaves = stats->num_leaves;
+    stats->num_keys = stats->num_leaves;
+    stats->avg_fill = slots > 0 ? (double)children / slots : 0;
+}
+
+uint64_t IxArt::enter_epoch() {
+    while(true) {
+        uint64_t gen = gen_.load();
+        active_[gen & 1].fetch_add(1);
+        // 计数之前代已经推进，换到新的代重新进入
+        if(gen_.load() == gen) {
+            return gen;
+        }
+        active_[gen & 1].fetch_sub(1);
+    }
+}
+
+void IxArt::retire(void *ptr) {
+    std::lock_guard<std::mutex> guard(retire_latch_);
+    retired_.push_back({gen_.load(), ptr});
+    if(retired_.size() >= IX_ART_RECLAIM_BATCH) {
+        try_reclaim();
+    }
+}
+
+/**
+ * @brief 当前代为g时活跃的线程只属于第g代和第g-1代；第g-1代已经没有活跃的线程时，
+ * 第g代之前退役的对象不会再被任何线程访问，可以释放，同时推进到第g+1代。调用时持有retire_latch_
+ */
+void IxArt::try_reclaim() {
+    uint64_t gen = gen_.load();
+    if(active_[(gen + 1) & 1].load() != 0) {
+        return;
+    }
+    size_t kept = 0;
+    for(auto &entry : retired_) {
+        if(entry.first < gen) {
+            free_ptr(entry.second);
+        } else {
+            retired_[kept++] = entry;
+        }
+    }
+    retired_.resize(kept);
+    gen_.store(gen + 1);
+}
+
+IxArtLeaf *IxArt::make_leaf(const char *key, const Rid &rid) const {
+    auto leaf = static_cast<IxArtLeaf *>(std::malloc(offsetof(IxArtLeaf, key) + key_len_));
+    leaf->rid = rid;
+    memcpy(leaf->key, key, key_len_);
+    return leaf;
+}
+
+IxArtNode *IxArt::make_node(int type, const char *prefix, int prefix_len) const {
+    IxArtNode *node;
+    switch(type) {
+        case ART_NODE4:
+            node = new IxArtNode4();
+            break;
+        case ART_NODE16:
+            node = new IxArtNode16();
+            break;
+        case ART_NODE48: {
+            auto n = new IxArtNode48();
+            memset(n->child_index, ART_NODE48_EMPTY, sizeof(n->child_index));
+            node = n;
+            break;
+        }
+        default:
+            node = new IxArtNode256();
+    }
+    node->type = type;
+    node->prefix_len = prefix_len;
+    node->prefix = new char[key_len_];
+    if(prefix_len > 0) {
+        memcpy(node->prefix, prefix, prefix_len);
+    }
+    return node;
+}
+
+void IxArt::free_ptr(void *ptr) {
+    if(is_leaf(ptr)) {
+        std::free(as_leaf(ptr));
+        return;
+    }
+    auto node = static_cast<IxArtNode *>(ptr);
+    delete[] node->prefix;
+    switch(node->type) {
+        case ART_NODE4:
+            delete static_cast<IxArtNode4 *>(node);
+            break;
+        case ART_NODE16:
+            delete static_cast<IxArtNode16 *>(node);
+            break;
+        case ART_NODE48:
+            delete static_cast<IxArtNode48 *>(node);
+            break;
+        default:
+            delete static_cast<IxArtNode256 *>(node);
+    }
+}
+
+// 释放整棵树，只在析构时调用，孩子指针中已退役的结点不会再出现在树中
+void IxArt::free_tree(IxArtNode *node) {
+    for_each_child(node, [](uint8_t, void *child) {
+        if(is_leaf(child)) {
+            free_ptr(child);
+        } else {
+            free_tree(static_cast<IxArtNode *>(child));
+        }
+    });
+    free_ptr(node);
+}
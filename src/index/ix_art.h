@@ -0,0 +1,84 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "ix_defs.h"
+
+struct IxArtNode;
+struct IxArtLeaf;
+
+/**
+ * @brief 自适应基数树(ART)索引，整棵树只在内存中，索引文件只有文件头，打开数据库并完成故障恢复之后从表中重建
+ * key按ix_encode_key编码之后保存，所有key等长且可以memcmp比较，逐字节下降；
+ * 内部结点按孩子个数在Node4/16/48/256之间增长，结点保存完整的压缩前缀，叶子保存完整的key和rid
+ *
+ * 并发控制使用乐观锁耦合(optimistic lock coupling)：每个结点有一个版本号，
+ * 读者不加锁，读完结点之后检查版本号没有变化，变化了就从根结点重新开始；写者只对要修改的结点（及其父结点）加锁。
+ * 被替换的结点和删除的叶子不能立即释放（读者可能还在访问），退役之后按epoch回收
+ */
+class IxArt {
+   private:
+    IxFileHdr *file_hdr_;
+    int key_len_;
+    IxArtNode *root_;                       // 根结点固定为Node256，不会增长也不会被替换
+
+    // epoch回收：gen_为当前代，active_[g & 1]是第g代进入的线程个数，任意时刻活跃的线程只属于当前代和上一代
+    std::atomic<uint64_t> gen_{0};
+    std::atomic<int> active_[2] = {{0}, {0}};
+    std::mutex retire_latch_;
+    std::vector<std::pair<uint64_t, void *>> retired_;  // (退役时的代, 结点或带标记的叶子指针)
+
+   public:
+    explicit IxArt(IxFileHdr *file_hdr);
+
+    ~IxArt();
+
+    // 以下接口的key都是编码后的格式
+    bool get_value(const char *key, std::vector<Rid> *result);
+
+    // key已经存在时不插入，返回false
+    bool insert_entry(const char *key, const Rid &value);
+
+    bool delete_entry(const char *key);
+
+    // 统计结点个数、树高、结点的平均填充率和各前缀的不同取值个数，调用者需要持有表锁
+    void get_stats(IxIndexStats *stats);
+
+   private:
+    class EpochGuard;
+
+    uint64_t enter_epoch();
+
+    void exit_epoch(uint64_t gen) { active_[gen & 1].fetch_sub(1); }
+
+    void retire(void *ptr);
+
+    void try_reclaim();
+
+    IxArtLeaf *make_leaf(const char *key, const Rid &rid) const;
+
+    IxArtNode *make_node(int type, const char *prefix, int prefix_len) const;
+
+    static void free_ptr(void *ptr);
+
+    static void free_tree(IxArtNode *node);
+
+    // 以下三个函数遇到版本号变化时返回-1，调用者从根结点重新开始
+    int try_get(const char *key, Rid *rid);
+
+    int try_insert(const char *key, const Rid &value);
+
+    int try_delete(const char *key);
+};
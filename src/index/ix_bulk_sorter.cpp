@@ -0,0 +1,137 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_bulk_sorter.h"
+
+#include <algorithm>
+
+IxBulkSorter::IxBulkSorter(const IxFileHdr *file_hdr, size_t buffer_size) : file_hdr_(file_hdr) {
+    key_len_ = file_hdr_->col_tot_len_;
+    entry_len_ = key_len_ + sizeof(Rid);
+    max_entries_ = std::max<size_t>(1, buffer_size / entry_len_);
+    num_entries_ = 0;
+    pos_ = 0;
+    finished_ = false;
+}
+
+IxBulkSorter::~IxBulkSorter() {
+    // tmpfile创建的文件在关闭时自动删除
+    for(auto run : runs_) {
+        fclose(run);
+    }
+}
+
+void IxBulkSorter::add(const char *key, const Rid &rid) {
+    assert(!finished_);
+    if(buf_.size() / entry_len_ == max_entries_) {
+        spill_run();
+    }
+    size_t offset = buf_.size();
+    buf_.resize(offset + entry_len_);
+    // 编码索引在排序前先把key编码，排序和建树都按编码后的格式比较
+    if(file_hdr_->is_normalized_) {
+        ix_encode_key(file_hdr_, key, buf_.data() + offset);
+    } else {
+        memcpy(buf_.data() + offset, key, key_len_);
+    }
+    memcpy(buf_.data() + offset + key_len_, &rid, sizeof(Rid));
+    num_entries_++;
+}
+
+void IxBulkSorter::finish() {
+    assert(!finished_);
+    finished_ = true;
+    if(runs_.empty()) {
+        // 全部数据都在内存中，直接排序
+        sort_buffer();
+        pos_ = 0;
+        return;
+    }
+    if(!buf_.empty()) {
+        spill_run();
+    }
+    // 每个run读出第一项，建立小根堆
+    heads_.resize(runs_.size());
+    for(size_t i = 0; i < runs_.size(); i++) {
+        rewind(runs_[i]);
+        heads_[i].resize(entry_len_);
+        if(read_head(i)) {
+            heap_.push_back(i);
+        }
+    }
+    auto greater = [this](int a, int b) { return compare(heads_[a].data(), heads_[b].data()) > 0; };
+    std::make_heap(heap_.begin(), heap_.end(), greater);
+}
+
+bool IxBulkSorter::next(char *key, Rid *rid) {
+    assert(finished_);
+    if(runs_.empty()) {
+        if(pos_ == order_.size()) {
+            return false;
+        }
+        const char *entry = buf_.data() + order_[pos_++] * entry_len_;
+        memcpy(key, entry, key_len_);
+        memcpy(rid, entry + key_len_, sizeof(Rid));
+        return true;
+    }
+
+    if(heap_.empty()) {
+        return false;
+    }
+    auto greater = [this](int a, int b) { return compare(heads_[a].data(), heads_[b].data()) > 0; };
+    std::pop_heap(heap_.begin(), heap_.end(), greater);
+    int run = heap_.back();
+    memcpy(key, heads_[run].data(), key_len_);
+    memcpy(rid, heads_[run].data() + key_len_, sizeof(Rid));
+    if(read_head(run)) {
+        std::push_heap(heap_.begin(), heap_.end(), greater);
+    } else {
+        heap_.pop_back();
+    }
+    return true;
+}
+
+/**
+ * @description: 对buf_中的项按key排序，结果保存在order_中，不移动buf_中的数据
+ */
+void IxBulkSorter::sort_buffer() {
+    size_t n = buf_.size() / entry_len_;
+    order_.resize(n);
+    for(size_t i = 0; i < n; i++) {
+        order_[i] = i;
+    }
+    const char *base = buf_.data();
+    std::sort(order_.begin(), order_.end(), [this, base](size_t a, size_t b) {
+        return compare(base + a * entry_len_, base + b * entry_len_) < 0;
+    });
+}
+
+/**
+ * @description: 把内存中的项排好序后写入一个新的临时文件，然后清空缓冲区
+ */
+void IxBulkSorter::spill_run() {
+    sort_buffer();
+    FILE *run = tmpfile();
+    if(run == nullptr) {
+        throw UnixError();
+    }
+    runs_.push_back(run);
+    for(auto idx : order_) {
+        if(fwrite(buf_.data() + idx * entry_len_, entry_len_, 1, run) != 1) {
+            throw UnixError();
+        }
+    }
+    buf_.clear();
+    order_.clear();
+}
+
+bool IxBulkSorter::read_head(int run) {
+    return fread(heads_[run].data(), entry_len_, 1, runs_[run]) == 1;
+}
@@ -0,0 +1,65 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdio>
+
+#include "ix_defs.h"
+#include "ix_index_handle.h"
+
+/**
+ * 批量建索引时对(key, rid)排序
+ * 内存中最多缓存buffer_size字节，超出时把当前缓冲区排好序写入临时文件作为一个run，
+ * finish之后按key从小到大依次取出，有多个run时做多路归并
+ */
+class IxBulkSorter {
+   private:
+    const IxFileHdr *file_hdr_;
+    int key_len_;                       // key的长度，即col_tot_len
+    int entry_len_;                     // 每一项的长度，key | rid
+    size_t max_entries_;                // 内存中最多缓存的项数
+    size_t num_entries_;                // 一共加入的项数
+
+    std::vector<char> buf_;             // 内存中的项，按加入顺序紧密排列
+    std::vector<size_t> order_;         // buf_排序后的下标
+    size_t pos_;                        // 只有内存中的数据时，下一个要读取的order_下标
+
+    std::vector<FILE *> runs_;          // 已经写入临时文件的有序run
+    std::vector<std::vector<char>> heads_;  // 每个run当前的第一项
+    std::vector<int> heap_;             // 还有数据的run，按heads_中的key组成小根堆
+    bool finished_;
+
+   public:
+    IxBulkSorter(const IxFileHdr *file_hdr, size_t buffer_size = IX_BULK_SORT_BUFFER_SIZE);
+
+    ~IxBulkSorter();
+
+    void add(const char *key, const Rid &rid);
+
+    // 输入结束，之后只能调用next
+    void finish();
+
+    // 按key从小到大取出下一项，没有数据时返回false；编码索引取出的是编码后的key
+    bool next(char *key, Rid *rid);
+
+    size_t size() const { return num_entries_; }
+
+   private:
+    void sort_buffer();
+
+    void spill_run();
+
+    bool read_head(int run);
+
+    int compare(const char *a, const char *b) const {
+        return file_hdr_->key_compare_(a, b, file_hdr_);
+    }
+};
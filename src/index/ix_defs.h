@@ -16,11 +16,21 @@ See the Mulan PSL v2 for more details. */
 #include "storage/buffer_pool_manager.h"
 
 constexpr int IX_NO_PAGE = -1;
+constexpr int IX_DUPLICATE_KEY = -2;   // 插入时发现key已经存在，没有插入
 constexpr int IX_FILE_HDR_PAGE = 0;
 constexpr int IX_LEAF_HEADER_PAGE = 1;
 constexpr int IX_INIT_ROOT_PAGE = 2;
 constexpr int IX_INIT_NUM_PAGES = 3;
 constexpr int IX_MAX_COL_LEN = 512;
+static const std::string IX_COMPACT_FILE_SUFFIX = ".compact";   // vacuum重建索引时新索引先写入索引文件名加上该后缀的临时文件
+
+class IxFileHdr;
+
+/* 结点内查找key的方式，单字段的INT/BIGINT/DATETIME可以直接在key数组上做SIMD查找 */
+enum class IxKeyKind { GENERIC = 0, INT, BIGINT, DATETIME };
+
+/* 按索引字段类型特化的key比较函数，a < b返回负数，a = b返回0，a > b返回正数 */
+using IxKeyCompareFn = int (*)(const char *a, const char *b, const IxFileHdr *file_hdr);
 
 class IxFileHdr {
 public: 
@@ -37,9 +47,28 @@ public:
     page_id_t first_leaf_;              // 首叶节点对应的页号，在上层IxManager的open函数进行初始化，初始化为root page_no
     page_id_t last_leaf_;               // 尾叶节点对应的页号
     int tot_len_;                       // 记录结构体的整体长度
+    bool is_blink_;                     // 是否为B-link树：内部结点也有右链接，每个结点保存high key，读者不需要持有父结点的锁
+    bool is_normalized_;                // key是否按可memcmp比较的格式保存（整数大端并翻转符号位、浮点数按位变换），只对B+树内部可见
+    bool is_compressed_;                // 结点是否只保存key的公共前缀/后缀和各key中间不同的部分，只用于可memcmp比较的key
+    bool is_hash_;                      // 是否为可扩展哈希索引，此时btree_order_是每个桶的容量，只支持等值查找
+    int fill_factor_;                   // 填充率(%)：批量建树时每个结点的填充率，顺序插入时最右结点分裂后左边保留的比例
+    bool is_art_;                       // 是否为内存中的自适应基数树索引，文件中只有文件头，故障恢复之后从表中重建
+    bool is_lazy_delete_;               // 删除时是否只修改叶子结点，不合并、不重分配，空结点留到vacuum时整体重建
+    // 以下两个字段不写入磁盘，打开索引时由IxIndexHandle根据字段类型设置
+    IxKeyKind key_kind_;
+    IxKeyCompareFn key_compare_;
 
     IxFileHdr() {
         tot_len_ = col_num_ = 0;
+        is_blink_ = false;
+        is_normalized_ = false;
+        is_compressed_ = false;
+        is_hash_ = false;
+        fill_factor_ = IX_DEFAULT_FILL_FACTOR;
+        is_art_ = false;
+        is_lazy_delete_ = false;
+        key_kind_ = IxKeyKind::GENERIC;
+        key_compare_ = nullptr;
     }
 
     IxFileHdr(page_id_t first_free_page_no, int num_pages, page_id_t root_page, int col_num,
@@ -47,11 +76,20 @@ public:
                 : first_free_page_no_(first_free_page_no), num_pages_(num_pages), root_page_(root_page), col_num_(col_num),
                 col_tot_len_(col_tot_len), btree_order_(btree_order), keys_size_(keys_size), first_leaf_(first_leaf), last_leaf_(last_leaf) {
                     tot_len_ = 0;
+                    is_blink_ = false;
+                    is_normalized_ = false;
+                    is_compressed_ = false;
+                    is_hash_ = false;
+                    fill_factor_ = IX_DEFAULT_FILL_FACTOR;
+                    is_art_ = false;
+                    is_lazy_delete_ = false;
+                    key_kind_ = IxKeyKind::GENERIC;
+                    key_compare_ = nullptr;
                 } 
 
     void update_tot_len() {
         tot_len_ = 0;
-        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 6;
+        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 13;
         tot_len_ += sizeof(ColType) * col_num_ + sizeof(int) * col_num_;
     }
 
@@ -85,6 +123,26 @@ public:
         offset += sizeof(page_id_t);
         memcpy(dest + offset, &last_leaf_, sizeof(page_id_t));
         offset += sizeof(page_id_t);
+        int is_blink = is_blink_;
+        memcpy(dest + offset, &is_blink, sizeof(int));
+        offset += sizeof(int);
+        int is_normalized = is_normalized_;
+        memcpy(dest + offset, &is_normalized, sizeof(int));
+        offset += sizeof(int);
+        int is_compressed = is_compressed_;
+        memcpy(dest + offset, &is_compressed, sizeof(int));
+        offset += sizeof(int);
+        int is_hash = is_hash_;
+        memcpy(dest + offset, &is_hash, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, &fill_factor_, sizeof(int));
+        offset += sizeof(int);
+        int is_art = is_art_;
+        memcpy(dest + offset, &is_art, sizeof(int));
+        offset += sizeof(int);
+        int is_lazy_delete = is_lazy_delete_;
+        memcpy(dest + offset, &is_lazy_delete, sizeof(int));
+        offset += sizeof(int);
         assert(offset == tot_len_);
     }
 
@@ -123,6 +181,42 @@ public:
         offset += sizeof(page_id_t);
         last_leaf_ = *reinterpret_cast<const page_id_t*>(src + offset);
         offset += sizeof(page_id_t);
+        // 旧版本的索引文件没有is_blink、is_normalized、is_compressed、is_hash、fill_factor、is_art和is_lazy_delete字段
+        is_blink_ = false;
+        if(offset < tot_len_) {
+            is_blink_ = *reinterpret_cast<const int*>(src + offset) != 0;
+            offset += sizeof(int);
+        }
+        is_normalized_ = false;
+        if(offset < tot_len_) {
+            is_normalized_ = *reinterpret_cast<const int*>(src + offset) != 0;
+            offset += sizeof(int);
+        }
+        is_compressed_ = false;
+        if(offset < tot_len_) {
+            is_compressed_ = *reinterpret_cast<const int*>(src + offset) != 0;
+            offset += sizeof(int);
+        }
+        is_hash_ = false;
+        if(offset < tot_len_) {
+            is_hash_ = *reinterpret_cast<const int*>(src + offset) != 0;
+            offset += sizeof(int);
+        }
+        fill_factor_ = IX_DEFAULT_FILL_FACTOR;
+        if(offset < tot_len_) {
+            fill_factor_ = *reinterpret_cast<const int*>(src + offset);
+            offset += sizeof(int);
+        }
+        is_art_ = false;
+        if(offset < tot_len_) {
+            is_art_ = *reinterpret_cast<const int*>(src + offset) != 0;
+            offset += sizeof(int);
+        }
+        is_lazy_delete_ = false;
+        if(offset < tot_len_) {
+            is_lazy_delete_ = *reinterpret_cast<const int*>(src + offset) != 0;
+            offset += sizeof(int);
+        }
         assert(offset == tot_len_);
     }
 };
@@ -135,6 +229,17 @@ public:
     bool is_leaf;                   // 是否为叶节点
     page_id_t prev_leaf;            // previous leaf node's page_no, effective only when is_leaf is true
     page_id_t next_leaf;            // next leaf node's page_no, effective only when is_leaf is true
+                                    // B-link树中内部结点用它保存右兄弟的page_no（右链接），没有右兄弟时为IX_NO_PAGE
+};
+
+/**
+ * 压缩结点的页面布局：| IxPageHdr | IxCompressHdr | 模板key | high key | rids[n] | 各key去掉公共前缀和后缀后的中间部分[n] |
+ * 模板key是结点中任意一个key，其前prefix_len字节是所有key的公共前缀，后suffix_len字节是所有key的公共后缀
+ */
+class IxCompressHdr {
+public:
+    int16_t prefix_len;             // 所有key的公共前缀长度
+    int16_t suffix_len;             // 所有key的公共后缀长度（定长字符串末尾补的0通常都在这里）
 };
 
 class Iid {
@@ -145,4 +250,15 @@ public:
     friend bool operator==(const Iid &x, const Iid &y) { return x.page_no == y.page_no && x.slot_no == y.slot_no; }
 
     friend bool operator!=(const Iid &x, const Iid &y) { return !(x == y); }
-};
\ No newline at end of file
+};
+// 索引的统计信息，由IxIndexHandle::get_stats遍历内部结点并读取（或抽样读取）叶子得到
+class IxIndexStats {
+public:
+    int height = 0;                         // 树高，只有一片叶子时为1；哈希索引为1；ART为最深的叶子所在的层数
+    int num_inner = 0;                      // 内部结点个数，哈希索引为目录页个数
+    int num_leaves = 0;                     // 叶子个数，哈希索引为桶页（含溢出页）个数；ART每个叶子是一个键值对
+    int sampled_leaves = 0;                 // 实际读取的叶子个数，小于num_leaves时键值对个数和不同取值个数都是估计值
+    int64_t num_keys = 0;                   // 键值对个数
+    double avg_fill = 0;                    // 叶子的平均填充率，按btree_order_计算，压缩结点可能超过1；ART为内部结点的孩子数占容量的比例
+    std::vector<int64_t> distinct;          // distinct[i]为前i+1个字段不同取值的个数，-1表示无法统计
+};
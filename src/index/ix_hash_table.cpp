@@ -0,0 +1,363 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_hash_table.h"
+
+#include <unordered_set>
+
+IxHashTable::IxHashTable(BufferPoolManager *buffer_pool_manager, int fd, IxFileHdr *file_hdr)
+    : buffer_pool_manager_(buffer_pool_manager), fd_(fd), file_hdr_(file_hdr) {
+    // 读取目录页的页号，再把整个目录读入内存
+    Page *hdr_page = fetch_page(IX_HASH_DIR_HDR_PAGE);
+    auto dir_hdr = reinterpret_cast<IxHashDirHdr *>(hdr_page->get_data());
+    global_depth_ = dir_hdr->global_depth;
+    auto pages = reinterpret_cast<page_id_t *>(hdr_page->get_data() + sizeof(IxHashDirHdr));
+    dir_pages_.assign(pages, pages + dir_hdr->num_dir_pages);
+    unpin(hdr_page, false);
+
+    dir_.resize(1 << global_depth_);
+    for(int begin = 0; begin < (int)dir_.size(); begin += IX_HASH_DIR_PER_PAGE) {
+        Page *page = fetch_page(dir_pages_[begin / IX_HASH_DIR_PER_PAGE]);
+        int n = std::min<int>(IX_HASH_DIR_PER_PAGE, dir_.size() - begin);
+        memcpy(dir_.data() + begin, page->get_data(), n * sizeof(page_id_t));
+        unpin(page, false);
+    }
+}
+
+/**
+ * @brief 在新建的索引文件中写入目录头、只有一项的目录和一个空桶
+ */
+void IxHashTable::init_file(DiskManager *disk_manager, int fd) {
+    char page_buf[PAGE_SIZE];
+
+    memset(page_buf, 0, PAGE_SIZE);
+    auto dir_hdr = reinterpret_cast<IxHashDirHdr *>(page_buf);
+    dir_hdr->global_depth = 0;
+    dir_hdr->num_dir_pages = 1;
+    page_id_t dir_page = IX_HASH_INIT_DIR_PAGE;
+    memcpy(page_buf + sizeof(IxHashDirHdr), &dir_page, sizeof(page_id_t));
+    disk_manager->write_page(fd, IX_HASH_DIR_HDR_PAGE, page_buf, PAGE_SIZE);
+
+    memset(page_buf, 0, PAGE_SIZE);
+    page_id_t bucket_page = IX_HASH_INIT_BUCKET_PAGE;
+    memcpy(page_buf, &bucket_page, sizeof(page_id_t));
+    disk_manager->write_page(fd, IX_HASH_INIT_DIR_PAGE, page_buf, PAGE_SIZE);
+
+    memset(page_buf, 0, PAGE_SIZE);
+    auto bucket = reinterpret_cast<IxHashBucketHdr *>(page_buf);
+    bucket->num_key = 0;
+    bucket->local_depth = 0;
+    bucket->next_overflow = IX_NO_PAGE;
+    disk_manager->write_page(fd, IX_HASH_INIT_BUCKET_PAGE, page_buf, PAGE_SIZE);
+}
+
+/**
+ * @brief 计算编码后key的哈希值，FNV-1a之后再做一次混合，保证低位分布均匀
+ * 哈希值决定key在文件中的位置，不能依赖std::hash等和实现相关的函数
+ */
+uint32_t IxHashTable::hash(const char *key) const {
+    uint64_t h = 14695981039346656037ull;
+    for(int i = 0; i < file_hdr_->col_tot_len_; i++) {
+        h ^= static_cast<unsigned char>(key[i]);
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return static_cast<uint32_t>(h);
+}
+
+Page *IxHashTable::create_page() {
+    std::lock_guard<std::mutex> guard(alloc_latch_);
+    file_hdr_->num_pages_++;
+    PageId page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
+    Page *page = buffer_pool_manager_->new_page(&page_id);
+    memset(page->get_data(), 0, PAGE_SIZE);
+    return page;
+}
+
+/**
+ * @brief 在一个桶页中查找key，先比较保存的哈希值再比较key
+ * @return 所在的slot，不存在时返回-1
+ */
+int IxHashTable::bucket_find(Page *page, const char *key, uint32_t h) const {
+    int num_key = bucket_hdr(page)->num_key;
+    const uint32_t *hashes = bucket_hashes(page);
+    for(int slot = 0; slot < num_key; slot++) {
+        if(hashes[slot] == h && memcmp(bucket_key(page, slot), key, file_hdr_->col_tot_len_) == 0) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 等值查找，溢出页由桶的主页面的页面锁保护
+ */
+bool IxHashTable::get_value(const char *key, std::vector<Rid> *result) {
+    uint32_t h = hash(key);
+    std::shared_lock<std::shared_mutex> dir_guard(dir_latch_);
+    Page *primary = fetch_page(dir_[dir_index(h)]);
+    primary->RLatch();
+    bool found = false;
+    Page *page = primary;
+    while(true) {
+        int slot = bucket_find(page, key, h);
+        page_id_t next = bucket_hdr(page)->next_overflow;
+        if(slot != -1) {
+            result->push_back(bucket_rids(page)[slot]);
+            found = true;
+        }
+        if(page != primary) {
+            unpin(page, false);
+        }
+        if(found || next == IX_NO_PAGE) {
+            break;
+        }
+        page = fetch_page(next);
+    }
+    primary->RUnlatch();
+    unpin(primary, false);
+    return found;
+}
+
+/**
+ * @brief 插入键值对，桶满时在目录写锁下分裂后重试；桶的深度达到IX_HASH_MAX_DEPTH之后改为链接溢出页
+ * @return 插入的页面号
+ */
+page_id_t IxHashTable::insert_entry(const char *key, const Rid &value) {
+    uint32_t h = hash(key);
+    int capacity = file_hdr_->btree_order_;
+    while(true) {
+        std::shared_lock<std::shared_mutex> dir_guard(dir_latch_);
+        Page *primary = fetch_page(dir_[dir_index(h)]);
+        primary->WLatch();
+
+        // 遍历整个链检查key是否重复，同时找到第一个有空位的页面
+        std::vector<Page *> chain = {primary};
+        Page *target = nullptr;
+        bool duplicate = false;
+        while(true) {
+            Page *page = chain.back();
+            if(bucket_find(page, key, h) != -1) {
+                duplicate = true;
+                break;
+            }
+            if(target == nullptr && bucket_hdr(page)->num_key < capacity) {
+                target = page;
+            }
+            if(bucket_hdr(page)->next_overflow == IX_NO_PAGE) {
+                break;
+            }
+            chain.push_back(fetch_page(bucket_hdr(page)->next_overflow));
+        }
+
+        bool split = false;
+        page_id_t page_no = IX_NO_PAGE;
+        if(!duplicate) {
+            if(target == nullptr && bucket_hdr(primary)->local_depth < IX_HASH_MAX_DEPTH) {
+                split = true;
+            } else {
+                if(target == nullptr) {
+                    target = create_page();
+                    bucket_hdr(target)->local_depth = bucket_hdr(primary)->local_depth;
+                    bucket_hdr(target)->next_overflow = IX_NO_PAGE;
+                    bucket_hdr(chain.back())->next_overflow = target->get_page_id().page_no;
+                    chain.push_back(target);
+                }
+                int slot = bucket_hdr(target)->num_key++;
+                bucket_hashes(target)[slot] = h;
+                bucket_rids(target)[slot] = value;
+                memcpy(bucket_key(target, slot), key, file_hdr_->col_tot_len_);
+                page_no = target->get_page_id().page_no;
+            }
+        }
+        for(size_t i = 1; i < chain.size(); i++) {
+            unpin(chain[i], !duplicate && !split);
+        }
+        primary->WUnlatch();
+        unpin(primary, !duplicate && !split);
+
+        if(duplicate) {
+            return IX_DUPLICATE_KEY;
+        }
+        if(!split) {
+            return page_no;
+        }
+        dir_guard.unlock();
+        std::unique_lock<std::shared_mutex> split_guard(dir_latch_);
+        // 释放读锁到加上写锁之间其它线程可能已经分裂过这个桶，split_bucket中会重新检查
+        split_bucket(dir_index(h));
+    }
+}
+
+/**
+ * @brief 删除键值对，用桶（或溢出页）中的最后一项填补空位，不合并桶也不缩小目录
+ */
+bool IxHashTable::delete_entry(const char *key) {
+    uint32_t h = hash(key);
+    std::shared_lock<std::shared_mutex> dir_guard(dir_latch_);
+    Page *primary = fetch_page(dir_[dir_index(h)]);
+    primary->WLatch();
+    bool found = false;
+    Page *page = primary;
+    while(true) {
+        int slot = bucket_find(page, key, h);
+        if(slot != -1) {
+            int last = --bucket_hdr(page)->num_key;
+            bucket_hashes(page)[slot] = bucket_hashes(page)[last];
+            bucket_rids(page)[slot] = bucket_rids(page)[last];
+            memmove(bucket_key(page, slot), bucket_key(page, last), file_hdr_->col_tot_len_);
+            found = true;
+        }
+        page_id_t next = bucket_hdr(page)->next_overflow;
+        if(page != primary) {
+            unpin(page, found);
+        }
+        if(found || next == IX_NO_PAGE) {
+            break;
+        }
+        page = fetch_page(next);
+    }
+    primary->WUnlatch();
+    unpin(primary, found && page == primary);
+    return found;
+}
+
+/**
+ * @brief 统计哈希索引：目录页算作内部结点，桶页和溢出页算作叶子
+ * 哈希索引中key唯一，完整key的不同取值个数就是键值对个数；前缀的不同取值散落在各个桶中，不做统计
+ */
+void IxHashTable::get_stats(IxIndexStats *stats) {
+    std::shared_lock<std::shared_mutex> dir_guard(dir_latch_);
+    std::unordered_set<page_id_t> buckets(dir_.begin(), dir_.end());
+    stats->height = 1;
+    stats->num_inner = dir_pages_.size();
+    for(page_id_t bucket : buckets) {
+        Page *primary = fetch_page(bucket);
+        primary->RLatch();
+        Page *page = primary;
+        while(true) {
+            stats->num_leaves++;
+            stats->num_keys += bucket_hdr(page)->num_key;
+            page_id_t next = bucket_hdr(page)->next_overflow;
+            if(page != primary) {
+                unpin(page, false);
+            }
+            if(next == IX_NO_PAGE) {
+                break;
+            }
+            page = fetch_page(next);
+        }
+        primary->RUnlatch();
+        unpin(primary, false);
+    }
+    stats->sampled_leaves = stats->num_leaves;
+    stats->avg_fill = stats->num_leaves > 0 ? (double)stats->num_keys / stats->num_leaves / file_hdr_->btree_order_ : 0;
+    stats->distinct.assign(file_hdr_->col_num_, -1);
+    stats->distinct.back() = stats->num_keys;
+}
+
+/**
+ * @brief 分裂目录项index指向的桶，调用时持有目录的写锁
+ * 哈希值第local_depth位为1的键值对移到新桶中，必要时先把目录翻倍
+ */
+void IxHashTable::split_bucket(int index) {
+    Page *page = fetch_page(dir_[index]);
+    auto hdr = bucket_hdr(page);
+    if(hdr->num_key < file_hdr_->btree_order_ || hdr->local_depth >= IX_HASH_MAX_DEPTH) {
+        unpin(page, false);
+        return;
+    }
+    if(hdr->local_depth == global_depth_) {
+        double_dir();
+    }
+    int local_depth = hdr->local_depth;
+    uint32_t bit = 1u << local_depth;
+
+    Page *new_page = create_page();
+    auto new_hdr = bucket_hdr(new_page);
+    new_hdr->num_key = 0;
+    new_hdr->local_depth = local_depth + 1;
+    new_hdr->next_overflow = IX_NO_PAGE;
+
+    int keep = 0;
+    uint32_t *hashes = bucket_hashes(page);
+    Rid *rids = bucket_rids(page);
+    for(int slot = 0; slot < hdr->num_key; slot++) {
+        if(hashes[slot] & bit) {
+            int pos = new_hdr->num_key++;
+            bucket_hashes(new_page)[pos] = hashes[slot];
+            bucket_rids(new_page)[pos] = rids[slot];
+            memcpy(bucket_key(new_page, pos), bucket_key(page, slot), file_hdr_->col_tot_len_);
+        } else {
+            if(keep != slot) {
+                hashes[keep] = hashes[slot];
+                rids[keep] = rids[slot];
+                memcpy(bucket_key(page, keep), bucket_key(page, slot), file_hdr_->col_tot_len_);
+            }
+            keep++;
+        }
+    }
+    hdr->num_key = keep;
+    hdr->local_depth = local_depth + 1;
+
+    // 原来指向这个桶的目录项低local_depth位都和index相同，其中第local_depth位为1的改为指向新桶
+    page_id_t new_page_no = new_page->get_page_id().page_no;
+    int low = index & (bit - 1);
+    for(int i = low; i < (int)dir_.size(); i += bit) {
+        if(i & bit) {
+            dir_[i] = new_page_no;
+            write_dir(i, i + 1);
+        }
+    }
+    unpin(new_page, true);
+    unpin(page, true);
+}
+
+/**
+ * @brief 把内存中dir_[begin, end)写回目录页
+ */
+void IxHashTable::write_dir(int begin, int end) {
+    while(begin < end) {
+        int page_idx = begin / IX_HASH_DIR_PER_PAGE;
+        int page_end = std::min(end, (page_idx + 1) * IX_HASH_DIR_PER_PAGE);
+        Page *page = fetch_page(dir_pages_[page_idx]);
+        memcpy(page->get_data() + (begin % IX_HASH_DIR_PER_PAGE) * sizeof(page_id_t), dir_.data() + begin,
+               (page_end - begin) * sizeof(page_id_t));
+        unpin(page, true);
+        begin = page_end;
+    }
+}
+
+/**
+ * @brief 目录翻倍，新的后一半和前一半指向相同的桶，需要时分配新的目录页
+ */
+void IxHashTable::double_dir() {
+    int size = dir_.size();
+    int need_pages = (2 * size + IX_HASH_DIR_PER_PAGE - 1) / IX_HASH_DIR_PER_PAGE;
+    assert(need_pages <= IX_HASH_MAX_DIR_PAGES);
+    while((int)dir_pages_.size() < need_pages) {
+        Page *page = create_page();
+        dir_pages_.push_back(page->get_page_id().page_no);
+        unpin(page, true);
+    }
+    dir_.resize(2 * size);
+    std::copy(dir_.begin(), dir_.begin() + size, dir_.begin() + size);
+    write_dir(size, 2 * size);
+    global_depth_++;
+
+    Page *hdr_page = fetch_page(IX_HASH_DIR_HDR_PAGE);
+    auto dir_hdr = reinterpret_cast<IxHashDirHdr *>(hdr_page->get_data());
+    dir_hdr->global_depth = global_depth_;
+    dir_hdr->num_dir_pages = dir_pages_.size();
+    memcpy(hdr_page->get_data() + sizeof(IxHashDirHdr), dir_pages_.data(), dir_pages_.size() * sizeof(page_id_t));
+    unpin(hdr_page, true);
+}
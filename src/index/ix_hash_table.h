@@ -0,0 +1,121 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <mutex>
+#include <shared_mutex>
+
+#include "ix_defs.h"
+#include "storage/buffer_pool_manager.h"
+
+/**
+ * 哈希索引的文件布局：
+ * | 第0页 IxFileHdr | 第1页 IxHashDirHdr | 第2页起 目录页和桶页 |
+ * 目录页是page_id_t数组，第i项是哈希值低global_depth位为i的key所在的桶；
+ * 桶页为 | IxHashBucketHdr | hashes[n] | rids[n] | keys[n] |，n保存在IxFileHdr的btree_order_中
+ */
+constexpr int IX_HASH_DIR_HDR_PAGE = 1;
+constexpr int IX_HASH_INIT_DIR_PAGE = 2;
+constexpr int IX_HASH_INIT_BUCKET_PAGE = 3;
+constexpr int IX_HASH_INIT_NUM_PAGES = 4;
+
+class IxHashDirHdr {
+public:
+    int global_depth;               // 目录大小为2^global_depth
+    int num_dir_pages;              // 目录占用的页面数量，之后紧跟着各个目录页的页号
+};
+
+class IxHashBucketHdr {
+public:
+    int num_key;                    // 桶中的键值对数量
+    int local_depth;                // 桶中所有key的哈希值低local_depth位相同
+    page_id_t next_overflow;        // 达到最大深度后不再分裂，满了之后链接的溢出页
+};
+
+constexpr int IX_HASH_DIR_PER_PAGE = PAGE_SIZE / sizeof(page_id_t);
+constexpr int IX_HASH_MAX_DIR_PAGES = (PAGE_SIZE - sizeof(IxHashDirHdr)) / sizeof(page_id_t);
+// 目录最多(PAGE_SIZE - 8) / 4个页面，global_depth最大为19
+constexpr int IX_HASH_MAX_DEPTH = 19;
+
+/**
+ * @brief 可扩展哈希索引，只支持等值查找
+ * 目录在内存中有一份完整的拷贝，修改时同时写回目录页；查找一个key只需要读一个桶页
+ * 插入、删除和查找持有目录的读锁和桶页的页面锁，桶分裂和目录翻倍时持有目录的写锁
+ * key按ix_encode_key编码之后保存，相等的key编码后的字节相同，可以直接memcmp和计算哈希值
+ */
+class IxHashTable {
+   private:
+    BufferPoolManager *buffer_pool_manager_;
+    int fd_;
+    IxFileHdr *file_hdr_;
+    std::shared_mutex dir_latch_;
+    std::mutex alloc_latch_;                // 溢出页在目录读锁下分配，分配页面需要互斥
+    int global_depth_;
+    std::vector<page_id_t> dir_;            // 目录的内存拷贝
+    std::vector<page_id_t> dir_pages_;      // 目录页的页号
+
+   public:
+    IxHashTable(BufferPoolManager *buffer_pool_manager, int fd, IxFileHdr *file_hdr);
+
+    // 以下接口的key都是编码后的格式
+    bool get_value(const char *key, std::vector<Rid> *result);
+
+    // key已经存在时不插入，返回IX_DUPLICATE_KEY
+    page_id_t insert_entry(const char *key, const Rid &value);
+
+    bool delete_entry(const char *key);
+
+    // 统计目录页、桶页的个数和桶的平均填充率
+    void get_stats(IxIndexStats *stats);
+
+    // 初始化新建的哈希索引文件中的目录和第一个桶
+    static void init_file(DiskManager *disk_manager, int fd);
+
+    // 每个桶页最多能放下的键值对数量
+    static int bucket_capacity(int key_len) {
+        return static_cast<int>((PAGE_SIZE - sizeof(IxHashBucketHdr)) / (sizeof(uint32_t) + sizeof(Rid) + key_len));
+    }
+
+   private:
+    uint32_t hash(const char *key) const;
+
+    int dir_index(uint32_t h) const { return h & ((1u << global_depth_) - 1); }
+
+    Page *fetch_page(page_id_t page_no) { return buffer_pool_manager_->fetch_page(PageId{fd_, page_no}); }
+
+    void unpin(Page *page, bool is_dirty) { buffer_pool_manager_->unpin_page(page->get_page_id(), is_dirty); }
+
+    Page *create_page();
+
+    static IxHashBucketHdr *bucket_hdr(Page *page) { return reinterpret_cast<IxHashBucketHdr *>(page->get_data()); }
+
+    static uint32_t *bucket_hashes(Page *page) {
+        return reinterpret_cast<uint32_t *>(page->get_data() + sizeof(IxHashBucketHdr));
+    }
+
+    Rid *bucket_rids(Page *page) const {
+        return reinterpret_cast<Rid *>(page->get_data() + sizeof(IxHashBucketHdr) +
+                                       sizeof(uint32_t) * file_hdr_->btree_order_);
+    }
+
+    char *bucket_key(Page *page, int slot) const {
+        return page->get_data() + sizeof(IxHashBucketHdr) +
+               (sizeof(uint32_t) + sizeof(Rid)) * file_hdr_->btree_order_ + slot * file_hdr_->col_tot_len_;
+    }
+
+    int bucket_find(Page *page, const char *key, uint32_t h) const;
+
+    void split_bucket(int index);
+
+    void write_dir(int begin, int end);
+
+    void double_dir();
+};
@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "ix_index_handle.h"
 
+#include "ix_bulk_sorter.h"
 #include "ix_scan.h"
 
 /**
@@ -20,10 +21,9 @@ See the Mulan PSL v2 for more details. */
  * @note  
  */
 bool IxNodeHandle::is_exist_key(const char *key) const{
-    int key_num = page_hdr->num_key;
+    int key_num = get_size();
     for(int i = 0;i<key_num;i++){
-        char *key_addr = get_key(i);
-        if(ix_compare(key, key_addr, file_hdr->col_types_, file_hdr->col_lens_) == 0) {
+        if(compare_at(i, key) == 0) {
             return true;
         }
     }
@@ -42,13 +42,33 @@ int IxNodeHandle::lower_bound(const char *target) const {
 
     // 提示: 可以采用多种查找方式，如顺序遍历、二分查找等；使用ix_compare()函数进行比较
 
+    // 没有解码的压缩结点直接在页面上查找
+    if(is_compressed() && !loaded_) {
+        return packed_search(target, 0, false);
+    }
+
+    // 单字段INT/BIGINT/DATETIME直接在key数组上查找
+    switch (file_hdr->key_kind_) {
+        case IxKeyKind::INT:
+            return ix_search_sorted<int32_t>(reinterpret_cast<const int32_t *>(keys), 0, page_hdr->num_key,
+                                             *reinterpret_cast<const int32_t *>(target), false);
+        case IxKeyKind::BIGINT:
+            return ix_search_sorted<int64_t>(reinterpret_cast<const int64_t *>(keys), 0, page_hdr->num_key,
+                                             *reinterpret_cast<const int64_t *>(target), false);
+        case IxKeyKind::DATETIME:
+            return ix_search_sorted<uint64_t>(reinterpret_cast<const uint64_t *>(keys), 0, page_hdr->num_key,
+                                              *reinterpret_cast<const uint64_t *>(target), false);
+        default:
+            break;
+    }
+
     if(binary_search) {
         // 二分查找
-        int left = 0, right = page_hdr->num_key;
+        int left = 0, right = get_size();
         while(left < right) {
             int mid = left + (right - left) / 2;
             char *key_addr = get_key(mid);
-            if(ix_compare(target, key_addr, file_hdr->col_types_, file_hdr->col_lens_) <= 0) {
+            if(compare_key(target, key_addr) <= 0) {
                 right = mid;
             }else {
                 left = mid + 1;
@@ -58,9 +78,9 @@ int IxNodeHandle::lower_bound(const char *target) const {
     }else {
         // 顺序查找
         int key_index = 0;
-        for(; key_index < page_hdr->num_key; key_index ++) {
+        for(; key_index < get_size(); key_index ++) {
             char *key_addr = get_key(key_index);
-            if(ix_compare(target, key_addr, file_hdr->col_types_, file_hdr->col_lens_) <= 0) {
+            if(compare_key(target, key_addr) <= 0) {
                 break;
             }
         }
@@ -80,13 +100,30 @@ int IxNodeHandle::upper_bound(const char *target) const {
 
     // 提示: 可以采用多种查找方式：顺序遍历、二分查找等；使用ix_compare()函数进行比较
 
+    if(is_compressed() && !loaded_) {
+        return packed_search(target, 1, true);
+    }
+
+    switch (file_hdr->key_kind_) {
+        case IxKeyKind::INT:
+            return ix_search_sorted<int32_t>(reinterpret_cast<const int32_t *>(keys), 1, page_hdr->num_key,
+                                             *reinterpret_cast<const int32_t *>(target), true);
+        case IxKeyKind::BIGINT:
+            return ix_search_sorted<int64_t>(reinterpret_cast<const int64_t *>(keys), 1, page_hdr->num_key,
+                                             *reinterpret_cast<const int64_t *>(target), true);
+        case IxKeyKind::DATETIME:
+            return ix_search_sorted<uint64_t>(reinterpret_cast<const uint64_t *>(keys), 1, page_hdr->num_key,
+                                              *reinterpret_cast<const uint64_t *>(target), true);
+        default:
+            break;
+    }
 
     if (binary_search) {
-        int left = 1, right = page_hdr->num_key;
+        int left = 1, right = get_size();
         while(left < right) {
             int mid = left + (right - left) / 2;
             char *key_addr = get_key(mid);
-            if(ix_compare(target, key_addr, file_hdr->col_types_, file_hdr->col_lens_) < 0) {
+            if(compare_key(target, key_addr) < 0) {
                 right = mid;
             }else {
                 left = mid + 1;
@@ -96,9 +133,9 @@ int IxNodeHandle::upper_bound(const char *target) const {
     }else {
         // 顺序查找
         int key_index = 1;
-        for(; key_index < page_hdr->num_key; key_index ++) {
+        for(; key_index < get_size(); key_index ++) {
             char *key_addr = get_key(key_index);
-            if(ix_compare(target, key_addr, file_hdr->col_types_, file_hdr->col_lens_) < 0) {
+            if(compare_key(target, key_addr) < 0) {
                 break;
             }
         }
@@ -118,14 +155,13 @@ bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
     // Todo:
     // 1. 在叶子节点中获取目标key所在位置
     int key_idx = lower_bound(key);
-    char *key_addr = get_key(key_idx);
     // 2. 判断目标key是否存在
-    if(key == nullptr || std::strcmp(key_addr, key) != 0) {
+    if(key == nullptr || key_idx == get_size()) {
         return false;
     }
     // 3. 如果存在，获取key对应的Rid，并赋值给传出参数value
     // 提示：可以调用lower_bound()和get_rid()函数。
-    if(ix_compare(key_addr, key, file_hdr->col_types_, file_hdr->col_lens_) == 0 && key_idx != page_hdr->num_key) {
+    if(compare_at(key_idx, key) == 0) {
         // key存在
         *value = get_rid(key_idx);
         return true;
@@ -176,9 +212,22 @@ void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n)
     // 1. 判断pos的合法性
     assert(pos <= get_size() && pos >= 0);
     // 2. 通过key获取n个连续键值对的key值，并把n个key值插入到pos位置
-    int num = page_hdr->num_key - pos;
+    int num = get_size() - pos;
     int key_len = file_hdr->col_tot_len_;
     int r_len = sizeof(Rid);
+    if(is_compressed()) {
+        // 压缩结点在缓存中插入，再整体写回页面
+        load();
+        assert(cache_size_ + n <= 2 * file_hdr->btree_order_);
+        char *begin_key = key_cache_.data() + pos * key_len;
+        memmove(begin_key + n * key_len, begin_key, num * key_len);
+        memcpy(begin_key, key, n * key_len);
+        memmove(&rid_cache_[pos + n], &rid_cache_[pos], num * r_len);
+        memcpy(&rid_cache_[pos], rid, n * r_len);
+        cache_size_ += n;
+        store();
+        return;
+    }
 
     char *begin_key = get_key(pos);
     memmove(begin_key + n * key_len, begin_key, num * key_len);
@@ -203,9 +252,8 @@ void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n)
 int IxNodeHandle::insert(const char *key, const Rid &value) {
     // 1. 查找要插入的键值对应该插入到当前节点的哪个位置
     int pos = lower_bound(key);
-    int flag = ix_compare(get_key(pos), key, file_hdr->col_types_, file_hdr->col_lens_);
     // 2. 如果key不重复则插入键值对
-    if(pos == get_size() || flag > 0) {
+    if(pos == get_size() || compare_at(pos, key) > 0) {
         insert_pair(pos, key, value);
     }
     // 3. 如果key重复则不插入
@@ -229,8 +277,18 @@ void IxNodeHandle::erase_pair(int pos) {
 
     int num =  get_size() - 1  - pos;
 
-    // 1. 删除该位置的key
     int key_len = file_hdr->col_tot_len_;
+    if(is_compressed()) {
+        load();
+        char *key = key_cache_.data() + pos * key_len;
+        memmove(key, key + key_len, num * key_len);
+        memmove(&rid_cache_[pos], &rid_cache_[pos + 1], num * sizeof(Rid));
+        cache_size_--;
+        store();
+        return;
+    }
+
+    // 1. 删除该位置的key
     char* key = get_key(pos);
     memmove(key,key+key_len,num*key_len);
 
@@ -261,11 +319,201 @@ int IxNodeHandle::remove(const char *key) {
     int key_idx = lower_bound(key);
     
     // 2. 如果要删除的键值对存在，删除键值对
-    if(key_idx != page_hdr->num_key && (ix_compare(get_key(key_idx),key,file_hdr->col_types_,file_hdr->col_lens_)==0)){
+    if(key_idx != get_size() && compare_at(key_idx, key) == 0){
         erase_pair(key_idx);        
     }
     // 3. 返回完成删除操作后的键值对数量
-    return page_hdr->num_key;
+    return get_size();
+}
+
+void IxNodeHandle::set_size(int size) {
+    if(is_compressed()) {
+        load();
+        cache_size_ = size;
+        store();
+        return;
+    }
+    page_hdr->num_key = size;
+}
+
+void IxNodeHandle::set_key(int key_idx, const char *key) {
+    if(is_compressed()) {
+        load();
+        memcpy(key_cache_.data() + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_);
+        store();
+        return;
+    }
+    memcpy(keys + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_);
+}
+
+void IxNodeHandle::set_rid(int rid_idx, const Rid &rid) {
+    if(is_compressed()) {
+        load();
+        rid_cache_[rid_idx] = rid;
+        store();
+        return;
+    }
+    rids[rid_idx] = rid;
+}
+
+/**
+ * @brief 判断插入key之后结点是否仍然不需要分裂
+ * 压缩结点插入key后公共前缀/后缀可能变短，需要按插入后的编码长度判断页面是否放得下
+ */
+bool IxNodeHandle::can_insert(const char *key) const {
+    if(!is_compressed()) {
+        return get_size() + 1 < get_max_size();
+    }
+    int n = get_size();
+    if(overfull_ || n + 1 >= get_max_size()) {
+        return false;
+    }
+    if(n == 0) {
+        return true;
+    }
+    // 页面上的模板key和缓存中的key编码一致，直接用页面上的前缀/后缀
+    int key_len = file_hdr->col_tot_len_;
+    const IxCompressHdr *hdr = packed_hdr();
+    const char *tmpl = packed_template_key();
+    int prefix = 0, suffix = 0;
+    while(prefix < hdr->prefix_len && key[prefix] == tmpl[prefix]) {
+        prefix++;
+    }
+    while(suffix < hdr->suffix_len && key[key_len - 1 - suffix] == tmpl[key_len - 1 - suffix]) {
+        suffix++;
+    }
+    return packed_fits(file_hdr, n + 1, key_len - prefix - suffix);
+}
+
+/**
+ * @brief 不解码，直接比较页面上第key_idx个key和target
+ */
+int IxNodeHandle::packed_compare(int key_idx, const char *target) const {
+    int key_len = file_hdr->col_tot_len_;
+    const IxCompressHdr *hdr = packed_hdr();
+    const char *tmpl = packed_template_key();
+    int mid_len = key_len - hdr->prefix_len - hdr->suffix_len;
+    int res = memcmp(tmpl, target, hdr->prefix_len);
+    if(res != 0) {
+        return res;
+    }
+    res = memcmp(packed_mids() + key_idx * mid_len, target + hdr->prefix_len, mid_len);
+    if(res != 0) {
+        return res;
+    }
+    return memcmp(tmpl + key_len - hdr->suffix_len, target + key_len - hdr->suffix_len, hdr->suffix_len);
+}
+
+/**
+ * @brief 在压缩结点的[left, num_key)中查找第一个>=target（upper时为>target）的位置
+ * 先比较公共前缀，前缀不同时target比所有key都大或都小；相同时只在各key的中间部分上二分
+ */
+int IxNodeHandle::packed_search(const char *target, int left, bool upper) const {
+    int right = page_hdr->num_key;
+    if(right <= left) {
+        return left;
+    }
+    int key_len = file_hdr->col_tot_len_;
+    const IxCompressHdr *hdr = packed_hdr();
+    const char *tmpl = packed_template_key();
+    int res = memcmp(target, tmpl, hdr->prefix_len);
+    if(res != 0) {
+        return res < 0 ? left : right;
+    }
+    int mid_len = key_len - hdr->prefix_len - hdr->suffix_len;
+    const char *mids = packed_mids();
+    const char *target_mid = target + hdr->prefix_len;
+    // 中间部分相同时key和target的大小由后缀决定，后缀对所有key都一样，只需要比较一次
+    int suffix_res = memcmp(target + key_len - hdr->suffix_len, tmpl + key_len - hdr->suffix_len, hdr->suffix_len);
+    while(left < right) {
+        int mid = left + (right - left) / 2;
+        int cmp = memcmp(target_mid, mids + mid * mid_len, mid_len);
+        if(cmp == 0) {
+            cmp = suffix_res;
+        }
+        if(upper ? cmp < 0 : cmp <= 0) {
+            right = mid;
+        } else {
+            left = mid + 1;
+        }
+    }
+    return left;
+}
+
+/**
+ * @brief 把压缩结点解码到缓存中，缓存最多容纳分裂前的2*btree_order个键值对
+ */
+void IxNodeHandle::load() const {
+    if(loaded_) {
+        return;
+    }
+    int key_len = file_hdr->col_tot_len_;
+    int n = page_hdr->num_key;
+    key_cache_.resize(2 * file_hdr->btree_order_ * key_len);
+    rid_cache_.resize(2 * file_hdr->btree_order_);
+    if(n > 0) {
+        const IxCompressHdr *hdr = packed_hdr();
+        const char *tmpl = packed_template_key();
+        int prefix = hdr->prefix_len, suffix = hdr->suffix_len;
+        int mid_len = key_len - prefix - suffix;
+        const char *mids = packed_mids();
+        for(int i = 0; i < n; i++) {
+            char *key = key_cache_.data() + i * key_len;
+            memcpy(key, tmpl, prefix);
+            memcpy(key + prefix, mids + i * mid_len, mid_len);
+            memcpy(key + key_len - suffix, tmpl + key_len - suffix, suffix);
+        }
+        memcpy(rid_cache_.data(), packed_rids(), n * sizeof(Rid));
+    }
+    cache_size_ = n;
+    loaded_ = true;
+}
+
+/**
+ * @brief 把缓存中的键值对编码写回页面
+ * 缓存中的key有序，所有key的公共前缀就是第一个和最后一个key的公共前缀；公共后缀需要逐个比较
+ * 内部结点的第0个key不参与查找，删除和插入时不维护，可能比后面的key大，需要单独比较前缀
+ * 编码后放不下时页面保持不变并置overfull_，等待调用者分裂
+ */
+void IxNodeHandle::store() {
+    int key_len = file_hdr->col_tot_len_;
+    int n = cache_size_;
+    const char *first = key_cache_.data();
+    int prefix = 0, suffix = 0;
+    if(n > 0) {
+        const char *second = n > 1 ? first + key_len : first;
+        const char *last = first + (n - 1) * key_len;
+        while(prefix < key_len && second[prefix] == last[prefix] && first[prefix] == second[prefix]) {
+            prefix++;
+        }
+        suffix = key_len - prefix;
+        for(int i = 1; i < n && suffix > 0; i++) {
+            const char *key = first + i * key_len;
+            for(int j = key_len - suffix; j < key_len; j++) {
+                if(key[j] != first[j]) {
+                    suffix = key_len - 1 - j;
+                }
+            }
+        }
+    }
+    int mid_len = key_len - prefix - suffix;
+    if(!packed_fits(file_hdr, n, mid_len)) {
+        overfull_ = true;
+        return;
+    }
+    overfull_ = false;
+    IxCompressHdr *hdr = packed_hdr();
+    hdr->prefix_len = prefix;
+    hdr->suffix_len = suffix;
+    if(n > 0) {
+        memcpy(packed_template_key(), first, key_len);
+    }
+    page_hdr->num_key = n;
+    memcpy(packed_rids(), rid_cache_.data(), n * sizeof(Rid));
+    char *mids = packed_mids();
+    for(int i = 0; i < n; i++) {
+        memcpy(mids + i * mid_len, first + i * key_len + prefix, mid_len);
+    }
 }
 
 IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
@@ -277,14 +525,26 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
     disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, buf, PAGE_SIZE);
     file_hdr_ = new IxFileHdr();
     file_hdr_->deserialize(buf);
+    ix_init_key_compare(file_hdr_);
     
     // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_pages开始分配page_no
+    // 重新打开已有的索引文件时fd2pageno可能是0，不能小于文件中已有的页面数
+    // 删除的结点在vacuum重建之前不会被重用，num_pages_会小于文件中最大的页号，所以还要看文件的实际大小
     int now_page_no = disk_manager_->get_fd2pageno(fd);
-    disk_manager_->set_fd2pageno(fd, now_page_no + 1);
+    int file_pages = disk_manager_->get_file_size(disk_manager_->get_file_name(fd)) / PAGE_SIZE;
+    disk_manager_->set_fd2pageno(fd, std::max({now_page_no + 1, file_hdr_->num_pages_, file_pages}));
+
+    if(file_hdr_->is_hash_) {
+        hash_ = std::make_unique<IxHashTable>(buffer_pool_manager_, fd_, file_hdr_);
+    }
+    if(file_hdr_->is_art_) {
+        art_ = std::make_unique<IxArt>(file_hdr_);
+    }
 }
 
 // IxIndexHandle的析构函数
 IxIndexHandle::~IxIndexHandle() {
+    unpin_inner_cache();
     delete file_hdr_;
 }
 
@@ -304,11 +564,18 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
     // 2. 从根节点开始不断向下查找目标key
     // 3. 找到包含该key值的叶子结点停止查找，并返回叶子节点
 
+    // B-link树的读者不需要root_latch_，也不需要持有父结点的锁
+    if(operation == Operation::FIND && file_hdr_->is_blink_) {
+        return find_leaf_page_blink(key, find_first);
+    }
+
     root_latch_.lock();
     bool root_is_latch = true;
 
-    // 1. 获取根节点
-    IxNodeHandle *root_node_hdl = fetch_node(file_hdr_->root_page_);
+    // 1. 获取根节点，查找时上层结点从常驻缓存中获取
+    bool cur_cached = false;
+    IxNodeHandle *root_node_hdl = operation == Operation::FIND ? fetch_read_node(file_hdr_->root_page_, &cur_cached)
+                                                               : fetch_node(file_hdr_->root_page_);
     IxNodeHandle *cur_node_hdl = root_node_hdl;
 
     if(operation == Operation::FIND){
@@ -318,7 +585,7 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
     }else{
         root_node_hdl->page->WLatch();
         // transaction->append_index_latch_page_set(root_node_hdl->page);
-        if(is_secure(cur_node_hdl,operation)){
+        if(is_secure(cur_node_hdl,operation,key)){
             if(root_is_latch){
                 root_is_latch = false;
                 root_latch_.unlock();
@@ -334,17 +601,21 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
         }else {
             child_page_no = cur_node_hdl->internal_lookup(key); // 
         }
-        auto child_node_hdl = fetch_node(child_page_no);
+        IxNodeHandle *child_node_hdl;
         // Page *child_page = child_node_hdl->page;
         // buffer_pool_manager_->unpin_page(cur_node_hdl->get_page_id(),false);
         if(operation == Operation::FIND){
+            bool child_cached;
+            child_node_hdl = fetch_read_node(child_page_no, &child_cached);
             child_node_hdl->page->RLatch();
             cur_node_hdl->page->RUnlatch();
-            buffer_pool_manager_->unpin_page(cur_node_hdl->get_page_id(),false); 
+            unpin_read_node(cur_node_hdl, cur_cached);
+            cur_cached = child_cached;
         }else{
+            child_node_hdl = fetch_node(child_page_no);
             child_node_hdl->page->WLatch();
             transaction->append_index_latch_page_set(cur_node_hdl->page);
-            if(is_secure(child_node_hdl,operation)){
+            if(is_secure(child_node_hdl,operation,key)){
                 if(root_is_latch){
                     root_is_latch = false;
                     root_latch_.unlock();
@@ -361,107 +632,456 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
 }
 
 
-// 批量插入的情况
+/**
+ * @brief 批量插入，先排序再调用bulk_load
+ */
 void IxIndexHandle::massive_insert(std::vector<char *> &keys, std::vector<Rid> &rids, Transaction *transaction) {
     assert(keys.size() == rids.size());
-    // 直接一个一个插入
+    IxBulkSorter sorter(file_hdr_);
     for(size_t i = 0; i < keys.size(); i++) {
-        insert_entry(keys[i], rids[i], transaction);
+        sorter.add(keys[i], rids[i]);
     }
+    sorter.finish();
+    bulk_load(&sorter, transaction);
+}
 
+/**
+ * @brief 把sorter中已排好序的(key, rid)加入B+树
+ * 如果树为空（根结点是空叶子），按索引的填充率从左到右填满叶子，再自底向上逐层建立内部结点；
+ * 否则按key递增的顺序逐个insert_entry，相邻的插入会落在同一片叶子上
+ *
+ * @param sorter 已经调用过finish的sorter
+ */
+void IxIndexHandle::bulk_load(IxBulkSorter *sorter, Transaction *transaction) {
+    if(sorter->size() == 0) {
+        return;
+    }
+    // 哈希索引和key的顺序无关，sorter中的key已经编码，直接逐个插入
+    if(hash_ != nullptr) {
+        char key[file_hdr_->col_tot_len_];
+        Rid rid;
+        while(sorter->next(key, &rid)) {
+            if(hash_->insert_entry(key, rid) == IX_DUPLICATE_KEY) {
+                throw InternalError("Non-unique index!");
+            }
+        }
+        return;
+    }
+    if(art_ != nullptr) {
+        char key[file_hdr_->col_tot_len_];
+        Rid rid;
+        while(sorter->next(key, &rid)) {
+            if(!art_->insert_entry(key, rid)) {
+                throw InternalError("Non-unique index!");
+            }
+        }
+        return;
+    }
 
-    // // 1. 排序
-    // // 1.1 先保存顺序
-    // std::unordered_map<char *, size_t> map;
-    // for(size_t i = 0; i < keys.size(); i++) {
-    //     map.emplace(keys[i], i);
-    // }
-    // // 1.2 排序
-    // auto file_hdr = *file_hdr_;
-    // std::sort(keys.begin(), keys.end(), [file_hdr](const char *lhs, const char *rhs) {
-    //     return ix_compare(lhs, rhs, file_hdr.col_types_, file_hdr.col_lens_);
-    // });
-    
+    root_latch_.lock();
+    if(file_hdr_->root_page_ == file_hdr_->first_leaf_) {
+        IxNodeHandle *root = fetch_node(file_hdr_->root_page_);
+        root->page->WLatch();
+        if(root->is_leaf_page() && root->get_size() == 0) {
+            // 建树期间一直持有root_latch_和第一片叶子的写锁，其它线程看不到建了一半的树
+            try {
+                build_bottom_up(sorter, root, file_hdr_->fill_factor_ / 100.0);
+            } catch(...) {
+                root->page->WUnlatch();
+                buffer_pool_manager_->unpin_page(root->get_page_id(), true);
+                delete root;
+                root_latch_.unlock();
+                throw;
+            }
+            root->page->WUnlatch();
+            buffer_pool_manager_->unpin_page(root->get_page_id(), true);
+            delete root;
+            root_latch_.unlock();
+            return;
+        }
+        root->page->WUnlatch();
+        buffer_pool_manager_->unpin_page(root->get_page_id(), false);
+        delete root;
+    }
+    root_latch_.unlock();
+
+    // 树非空，按顺序插入；sorter中的key已经编码过，insert_entry需要record格式的key
+    std::vector<char> key(file_hdr_->col_tot_len_), raw_key(file_hdr_->col_tot_len_);
+    Rid rid;
+    while(sorter->next(key.data(), &rid)) {
+        if(file_hdr_->is_normalized_) {
+            ix_decode_key(file_hdr_, key.data(), raw_key.data());
+            insert_entry(raw_key.data(), rid, transaction);
+        } else {
+            insert_entry(key.data(), rid, transaction);
+        }
+    }
+}
 
-    // // 2.递增插入
-    // for(size_t i = 0; i < keys.size(); i++) {
-    //     auto key = keys[i];
-
-    //     auto entry = find_leaf_page(key, Operation::INSERT, transaction);
-    //     // 找不到插入哪个叶子节点
-    //     IxNodeHandle *leaf = entry.first;
-    //     bool root_is_latch = entry.second;
-    //     if (!entry.first) {
-    //         unlock_unpin_all_pages(transaction);
-    //         if(root_is_latch){
-    //             root_latch_.unlock();
-    //         }
-    //         throw IndexEntryNotFoundError();
-    //     }
-    //     // 如果是最后一个叶子节点，那么递增插入可以一直插入，直到leaf分裂
-    //     if(leaf->get_page_no() == file_hdr_->last_leaf_) {
-    //         int cur_size = leaf->get_size();
-    //         while(i < keys.size() && leaf->get_size() < leaf->get_max_size()) {
-    //             key = keys[i];
-
-    //             leaf->insert(key, rids[map[key]]);
-    //             maintain_parent(leaf);
-
-    //             if(leaf->get_size() == cur_size) {
-    //                 // 2.1 如果插入后键值对数量不变，则说明，键重复，抛出异常
-    //                 unlock_unpin_all_pages(transaction);
-    //                 buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
-    //                 leaf->page->WUnlatch();
-    //                 if(root_is_latch){
-    //                     root_latch_.unlock();
-    //                 }   
-    //                 throw InternalError("Non-unique index!");
-    //             }
-
-    //             cur_size++;
-    //             i++;
-    //         }
-    //     }else {
-    //         int cur_size = leaf->get_size();
-
-    //         leaf->insert(key, rids[map[key]]);
-    //         maintain_parent(leaf);
-
-    //         if(leaf->get_size() == cur_size) {
-    //             // 2.1 如果插入后键值对数量不变，则说明，键重复，抛出异常
-    //             unlock_unpin_all_pages(transaction);
-    //             buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
-    //             leaf->page->WUnlatch();
-    //             if(root_is_latch){
-    //                 root_latch_.unlock();
-    //             }   
-    //             throw InternalError("Non-unique index!");
-    //         }
-    //     }
+/**
+ * @brief 计算一层中每个结点放多少项：尽量每个结点放fill项，
+ * 最后一个结点不足min_size时并入前一个结点，放不下就和前一个结点平分
+ */
+static std::vector<int> plan_node_sizes(size_t n, int fill, int min_size, int max_size) {
+    std::vector<int> sizes(n / fill, fill);
+    int rest = n % fill;
+    if(rest == 0) {
+        return sizes;
+    }
+    if(sizes.empty() || rest >= min_size) {
+        sizes.push_back(rest);
+    } else if(fill + rest <= max_size) {
+        sizes.back() += rest;
+    } else {
+        int total = fill + rest;
+        sizes.back() = total - total / 2;
+        sizes.push_back(total / 2);
+    }
+    return sizes;
+}
 
-    //     // 判断是否会分裂
-    //     if(leaf->get_size() == leaf->get_max_size()){
-    //         // 2.2 如果结点已满，分裂结点，并把新结点的相关信息插入父节点
-    //         IxNodeHandle *new_node = split(leaf);
-    //         // 如果该叶子是最后一片叶子
-    //         if(leaf->get_page_no() == file_hdr_->last_leaf_) {
-    //             file_hdr_->last_leaf_ = new_node->get_page_no();
-    //         }
-    //         insert_into_parent(leaf, new_node->get_key(0), new_node, transaction);
-            
-    //         buffer_pool_manager_->unpin_page(new_node->get_page_id(),true);
+/**
+ * @brief 压缩索引批量建树时按编码后的字节数往结点中放key
+ * 结点中的key有序，所有key的公共前缀就是第一个key和最后一个key的公共前缀
+ */
+class IxPackedFill {
+   public:
+    IxPackedFill(const IxFileHdr *file_hdr, double fill_factor) : file_hdr_(file_hdr), first_(file_hdr->col_tot_len_) {
+        key_len_ = file_hdr->col_tot_len_;
+        max_bytes_ = static_cast<int>((PAGE_SIZE - IxNodeHandle::packed_rids_offset(file_hdr)) * fill_factor);
+        max_keys_ = std::max(1, static_cast<int>((2 * file_hdr->btree_order_ - 2) * fill_factor));
+        reset();
+    }
 
-    //         // split返回的节点也需要delete
-    //         delete new_node;
-    //     }
-    //     leaf->page->WUnlatch();
-    //     // 提示：记得unpin page；若当前叶子节点是最右叶子节点，则需要更新file_hdr_.last_leaf；记得处理并发的上锁
-    //     buffer_pool_manager_->unpin_page(leaf->get_page_id(), true);
+    void reset() { num_ = prefix_ = suffix_ = 0; }
 
-    //     // delete leaf
-    //     delete leaf;
-    // }
+    // 结点中再放入key之后是否仍不超过填充率，放得下时记录下来
+    bool add(const char *key) {
+        if(num_ == 0) {
+            memcpy(first_.data(), key, key_len_);
+            num_ = 1;
+            prefix_ = key_len_;
+            suffix_ = 0;
+            return true;
+        }
+        int prefix = 0;
+        while(prefix < prefix_ && key[prefix] == first_[prefix]) {
+            prefix++;
+        }
+        int suffix = num_ == 1 ? key_len_ - prefix : std::min(suffix_, key_len_ - prefix);
+        for(int j = key_len_ - suffix; j < key_len_; j++) {
+            if(key[j] != first_[j]) {
+                suffix = key_len_ - 1 - j;
+            }
+        }
+        int mid_len = key_len_ - prefix - suffix;
+        if(num_ + 1 > max_keys_ || (num_ + 1) * static_cast<int>(sizeof(Rid) + mid_len) > max_bytes_) {
+            return false;
+        }
+        num_++;
+        prefix_ = prefix;
+        suffix_ = suffix;
+        return true;
+    }
+
+   private:
+    const IxFileHdr *file_hdr_;
+    int key_len_;
+    int max_bytes_;
+    int max_keys_;
+    std::vector<char> first_;
+    int num_, prefix_, suffix_;
+};
+
+/**
+ * @brief 自底向上建树，调用者持有root_latch_和first_leaf的写锁
+ *
+ * @param first_leaf 当前为空的根结点，复用为第一片叶子
+ * @note 叶子层和内部层的结点都记录(第一个key, page_no)，作为上一层的键值对；
+ * 压缩索引按编码后的字节数贪心地填充结点，叶子层的分隔key截断成最短前缀
+ */
+void IxIndexHandle::build_bottom_up(IxBulkSorter *sorter, IxNodeHandle *first_leaf, double fill_factor) {
+    int key_len = file_hdr_->col_tot_len_;
+    bool compressed = file_hdr_->is_compressed_;
+    int max_keys = file_hdr_->btree_order_;
+    int min_keys = first_leaf->get_min_size();
+    int fill = std::max(min_keys, std::min(max_keys, static_cast<int>(max_keys * fill_factor)));
+    fill = std::max(fill, 1);
+    IxPackedFill packed_fill(file_hdr_, fill_factor);
+    // 建树期间其它线程不会分配页面，新结点从first_new_page开始连续分配，有重复的key时截断回去
+    page_id_t first_new_page = disk_manager_->get_fd2pageno(fd_);
+    int old_num_pages = file_hdr_->num_pages_;
+
+    // 1. 从左到右填满叶子
+    std::vector<char> level_keys;
+    std::vector<page_id_t> level_pages;
+    std::vector<char> prev_key(key_len), key(key_len), separator(key_len);
+    bool has_prev_key = false;
+    IxNodeHandle *prev = nullptr;
+    auto release_prev = [&]() {
+        if(prev != nullptr && prev != first_leaf) {
+            buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+            delete prev;
+        }
+        prev = nullptr;
+    };
+
+    std::vector<int> sizes;
+    if(!compressed) {
+        sizes = plan_node_sizes(sorter->size(), fill, min_keys, max_keys);
+    }
+    Rid rid;
+    bool has_key = sorter->next(key.data(), &rid);
+    for(size_t i = 0; has_key; i++) {
+        IxNodeHandle *node = i == 0 ? first_leaf : create_node();
+        node->page_hdr->num_key = 0;
+        node->page_hdr->is_leaf = true;
+        node->page_hdr->parent = INVALID_PAGE_ID;
+        node->page_hdr->next_free_page_no = IX_NO_PAGE;
+        node->page_hdr->next_leaf = IX_LEAF_HEADER_PAGE;
+        node->page_hdr->prev_leaf = prev == nullptr ? IX_LEAF_HEADER_PAGE : prev->get_page_no();
+
+        // 新叶子的分隔key，压缩索引截断成比前一片叶子最后一个key大的最短前缀
+        const char *first_key = key.data();
+        if(compressed && has_prev_key) {
+            first_key = shortest_separator(prev_key.data(), key.data(), separator.data());
+        }
+        level_keys.insert(level_keys.end(), first_key, first_key + key_len);
+
+        int n = 0;
+        packed_fill.reset();
+        while(has_key && (compressed ? packed_fill.add(key.data()) : n < sizes[i])) {
+            if(has_prev_key && compare_key(prev_key.data(), key.data()) == 0) {
+                // 有重复的key，删除新建的叶子，恢复成空树；内部结点还没有建立，叶子头结点也还没有修改
+                if(node != first_leaf) {
+                    buffer_pool_manager_->unpin_page(node->get_page_id(), true);
+                    delete node;
+                }
+                release_prev();
+                for(page_id_t page_no = first_new_page; page_no < disk_manager_->get_fd2pageno(fd_); page_no++) {
+                    buffer_pool_manager_->delete_page(PageId{fd_, page_no});
+                }
+                disk_manager_->truncate_file(fd_, first_new_page);
+                file_hdr_->num_pages_ = old_num_pages;
+                first_leaf->set_size(0);
+                first_leaf->page_hdr->next_leaf = IX_LEAF_HEADER_PAGE;
+                throw InternalError("Non-unique index!");
+            }
+            // 压缩结点的key和rid先写到缓存中，最后由set_size一次写回页面
+            memcpy(node->get_key(n), key.data(), key_len);
+            *node->get_rid(n) = rid;
+            n++;
+            prev_key.swap(key);
+            has_prev_key = true;
+            has_key = sorter->next(key.data(), &rid);
+        }
+        node->set_size(n);
 
+        if(prev != nullptr) {
+            prev->page_hdr->next_leaf = node->get_page_no();
+            if(file_hdr_->is_blink_) {
+                prev->set_high_key(level_keys.data() + i * key_len);
+            }
+        }
+        release_prev();
+        prev = node;
+        level_pages.push_back(node->get_page_no());
+    }
+    page_id_t last_leaf = prev->get_page_no();
+    release_prev();
+
+    // 叶子头结点的prev指向最后一片叶子
+    IxNodeHandle *leaf_header = fetch_node(IX_LEAF_HEADER_PAGE);
+    leaf_header->page_hdr->prev_leaf = last_leaf;
+    leaf_header->page_hdr->next_leaf = first_leaf->get_page_no();
+    buffer_pool_manager_->unpin_page(leaf_header->get_page_id(), true);
+    delete leaf_header;
+
+    // 2. 自底向上建立内部结点，直到只剩一个结点作为根
+    while(level_pages.size() > 1) {
+        std::vector<char> upper_keys;
+        std::vector<page_id_t> upper_pages;
+        if(!compressed) {
+            sizes = plan_node_sizes(level_pages.size(), fill, min_keys, max_keys);
+        }
+        size_t child = 0;
+        for(size_t i = 0; child < level_pages.size(); i++) {
+            IxNodeHandle *node = create_node();
+            node->page_hdr->num_key = 0;
+            node->page_hdr->is_leaf = false;
+            node->page_hdr->parent = INVALID_PAGE_ID;
+            node->page_hdr->next_free_page_no = IX_NO_PAGE;
+            node->page_hdr->prev_leaf = IX_NO_PAGE;
+            node->page_hdr->next_leaf = IX_NO_PAGE;
+            int n = 0;
+            packed_fill.reset();
+            while(child < level_pages.size() &&
+                  (compressed ? packed_fill.add(level_keys.data() + child * key_len) : n < sizes[i])) {
+                memcpy(node->get_key(n), level_keys.data() + child * key_len, key_len);
+                *node->get_rid(n) = Rid{level_pages[child], -1};
+                n++;
+                child++;
+            }
+            node->set_size(n);
+            for(int j = 0; j < n; j++) {
+                maintain_child(node, j);
+            }
+
+            if(prev != nullptr && file_hdr_->is_blink_) {
+                prev->page_hdr->next_leaf = node->get_page_no();
+                prev->set_high_key(node->get_key(0));
+            }
+            release_prev();
+            prev = node;
+            upper_keys.insert(upper_keys.end(), node->get_key(0), node->get_key(0) + key_len);
+            upper_pages.push_back(node->get_page_no());
+        }
+        release_prev();
+        level_keys.swap(upper_keys);
+        level_pages.swap(upper_pages);
+    }
+
+    file_hdr_->last_leaf_ = last_leaf;
+    update_root_page_no(level_pages[0]);
+}
+
+/**
+ * @brief 判断删除后的B+树是否需要重建：不合并的删除会留下大量不满甚至为空的结点，
+ * 叶子平均填充率或者文件中仍在使用的页面比例低于min_fill时需要重建。
+ * 重建由上层把新树建在临时文件中再替换旧文件，见SmManager::compact_index()
+ * 调用者需要持有表锁，保证期间索引结构不变
+ */
+bool IxIndexHandle::needs_compact(double min_fill) {
+    if(hash_ != nullptr || art_ != nullptr || is_empty()) {
+        return false;
+    }
+    // 统计叶子的平均填充率
+    size_t num_leaves = 0;
+    size_t num_entries = 0;
+    for(page_id_t page_no = file_hdr_->first_leaf_; page_no != IX_LEAF_HEADER_PAGE;) {
+        IxNodeHandle *leaf = fetch_node(page_no);
+        num_leaves++;
+        num_entries += leaf->get_size();
+        page_no = leaf->get_next_leaf();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+        delete leaf;
+    }
+    // 合并删除的结点不会被重用，文件中仍在使用的页面比例低于min_fill时也重建，回收这些页面
+    bool underfull = num_leaves > 1 && num_entries < min_fill * num_leaves * file_hdr_->btree_order_;
+    bool sparse = file_hdr_->num_pages_ < min_fill * disk_manager_->get_fd2pageno(fd_);
+    return underfull || sparse;
+}
+
+/**
+ * @brief 统计索引的树高、结点个数、填充率和各前缀的不同取值个数
+ * 先深度优先遍历内部结点得到按key有序的叶子列表，叶子不超过max_sample_leaves时全部读取，统计值是精确的；
+ * 否则等间隔抽样读取max_sample_leaves片叶子，按样本中的平均值估计键值对个数，
+ * 按样本中相邻key前缀变化的比例估计不同取值个数。调用者需要持有表锁，保证期间索引结构不变
+ */
+IxIndexStats IxIndexHandle::get_stats(int max_sample_leaves) {
+    IxIndexStats stats;
+    if(hash_ != nullptr) {
+        hash_->get_stats(&stats);
+        return stats;
+    }
+    if(art_ != nullptr) {
+        art_->get_stats(&stats);
+        return stats;
+    }
+    int col_num = file_hdr_->col_num_;
+    stats.distinct.assign(col_num, 0);
+    if(is_empty()) {
+        return stats;
+    }
+
+    // 1. 遍历内部结点，孩子逆序入栈，叶子按key从小到大的顺序加入leaves
+    std::vector<page_id_t> leaves;
+    std::vector<std::pair<page_id_t, int>> stack{{file_hdr_->root_page_, 1}};
+    while(!stack.empty()) {
+        auto [page_no, depth] = stack.back();
+        stack.pop_back();
+        IxNodeHandle *node = fetch_node(page_no);
+        node->page->RLatch();
+        if(node->is_leaf_page()) {
+            leaves.push_back(page_no);
+            stats.height = std::max(stats.height, depth);
+        } else {
+            stats.num_inner++;
+            for(int i = node->get_size() - 1; i >= 0; i--) {
+                stack.push_back({node->value_at(i), depth + 1});
+            }
+        }
+        node->page->RUnlatch();
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+    }
+    stats.num_leaves = leaves.size();
+
+    // 2. 读取叶子，统计相邻key之间前i+1个字段发生变化的次数
+    std::vector<int> offsets(col_num, 0);
+    for(int c = 1; c < col_num; c++) {
+        offsets[c] = offsets[c - 1] + file_hdr_->col_lens_[c - 1];
+    }
+    auto col_equal = [&](const char *a, const char *b, int i) {
+        int offset = offsets[i];
+        int len = file_hdr_->col_lens_[i];
+        if(file_hdr_->is_normalized_) {
+            return memcmp(a + offset, b + offset, len) == 0;
+        }
+        return ix_compare(a + offset, b + offset, file_hdr_->col_types_[i], len) == 0;
+    };
+    int sample = std::min<int>(leaves.size(), std::max(1, max_sample_leaves));
+    std::vector<int64_t> changes(col_num, 0);
+    int64_t sampled_keys = 0;
+    int64_t pairs = 0;                      // 比较过的相邻key对数
+    std::vector<char> prev_key(file_hdr_->col_tot_len_);
+    size_t prev_idx = SIZE_MAX;             // prev_key所在叶子在leaves中的下标
+    for(int s = 0; s < sample; s++) {
+        size_t idx = (size_t)s * leaves.size() / sample;
+        IxNodeHandle *leaf = fetch_node(leaves[idx]);
+        leaf->page->RLatch();
+        int size = leaf->get_size();
+        for(int i = 0; i < size; i++) {
+            const char *key = leaf->get_key(i);
+            // 抽样时不相邻的两片叶子之间不比较
+            if(i > 0 || (prev_idx != SIZE_MAX && prev_idx + 1 == idx)) {
+                const char *prev = i > 0 ? leaf->get_key(i - 1) : prev_key.data();
+                pairs++;
+                int c = 0;
+                while(c < col_num && col_equal(key, prev, c)) {
+                    c++;
+                }
+                for(; c < col_num; c++) {
+                    changes[c]++;
+                }
+            }
+        }
+        if(size > 0) {
+            memcpy(prev_key.data(), leaf->get_key(size - 1), file_hdr_->col_tot_len_);
+            prev_idx = idx;
+        }
+        sampled_keys += size;
+        leaf->page->RUnlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+        delete leaf;
+    }
+    stats.sampled_leaves = sample;
+    stats.avg_fill = (double)sampled_keys / sample / file_hdr_->btree_order_;
+
+    // 3. 全部读取时不同取值个数等于变化次数加1；抽样时按变化比例外推到全部键值对
+    if(sample == stats.num_leaves) {
+        stats.num_keys = sampled_keys;
+        for(int c = 0; c < col_num; c++) {
+            stats.distinct[c] = sampled_keys > 0 ? changes[c] + 1 : 0;
+        }
+    } else {
+        stats.num_keys = (int64_t)((double)sampled_keys / sample * stats.num_leaves);
+        for(int c = 0; c < col_num; c++) {
+            double ratio = pairs > 0 ? (double)changes[c] / pairs : 0;
+            stats.distinct[c] = std::max<int64_t>(changes[c] + 1, (int64_t)(ratio * (stats.num_keys - 1)) + 1);
+        }
+    }
+    return stats;
 }
 
 /**
@@ -473,6 +1093,14 @@ void IxIndexHandle::massive_insert(std::vector<char *> &keys, std::vector<Rid> &
  * @return bool 返回目标键值对是否存在
  */
 bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transaction *transaction) {
+    char norm_key[file_hdr_->col_tot_len_];
+    key = normalize_key(key, norm_key);
+    if(hash_ != nullptr) {
+        return hash_->get_value(key, result);
+    }
+    if(art_ != nullptr) {
+        return art_->get_value(key, result);
+    }
     // Todo:
     // 1. 获取目标key值所在的叶子结点
     // 2. 在叶子节点中查找目标key值的位置，并读取key对应的rid
@@ -495,14 +1123,13 @@ bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transac
 
         return false;
     }
-    // 提示：使用完buffer_pool提供的page之后，记得unpin page；记得处理并发的上锁
-    leaf_node_hdl->page->RUnlatch();
-    buffer_pool_manager_->unpin_page(leaf_node_hdl->get_page_id(),false);
-
-    // 3. 把rid存入result参数中
+    // 3. 把rid存入result参数中，value指向页面中的数据，必须在释放叶子的读锁之前复制，否则并发的插入可能已经移动了它
     if(result != nullptr) {
         result->push_back(*value);
     }
+    // 提示：使用完buffer_pool提供的page之后，记得unpin page；记得处理并发的上锁
+    leaf_node_hdl->page->RUnlatch();
+    buffer_pool_manager_->unpin_page(leaf_node_hdl->get_page_id(),false);
 
     // find_leaf_page产生的handle也需要delete
     delete leaf_node_hdl;
@@ -511,14 +1138,110 @@ bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transac
     
 }
 
+/**
+ * @brief 批量查找多个key
+ * key排序之后从左向右处理：下一个key不超过当前叶子的最大key时直接在当前叶子中查找；
+ * 在下一片叶子的范围内时沿叶子链表右移；否则释放叶子重新从根下降，上层结点常驻缓冲池，下降只访问一次缓冲池
+ *
+ * @param keys record格式的key
+ * @param result 第i项为keys[i]对应的rid
+ * @param found 第i项表示keys[i]是否存在
+ * @return int 找到的key数量
+ */
+int IxIndexHandle::get_values(const std::vector<const char *> &keys, std::vector<Rid> *result,
+                              std::vector<bool> *found, Transaction *transaction) {
+    size_t n = keys.size();
+    int len = file_hdr_->col_tot_len_;
+    result->assign(n, Rid{-1, -1});
+    found->assign(n, false);
+    std::vector<char> norm_keys(file_hdr_->is_normalized_ ? n * len : 0);
+    std::vector<const char *> probe(n);
+    for(size_t i = 0; i < n; i++) {
+        probe[i] = normalize_key(keys[i], norm_keys.data() + i * len);
+    }
+
+    int num_found = 0;
+    if(hash_ != nullptr || art_ != nullptr) {
+        // 哈希索引和ART索引的查找和key的顺序无关，逐个查找
+        std::vector<Rid> rids;
+        for(size_t i = 0; i < n; i++) {
+            rids.clear();
+            if(hash_ != nullptr ? hash_->get_value(probe[i], &rids) : art_->get_value(probe[i], &rids)) {
+                (*result)[i] = rids[0];
+                (*found)[i] = true;
+                num_found++;
+            }
+        }
+        return num_found;
+    }
+
+    // 1. 按key排序，只排下标
+    std::vector<size_t> order(n);
+    for(size_t i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [&](size_t a, size_t b) { return compare_key(probe[a], probe[b]) < 0; });
+
+    // 2. 从左向右依次查找，叶子之间按从左到右的顺序加锁
+    auto release_leaf = [&](IxNodeHandle *leaf) {
+        leaf->page->RUnlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+        delete leaf;
+    };
+    // key大于叶子中的所有key（空叶子也算）
+    auto after_leaf = [&](IxNodeHandle *leaf, const char *key) {
+        return leaf->get_size() == 0 || compare_key(key, leaf->get_key(leaf->get_size() - 1)) > 0;
+    };
+    IxNodeHandle *leaf = nullptr;
+    for(size_t idx : order) {
+        const char *key = probe[idx];
+        bool past_end = false;
+        while(leaf != nullptr && after_leaf(leaf, key)) {
+            page_id_t next_page_no = leaf->get_next_leaf();
+            if(next_page_no == IX_LEAF_HEADER_PAGE) {
+                // 已经是最后一片叶子，剩下的key都不存在
+                past_end = true;
+                break;
+            }
+            IxNodeHandle *next_leaf = fetch_node(next_page_no);
+            next_leaf->page->RLatch();
+            release_leaf(leaf);
+            leaf = next_leaf;
+            if(after_leaf(leaf, key)) {
+                // key离得较远，重新从根下降比逐个扫描叶子快
+                release_leaf(leaf);
+                leaf = nullptr;
+            }
+        }
+        if(past_end) {
+            break;
+        }
+        if(leaf == nullptr) {
+            leaf = find_leaf_page(key, Operation::FIND, transaction).first;
+        }
+        Rid *value;
+        if(leaf->leaf_lookup(key, &value)) {
+            (*result)[idx] = *value;
+            (*found)[idx] = true;
+            num_found++;
+        }
+    }
+    if(leaf != nullptr) {
+        release_leaf(leaf);
+    }
+    return num_found;
+}
+
 /**
  * @brief  将传入的一个node拆分(Split)成两个结点，在node的右边生成一个新结点new node
  * @param node 需要拆分的结点
+ * @param append 插入发生在最右结点的末尾（顺序插入）时为true，此时左边按填充率保留键值对，否则从中间分裂
  * @return 拆分得到的new_node
  * @note need to unpin the new node outside
  * 注意：本函数执行完毕后，原node和new node都需要在函数外面进行unpin
  */
-IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
+IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node, bool append) {
     // 1. 将原结点的键值对平均分配，右半部分分裂为新的右兄弟结点
     IxNodeHandle *new_node = create_node();
     //    需要初始化新节点的page_hdr内容
@@ -545,16 +1268,64 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
 
     // 3. 如果新的右兄弟结点不是叶子结点，更新该结点的所有孩子结点的父节点信息(使用IxIndexHandle::maintain_child())
     // 将原节点的一部分键值对移动到新节点中，平均分配
-    int pos = node->page_hdr->num_key / 2;
+    int pos = node->get_size() / 2;
+    if(append) {
+        // 顺序插入时左边的结点不会再插入新key，按填充率保留；需要合并的树右边至少保留min_size个，
+        // 压缩结点按编码后的字节数计算左边能放下多少个key
+        int right_min = no_rebalance() ? 1 : node->get_min_size();
+        int fill_pos = std::min(node->get_size() * file_hdr_->fill_factor_ / 100, node->get_size() - right_min);
+        if(file_hdr_->is_compressed_) {
+            IxPackedFill packed_fill(file_hdr_, file_hdr_->fill_factor_ / 100.0);
+            int fit = 0;
+            while(fit < fill_pos && packed_fill.add(node->get_key(fit))) {
+                fit++;
+            }
+            fill_pos = fit;
+        }
+        pos = std::max(pos, fill_pos);
+    }
     int num = node->get_size() - pos;
     new_node->insert_pairs(0, node->get_key(pos), node->get_rid(pos), num);
-    node->page_hdr->num_key = pos;
+    node->set_size(pos);
     for(int i = 0; i < num; i ++) {
         maintain_child(new_node, i);
     }
+
+    // 4. B-link树：new_node继承node的high key和右链接，node的high key变为new_node的第一个key
+    // node此时持有写锁，读者要么看到分裂前的node，要么能通过右链接找到new_node
+    if(file_hdr_->is_blink_) {
+        if(node->get_right_link() != IX_NO_PAGE) {
+            new_node->set_high_key(node->get_high_key());
+        }
+        if(!new_node->is_leaf_page()) {
+            new_node->page_hdr->next_leaf = node->page_hdr->next_leaf;
+            node->page_hdr->next_leaf = new_node->get_page_no();
+        }
+        node->set_high_key(new_node->get_key(0));
+    }
     return new_node;
 }
 
+/**
+ * @brief 计算叶子分裂后插入父结点的分隔key：取right_first最短的、大于left_last的前缀，剩余部分补0
+ * 满足left_last < separator <= right_first，补0后内部结点中key的公共后缀更长，压缩后更短
+ *
+ * @param buf 长度为col_tot_len的缓冲区
+ * @return 分隔key，即buf
+ */
+const char *IxIndexHandle::shortest_separator(const char *left_last, const char *right_first, char *buf) const {
+    int key_len = file_hdr_->col_tot_len_;
+    int len = 0;
+    while(len < key_len && left_last[len] == right_first[len]) {
+        len++;
+    }
+    // 第一个不同的字节也要保留
+    len = std::min(len + 1, key_len);
+    memcpy(buf, right_first, len);
+    memset(buf + len, 0, key_len - len);
+    return buf;
+}
+
 /**
  * @brief Insert key & value pair into internal page after split
  * 拆分(Split)后，向上找到old_node的父结点
@@ -569,7 +1340,7 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
  * @note 本函数执行完毕后，new node和old node都需要在函数外面进行unpin
  */
 void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node,
-                                     Transaction *transaction) {
+                                     Transaction *transaction, bool *root_is_latched, bool append) {
 
    // 1. 分裂前的结点（原结点, old_node）是否为根结点，如果为根结点需要分配新的root
 
@@ -588,7 +1359,7 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
         new_root->insert_pair(1, key, {new_node->get_page_no(), -1});
 
         int new_root_page = new_root->get_page_no();
-        file_hdr_->root_page_ = new_root_page;
+        update_root_page_no(new_root_page);
         new_node->page_hdr->parent = new_root_page;
         old_node->page_hdr->parent = new_root_page;
         // 对新创建的根page已经利用完了，可以unpin了
@@ -597,8 +1368,10 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
         delete new_root;
 
         // 这个时候一定可以释放根锁了，因为不会再向上走了
-        
-        root_latch_.unlock();
+        if(*root_is_latched) {
+            *root_is_latched = false;
+            root_latch_.unlock();
+        }
         unlock_unpin_all_pages(transaction);
 
         return ;
@@ -612,10 +1385,13 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
         parent_node->insert_pair(rid_idx + 1, key, {new_node->get_page_id().page_no, -1});
 
         // 4. 如果父亲结点仍需要继续分裂，则进行递归插入
+        // 顺序插入时new_node是最右的孩子，父结点也是这一层最右的结点
         if(parent_node->get_size() == parent_node->get_max_size()) {
-            IxNodeHandle *new_parent = split(parent_node);
+            bool parent_append = append && rid_idx + 1 == parent_node->get_size() - 1;
+            IxNodeHandle *new_parent = split(parent_node, parent_append);
             
-            insert_into_parent(parent_node, new_parent->get_key(0), new_parent, transaction);
+            insert_into_parent(parent_node, new_parent->get_key(0), new_parent, transaction, root_is_latched,
+                               parent_append);
             // 提示：记得unpin page
             buffer_pool_manager_->unpin_page(new_parent->get_page_id(), true);
             buffer_pool_manager_->unpin_page(parent_node->get_page_id(), true);
@@ -626,7 +1402,11 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
             return ;
         }
 
-        // 探讨：这里是否可以释放根锁root_latch
+        // 压缩结点的is_secure是保守的，父结点不再分裂时根锁可能还没有释放
+        if(*root_is_latched) {
+            *root_is_latched = false;
+            root_latch_.unlock();
+        }
         unlock_unpin_all_pages(transaction);
         buffer_pool_manager_->unpin_page(parent_node->get_page_id(), true);
 
@@ -637,12 +1417,48 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
 }
 
 /**
- * @brief 将指定键值对插入到B+树中
+ * @brief 将指定键值对插入到B+树中，key已经存在时抛出异常
  * @param (key, value) 要插入的键值对
  * @param transaction 事务指针
  * @return page_id_t 插入到的叶结点的page_no
  */
 page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transaction *transaction) {
+    char norm_key[file_hdr_->col_tot_len_];
+    page_id_t page_no = insert_normalized(normalize_key(key, norm_key), value, transaction);
+    if(page_no == IX_DUPLICATE_KEY) {
+        throw InternalError("Non-unique index!");
+    }
+    return page_no;
+}
+
+/**
+ * @brief 唯一性检查和插入合在一次下降中完成：插入时在叶子中发现相同的key就放弃插入并返回false，
+ * 调用者不需要先用get_value查找一遍
+ * @return 是否插入成功
+ */
+bool IxIndexHandle::insert_entry_if_absent(const char *key, const Rid &value, Transaction *transaction) {
+    char norm_key[file_hdr_->col_tot_len_];
+    return insert_normalized(normalize_key(key, norm_key), value, transaction) != IX_DUPLICATE_KEY;
+}
+
+/**
+ * @brief 插入已经编码的key，key已经存在时返回IX_DUPLICATE_KEY
+ */
+page_id_t IxIndexHandle::insert_normalized(const char *key, const Rid &value, Transaction *transaction) {
+    if(hash_ != nullptr) {
+        return hash_->insert_entry(key, value);
+    }
+    if(art_ != nullptr) {
+        // ART索引没有页面，返回值没有意义
+        return art_->insert_entry(key, value) ? IX_NO_PAGE : IX_DUPLICATE_KEY;
+    }
+    // 0. 先尝试只修改叶子结点，失败时再按悲观方式从根结点加写锁下降
+    if(optimistic_latch) {
+        page_id_t page_no = insert_entry_optimistic(key, value);
+        if(page_no != IX_NO_PAGE) {
+            return page_no;
+        }
+    }
     auto entry = find_leaf_page(key, Operation::INSERT, transaction);
     // 1. 找不到插入哪个叶子节点
     IxNodeHandle *leaf = entry.first;
@@ -656,32 +1472,54 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
     }
     // 2. 在该叶子节点中插入键值对
     int cur_size = leaf->get_size();
+    int pos = leaf->lower_bound(key);
     leaf->insert(key, value);
-    // 维护父节点
-    maintain_parent(leaf);
+    // 插入到第一个位置时维护父节点，B-link树和压缩索引的分隔key只需要不大于孩子中的key，不需要维护
+    if(!no_rebalance() && pos == 0) {
+        maintain_parent(leaf);
+    }
 
     if(leaf->get_size() == cur_size) {
-        // 2.1 如果插入后键值对数量不变，则说明，键重复，抛出异常
+        // 2.1 如果插入后键值对数量不变，则说明，键重复
         unlock_unpin_all_pages(transaction);
         buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
         leaf->page->WUnlatch();
         if(root_is_latch){
             root_latch_.unlock();
         }
-        throw InternalError("Non-unique index!");
+        delete leaf;
+        return IX_DUPLICATE_KEY;
     } else if(leaf->get_size() == leaf->get_max_size()){
         // 2.2 如果结点已满，分裂结点，并把新结点的相关信息插入父节点
-        IxNodeHandle *new_node = split(leaf);
+        // 新key插入到最后一片叶子的末尾时认为是顺序插入，按填充率分裂
+        bool append = leaf->get_next_leaf() == IX_LEAF_HEADER_PAGE &&
+                      compare_key(key, leaf->get_key(leaf->get_size() - 1)) == 0;
+        IxNodeHandle *new_node = split(leaf, append);
         // 如果该叶子是最后一片叶子
         if(leaf->get_page_no() == file_hdr_->last_leaf_) {
             file_hdr_->last_leaf_ = new_node->get_page_no();
         }
-        insert_into_parent(leaf, new_node->get_key(0), new_node, transaction);
+        // 压缩索引的分隔key截断成最短的前缀，B-link树的high key也要随之修改
+        const char *separator = new_node->get_key(0);
+        char sep_buf[file_hdr_->col_tot_len_];
+        if(file_hdr_->is_compressed_) {
+            separator = shortest_separator(leaf->get_key(leaf->get_size() - 1), separator, sep_buf);
+            if(file_hdr_->is_blink_) {
+                leaf->set_high_key(separator);
+            }
+        }
+        insert_into_parent(leaf, separator, new_node, transaction, &root_is_latch, append);
         
         buffer_pool_manager_->unpin_page(new_node->get_page_id(),true);
 
         // split返回的节点也需要delete
         delete new_node;
+    } else {
+        // 叶子结点没有分裂，释放下降时保守地持有的祖先结点和根锁
+        unlock_unpin_all_pages(transaction);
+        if(root_is_latch) {
+            root_latch_.unlock();
+        }
     }
     leaf->page->WUnlatch();
     // 提示：记得unpin page；若当前叶子节点是最右叶子节点，则需要更新file_hdr_.last_leaf；记得处理并发的上锁
@@ -759,6 +1597,14 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
  * @param transaction 事务指针
  */
 bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
+    char norm_key[file_hdr_->col_tot_len_];
+    key = normalize_key(key, norm_key);
+    if(hash_ != nullptr) {
+        return hash_->delete_entry(key);
+    }
+    if(art_ != nullptr) {
+        return art_->delete_entry(key);
+    }
     // Todo:
     // 1. 获取该键值对所在的叶子结点
     // 2. 在该叶子结点中删除键值对
@@ -766,6 +1612,12 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
     // 4. 如果需要并发，并且需要删除叶子结点，则需要在事务的delete_page_set中添加删除结点的对应页面；记得处理并发的上锁
 
     // std::scoped_lock lock{root_latch_};
+
+    // 0. 先尝试只修改叶子结点，失败时再按悲观方式从根结点加写锁下降，B-link树总是只修改叶子结点
+    bool deleted;
+    if((optimistic_latch || no_rebalance()) && delete_entry_optimistic(key, &deleted)) {
+        return deleted;
+    }
     
     // 1. 获取该键值对所在的叶子结点
     auto target = find_leaf_page(key,Operation::DELETE,transaction);
@@ -773,15 +1625,24 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
     bool *root_is_latch = new bool(target.second);
 
     // 2. 在该叶子结点中删除键值对
+    int pos = target_node_hdl->lower_bound(key);
     if(target_node_hdl->get_size() == target_node_hdl->remove(key)){
         // 2.1 删除失败，直接Unpin以后return
         unlock_unpin_all_pages(transaction);
+        if(*root_is_latch) {
+            root_latch_.unlock();
+        }
         target_node_hdl->page->WUnlatch();
         buffer_pool_manager_->unpin_page(target_node_hdl->get_page_id(),false);
 
         delete target_node_hdl;
+        delete root_is_latch;
         return false;
     }else{
+        // 删除的是第一个key时维护父节点，此时is_secure保留了父结点的写锁
+        if(!no_rebalance() && pos == 0 && target_node_hdl->get_size() > 0) {
+            maintain_parent(target_node_hdl);
+        }
         // 3. 如果删除成功需要调用CoalesceOrRedistribute来进行合并或重分配操作，并根据函数返回结果判断是否有结点需要删除
         bool need_delete = coalesce_or_redistribute(target_node_hdl,transaction, root_is_latch);
         target_node_hdl->page->WUnlatch();
@@ -847,10 +1708,12 @@ bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *tr
     }else{
         if(node->get_size() >= node->get_min_size()){
     //    1.2 如果不是根节点，并且不需要执行合并或重分配操作，则直接返回false，否则执行2
-            // unlock_all_pages(transaction);
-            // TODO 应该是需要unpin的吧
-            maintain_parent(node);
+            // 第一个key的变化已经在delete_entry中维护，coalesce只删除父结点第一个之后的key
             unlock_unpin_all_pages(transaction);
+            if(*root_is_latched) {
+                *root_is_latched = false;
+                root_latch_.unlock();
+            }
             return false;
         }
     // 2. 获取node结点的父亲结点
@@ -920,7 +1783,7 @@ bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
     if(!old_root_node->is_leaf_page() && old_root_node->get_size() == 1){
         auto new_root_node_hdl = fetch_node(old_root_node->value_at(0));
         new_root_node_hdl->set_parent_page_no(INVALID_PAGE_ID);
-        file_hdr_->root_page_ = new_root_node_hdl->get_page_no();
+        update_root_page_no(new_root_node_hdl->get_page_no());
         buffer_pool_manager_->unpin_page(new_root_node_hdl->get_page_id(),true);
         release_node_handle(*old_root_node);
 
@@ -929,13 +1792,9 @@ bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
 
         return true;
     }
-    // 2. 如果old_root_node是叶结点，且大小为0，则直接更新root page
-    if(old_root_node->is_leaf_page() && old_root_node->get_size() == 0){
-        release_node_handle(*old_root_node);
-        file_hdr_->root_page_ = INVALID_PAGE_ID;
-        return true;
-    }
-    // 3. 除了上述两种情况，不需要进行操作
+    // 2. 如果old_root_node是叶结点，且大小为0，保留这个空的根结点，和刚建立的索引一样；
+    //    插入路径不处理没有根结点的树，叶子链表也还指向它
+    // 3. 除了上述情况，不需要进行操作
     return false;
 }
 
@@ -1065,6 +1924,8 @@ Rid IxIndexHandle::get_rid(const Iid &iid) const {
  * 可用*(int *)key转换回去
  */
 Iid IxIndexHandle::lower_bound(const char *key) {
+    char norm_key[file_hdr_->col_tot_len_];
+    key = normalize_key(key, norm_key);
     // 先找到对应的叶子节点
     std::pair<IxNodeHandle *, bool> entry = find_leaf_page(key, Operation::FIND, nullptr);
     if (!entry.first) {
@@ -1073,18 +1934,13 @@ Iid IxIndexHandle::lower_bound(const char *key) {
     IxNodeHandle *node = entry.first;
     int key_idx = node->lower_bound(key);
 
-    Iid iid;
-    if(key_idx == node->get_size() && node->get_page_no() != file_hdr_->last_leaf_) {
-        iid = {.page_no = node->get_next_leaf(), .slot_no = 0};
-    }else {
-        iid = {.page_no = node->get_page_no(), .slot_no = key_idx};
-    }
+    Iid iid = {.page_no = node->get_page_no(), .slot_no = key_idx};
     node->page->RUnlatch();
     buffer_pool_manager_->unpin_page(node->get_page_id(), false);
 
     // 释放find_leaf_page的内存
     delete node;
-    return iid;
+    return skip_empty_leaves(iid);
 }
 
 /**
@@ -1094,6 +1950,8 @@ Iid IxIndexHandle::lower_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::upper_bound(const char *key) {
+    char norm_key[file_hdr_->col_tot_len_];
+    key = normalize_key(key, norm_key);
 
     std::pair<IxNodeHandle *, bool> entry = find_leaf_page(key, Operation::FIND, nullptr);
     if(!entry.first) {
@@ -1101,21 +1959,18 @@ Iid IxIndexHandle::upper_bound(const char *key) {
     }
     IxNodeHandle *node = entry.first;
     int key_idx = node->upper_bound(key); // [1, num-key]
-    Iid iid;
-    if(key_idx == node->get_size() && node->get_page_no() != file_hdr_->last_leaf_) {
-        // iid = leaf_end();
-        iid = {.page_no = node->get_next_leaf(), .slot_no = 0};
-    } else {
-        iid = {.page_no = node->get_page_no(), .slot_no = key_idx};
+    // 结点的upper_bound从1开始，叶子结点为空或者key小于第一个key时应为0
+    if(node->get_size() == 0 || node->compare_at(0, key) > 0) {
+        key_idx = 0;
     }
-    
+    Iid iid = {.page_no = node->get_page_no(), .slot_no = key_idx};
 
     // 释放读锁
     node->page->RUnlatch();
     buffer_pool_manager_->unpin_page(node->get_page_id(), false);
 
     delete node;
-    return iid;
+    return skip_empty_leaves(iid);
 }
 
 /**
@@ -1142,6 +1997,27 @@ Iid IxIndexHandle::leaf_end() const {
  */
 Iid IxIndexHandle::leaf_begin() const {
     Iid iid = {.page_no = file_hdr_->first_leaf_, .slot_no = 0};
+    return skip_empty_leaves(iid);
+}
+
+/**
+ * @brief 如果iid指向叶子结点的末尾，则移动到后面第一个非空叶子结点的开头
+ * B-link树不合并结点，中间的叶子结点可能为空，最后一个叶子结点的末尾作为leaf_end保留
+ *
+ * @return Iid 指向一个存在的键值对，或者为leaf_end()
+ */
+Iid IxIndexHandle::skip_empty_leaves(Iid iid) const {
+    while(iid.page_no != file_hdr_->last_leaf_) {
+        IxNodeHandle *node = fetch_node(iid.page_no);
+        bool at_end = iid.slot_no >= node->get_size();
+        page_id_t next_leaf = node->get_next_leaf();
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        if(!at_end) {
+            break;
+        }
+        iid = {.page_no = next_leaf, .slot_no = 0};
+    }
     return iid;
 }
 
@@ -1159,6 +2035,58 @@ IxNodeHandle *IxIndexHandle::fetch_node(int page_no) const {
     return node;
 }
 
+/**
+ * @brief 读路径获取结点，内部结点第一次被读到时保留这次的pin并加入常驻缓存
+ * 常驻页面不会被换出，页号到页面的映射一直有效；分裂只修改结点内容，读者在页面锁下读取，不需要失效缓存；
+ * 内部结点只有在合并或根结点下移时被删除，此时删除者持有该结点的写锁，按latch crabbing不会有读者停在这个结点上
+ *
+ * @param cached 返回结点是否来自缓存，来自缓存的结点释放时不需要unpin
+ */
+IxNodeHandle *IxIndexHandle::fetch_read_node(page_id_t page_no, bool *cached) const {
+    {
+        std::shared_lock<std::shared_mutex> lock(inner_cache_latch_);
+        auto it = inner_cache_.find(page_no);
+        if(it != inner_cache_.end()) {
+            *cached = true;
+            return new IxNodeHandle(file_hdr_, it->second);
+        }
+    }
+    IxNodeHandle *node = fetch_node(page_no);
+    *cached = false;
+    // 结点是叶子还是内部结点在创建之后不会改变，这里不需要加页面锁
+    if(!node->is_leaf_page()) {
+        std::unique_lock<std::shared_mutex> lock(inner_cache_latch_);
+        if(static_cast<int>(inner_cache_.size()) < IX_INNER_CACHE_MAX_PAGES &&
+           inner_cache_.emplace(page_no, node->page).second) {
+            *cached = true;
+        }
+    }
+    return node;
+}
+
+void IxIndexHandle::unpin_read_node(IxNodeHandle *node, bool cached) const {
+    if(!cached) {
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+    }
+}
+
+void IxIndexHandle::evict_inner_node(page_id_t page_no) {
+    std::unique_lock<std::shared_mutex> lock(inner_cache_latch_);
+    auto it = inner_cache_.find(page_no);
+    if(it != inner_cache_.end()) {
+        buffer_pool_manager_->unpin_page(it->second->get_page_id(), false);
+        inner_cache_.erase(it);
+    }
+}
+
+void IxIndexHandle::unpin_inner_cache() const {
+    std::unique_lock<std::shared_mutex> lock(inner_cache_latch_);
+    for(auto &[page_no, page] : inner_cache_) {
+        buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+    }
+    inner_cache_.clear();
+}
+
 /**
  * @brief 创建一个新结点
  *
@@ -1181,7 +2109,8 @@ IxNodeHandle *IxIndexHandle::create_node() {
 }
 
 /**
- * @brief 从node开始更新其父节点的第一个key，一直向上更新直到根节点
+ * @brief 从node开始更新其父节点中对应的key，只有改动的是父结点的第一个key时才继续向上更新
+ * 父结点的其他key改变不影响更上层，所以调用者只需要对第一个key会改变的那一串祖先加写锁（见is_secure）
  *
  * @param node
  */
@@ -1195,21 +2124,23 @@ void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
         char *parent_key = parent->get_key(rank);
         // 获取当前节点的第一个键值
         char *child_first_key = curr->get_key(0);
-        // 判断父节点的key值和当前节点的第一个值是否相等
-        if (memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) == 0) {
-            assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
-            delete parent;
-            break;
+        // 判断父节点的key值和当前节点的第一个值是否相等，不相等就将父节点的key值改成当前节点的第一个key值
+        bool changed = memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) != 0;
+        if(changed) {
+            memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_);  // 修改了parent node
         }
-        // 不相等就将父节点的key值改成当前节点的第一个key值
-        memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_);  // 修改了parent node
+        buffer_pool_manager_->unpin_page(parent->get_page_id(), changed);
 
         if(curr != node) {
             delete curr;
         }
         curr = parent;
-
-        assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
+        if(!changed || rank != 0) {
+            break;
+        }
+    }
+    if(curr != node) {
+        delete curr;
     }
 }
 
@@ -1240,6 +2171,9 @@ void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
  * @param node
  */
 void IxIndexHandle::release_node_handle(IxNodeHandle &node) {
+    if(!node.is_leaf_page()) {
+        evict_inner_node(node.get_page_no());
+    }
     file_hdr_->num_pages_--;
 }
 
@@ -1259,8 +2193,24 @@ void IxIndexHandle::maintain_child(IxNodeHandle *node, int child_idx) {
     }
 }
 
-bool IxIndexHandle::is_secure(IxNodeHandle *node, Operation operation){
+bool IxIndexHandle::is_secure(IxNodeHandle *node, Operation operation, const char *key){
+    // 修改会落在结点的第一个key上时，maintain_parent要修改父结点，所以父结点的写锁不能释放；
+    // B-link树和压缩索引不维护父结点的key
+    if(!no_rebalance() && !node->is_root_page()) {
+        if(node->is_leaf_page()) {
+            int pos = node->lower_bound(key);
+            if(pos == 0 && (operation == Operation::INSERT || (node->get_size() > 0 && node->compare_at(0, key) == 0))) {
+                return false;
+            }
+        }else if(node->upper_bound(key) == 1) {
+            return false;
+        }
+    }
     if(operation == Operation::INSERT){
+        // 压缩结点插入后编码长度可能变长，只有不压缩也放得下时才一定不会分裂
+        if(node->is_compressed()) {
+            return node->get_size() < file_hdr_->btree_order_;
+        }
         return node->get_size() + 1 < node->get_max_size();
 
     }else{
@@ -1295,12 +2245,149 @@ void IxIndexHandle::unlock_all_pages(Transaction* transaction){
     }
 }
 
+/**
+ * @brief 乐观下降：内部结点只加读锁，只对叶子结点加写锁
+ * 持有父结点读锁时孩子不会被删除，所以可以在加锁前读取孩子的is_leaf
+ *
+ * @return 加了写锁并且pin住的叶子结点，需要在外面unlatch、unpin并delete
+ */
+IxNodeHandle *IxIndexHandle::find_leaf_page_optimistic(const char *key) {
+    // 根结点可能被悲观的写操作替换，所以获取根结点时需要root_latch_
+    root_latch_.lock();
+    bool cur_cached;
+    IxNodeHandle *cur_node_hdl = fetch_read_node(file_hdr_->root_page_, &cur_cached);
+    if(cur_node_hdl->is_leaf_page()) {
+        cur_node_hdl->page->WLatch();
+    }else {
+        cur_node_hdl->page->RLatch();
+    }
+    root_latch_.unlock();
+
+    while(!cur_node_hdl->is_leaf_page()) {
+        bool child_cached;
+        IxNodeHandle *child_node_hdl = fetch_read_node(cur_node_hdl->internal_lookup(key), &child_cached);
+        if(child_node_hdl->is_leaf_page()) {
+            child_node_hdl->page->WLatch();
+        }else {
+            child_node_hdl->page->RLatch();
+        }
+        cur_node_hdl->page->RUnlatch();
+        unpin_read_node(cur_node_hdl, cur_cached);
+        delete cur_node_hdl;
+        cur_node_hdl = child_node_hdl;
+        cur_cached = child_cached;
+    }
+    return cur_node_hdl;
+}
+
+/**
+ * @brief 乐观插入：只有在叶子结点不会分裂、并且插入位置不是叶子的第一个key（不需要修改父结点）时才完成插入
+ *
+ * @return 插入到的叶结点的page_no，返回IX_NO_PAGE表示需要按悲观方式重新插入，key已经存在时返回IX_DUPLICATE_KEY
+ */
+page_id_t IxIndexHandle::insert_entry_optimistic(const char *key, const Rid &value) {
+    IxNodeHandle *leaf = find_leaf_page_optimistic(key);
+    int pos = leaf->lower_bound(key);
+    if(pos < leaf->get_size() && leaf->compare_at(pos, key) == 0) {
+        // 键重复，和悲观插入一样返回IX_DUPLICATE_KEY
+        leaf->page->WUnlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+        delete leaf;
+        return IX_DUPLICATE_KEY;
+    }
+
+    page_id_t page_no = IX_NO_PAGE;
+    if(leaf->can_insert(key) && (pos != 0 || leaf->is_root_page() || no_rebalance())) {
+        leaf->insert_pair(pos, key, value);
+        page_no = leaf->get_page_no();
+    }
+    leaf->page->WUnlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), page_no != IX_NO_PAGE);
+    delete leaf;
+    return page_no;
+}
+
+/**
+ * @brief 乐观删除：只有在叶子结点删除后不会低于半满、并且删除的不是叶子的第一个key时才完成删除
+ * B-link树和压缩索引不合并结点，允许叶子结点不满甚至为空，所以总是只修改叶子结点
+ *
+ * @param[out] deleted 键值对是否存在并被删除
+ * @return 是否已经完成删除，返回false表示需要按悲观方式重新删除
+ */
+bool IxIndexHandle::delete_entry_optimistic(const char *key, bool *deleted) {
+    IxNodeHandle *leaf = find_leaf_page_optimistic(key);
+    int pos = leaf->lower_bound(key);
+    bool done = false;
+    *deleted = false;
+    if(pos == leaf->get_size() || leaf->compare_at(pos, key) != 0) {
+        // key不存在，不需要修改
+        done = true;
+    }else if(no_rebalance() ||
+             (leaf->is_root_page() ? leaf->get_size() > 1 : (pos != 0 && leaf->get_size() - 1 >= leaf->get_min_size()))) {
+        leaf->erase_pair(pos);
+        done = true;
+        *deleted = true;
+    }
+    leaf->page->WUnlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), *deleted);
+    delete leaf;
+    return done;
+}
+
+/**
+ * @brief B-link树的读者下降：每次只持有一个结点的读锁（向右移动时短暂持有两个）
+ * 如果读到父结点之后孩子发生了分裂，key可能已经被移到孩子的右兄弟中，此时key >= high key，沿右链接向右移动即可
+ *
+ * @return 加了读锁的叶子结点，需要在外面unlatch、unpin并delete
+ */
+std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page_blink(const char *key, bool find_first) {
+    bool cur_cached;
+    IxNodeHandle *cur_node_hdl = fetch_read_node(get_root_page_no(), &cur_cached);
+    cur_node_hdl->page->RLatch();
+    while(true) {
+        // 1. 结点在读取父结点之后分裂了，沿右链接移动到包含key的结点
+        while(!find_first && cur_node_hdl->get_right_link() != IX_NO_PAGE &&
+              compare_key(key, cur_node_hdl->get_high_key()) >= 0) {
+            bool right_cached;
+            IxNodeHandle *right_node_hdl = fetch_read_node(cur_node_hdl->get_right_link(), &right_cached);
+            right_node_hdl->page->RLatch();
+            cur_node_hdl->page->RUnlatch();
+            unpin_read_node(cur_node_hdl, cur_cached);
+            delete cur_node_hdl;
+            cur_node_hdl = right_node_hdl;
+            cur_cached = right_cached;
+        }
+        if(cur_node_hdl->is_leaf_page()) {
+            break;
+        }
+        // 2. 先释放父结点的读锁，再给孩子加读锁
+        page_id_t child_page_no = find_first ? cur_node_hdl->value_at(0) : cur_node_hdl->internal_lookup(key);
+        cur_node_hdl->page->RUnlatch();
+        unpin_read_node(cur_node_hdl, cur_cached);
+        delete cur_node_hdl;
+        cur_node_hdl = fetch_read_node(child_page_no, &cur_cached);
+        cur_node_hdl->page->RLatch();
+    }
+    return std::make_pair(cur_node_hdl, false);
+}
 
 std::pair<bool, std::unique_ptr<RmRecord>> IxIndexHandle::get_min_key(Transaction *transaction) {
     auto leaf_pair = find_leaf_page(nullptr, Operation::FIND, transaction, true);
     auto first_leaf = leaf_pair.first;
+    // B-link树不合并结点，靠左的叶子结点可能为空
+    while(first_leaf->get_size() == 0 && first_leaf->get_page_no() != file_hdr_->last_leaf_) {
+        IxNodeHandle *next_leaf = fetch_node(first_leaf->get_next_leaf());
+        next_leaf->page->RLatch();
+        first_leaf->page->RUnlatch();
+        buffer_pool_manager_->unpin_page(first_leaf->get_page_id(), false);
+        delete first_leaf;
+        first_leaf = next_leaf;
+    }
     if(first_leaf->get_size() > 0) {
-        auto record = std::make_unique<RmRecord>(file_hdr_->tot_len_, first_leaf->get_key(0));
+        auto record = std::make_unique<RmRecord>(file_hdr_->col_tot_len_, first_leaf->get_key(0));
+        if(file_hdr_->is_normalized_) {
+            ix_decode_key(file_hdr_, first_leaf->get_key(0), record->data);
+        }
         first_leaf->page->RUnlatch();
         buffer_pool_manager_->unpin_page(first_leaf->get_page_id(), false);
         delete first_leaf;
@@ -1315,8 +2402,20 @@ std::pair<bool, std::unique_ptr<RmRecord>> IxIndexHandle::get_min_key(Transactio
 std::pair<bool, std::unique_ptr<RmRecord>> IxIndexHandle::get_max_key(Transaction *transaction) {
     auto last_leaf = fetch_node(file_hdr_->last_leaf_);
     last_leaf->page->RLatch();
+    // B-link树不合并结点，靠右的叶子结点可能为空；向左移动时先释放当前结点的锁，避免和从左向右加锁的读者交叉
+    while(last_leaf->get_size() == 0 && last_leaf->get_prev_leaf() != IX_LEAF_HEADER_PAGE) {
+        page_id_t prev_leaf = last_leaf->get_prev_leaf();
+        last_leaf->page->RUnlatch();
+        buffer_pool_manager_->unpin_page(last_leaf->get_page_id(), false);
+        delete last_leaf;
+        last_leaf = fetch_node(prev_leaf);
+        last_leaf->page->RLatch();
+    }
     if(last_leaf->get_size() > 0) {
-        auto record = std::make_unique<RmRecord>(file_hdr_->tot_len_, last_leaf->get_key(last_leaf->get_size() - 1));
+        auto record = std::make_unique<RmRecord>(file_hdr_->col_tot_len_, last_leaf->get_key(last_leaf->get_size() - 1));
+        if(file_hdr_->is_normalized_) {
+            ix_decode_key(file_hdr_, last_leaf->get_key(last_leaf->get_size() - 1), record->data);
+        }
         last_leaf->page->RUnlatch();
         buffer_pool_manager_->unpin_page(last_leaf->get_page_id(), false);
         delete last_leaf;
@@ -10,12 +10,29 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+#include <unordered_map>
+
 #include "ix_defs.h"
+#include "ix_art.h"
+#include "ix_hash_table.h"
 #include "transaction/transaction.h"
 
+class IxBulkSorter;
+
 enum class Operation { FIND = 0, INSERT, DELETE };  // 三种操作：查找、插入、删除
 
 static const bool binary_search = true;
+// 插入和删除先用读锁下降、只对叶子加写锁，只有需要分裂、合并或修改父节点时才重新按悲观方式下降
+static const bool optimistic_latch = true;
+// 每个索引常驻缓冲池的内部结点数量上限，4KB的页面约4MB
+static const int IX_INNER_CACHE_MAX_PAGES = 1024;
 
 /**
  * a < b : -1
@@ -42,8 +59,10 @@ inline int ix_compare(const char *a, const char *b, ColType type, int col_len) {
             uint64_t date_b = *(uint64_t *)b;
             return (date_a < date_b) ? -1 : ((date_a > date_b) ? 1 : 0);
         }
-        case TYPE_BIGINT : {
-            throw RMDBError("In ix_index_handle, we don't implement bigint type");
+        case TYPE_BIGINT: {
+            int64_t ia = *(int64_t *)a;
+            int64_t ib = *(int64_t *)b;
+            return (ia < ib) ? -1 : ((ia > ib) ? 1 : 0);
         }
 
         default:
@@ -61,6 +80,261 @@ inline int ix_compare(const char* a, const char* b, const std::vector<ColType>&
     return 0;
 }
 
+/* 单个定长数值字段的比较，不做类型分派，也没有分支 */
+template <typename T>
+inline int ix_compare_scalar(const char *a, const char *b) {
+    T va, vb;
+    memcpy(&va, a, sizeof(T));
+    memcpy(&vb, b, sizeof(T));
+    return (va > vb) - (va < vb);
+}
+
+template <typename T>
+inline int ix_compare_single(const char *a, const char *b, const IxFileHdr *) {
+    return ix_compare_scalar<T>(a, b);
+}
+
+inline int ix_compare_single_string(const char *a, const char *b, const IxFileHdr *file_hdr) {
+    return memcmp(a, b, file_hdr->col_tot_len_);
+}
+
+inline int ix_compare_composite(const char *a, const char *b, const IxFileHdr *file_hdr) {
+    return ix_compare(a, b, file_hdr->col_types_, file_hdr->col_lens_);
+}
+
+/**
+ * @brief 把record格式的key编码为可以直接memcmp比较的格式
+ * 整数转成大端并翻转符号位；浮点数为正时翻转符号位，为负时按位取反，再转成大端；DATETIME转成大端；字符串本身定长，保持不变
+ */
+inline void ix_encode_key(const IxFileHdr *file_hdr, const char *src, char *dst) {
+    int offset = 0;
+    for(int i = 0; i < file_hdr->col_num_; i++) {
+        int len = file_hdr->col_lens_[i];
+        switch (file_hdr->col_types_[i]) {
+            case TYPE_INT: {
+                uint32_t v;
+                memcpy(&v, src + offset, sizeof(v));
+                v = __builtin_bswap32(v ^ 0x80000000u);
+                memcpy(dst + offset, &v, sizeof(v));
+                break;
+            }
+            case TYPE_FLOAT: {
+                uint32_t v;
+                memcpy(&v, src + offset, sizeof(v));
+                // -0.0和0.0相等，统一编码成0.0
+                if(v == 0x80000000u) {
+                    v = 0;
+                }
+                v = (v & 0x80000000u) ? ~v : (v | 0x80000000u);
+                v = __builtin_bswap32(v);
+                memcpy(dst + offset, &v, sizeof(v));
+                break;
+            }
+            case TYPE_BIGINT: {
+                uint64_t v;
+                memcpy(&v, src + offset, sizeof(v));
+                v = __builtin_bswap64(v ^ 0x8000000000000000ull);
+                memcpy(dst + offset, &v, sizeof(v));
+                break;
+            }
+            case TYPE_DATETIME: {
+                uint64_t v;
+                memcpy(&v, src + offset, sizeof(v));
+                v = __builtin_bswap64(v);
+                memcpy(dst + offset, &v, sizeof(v));
+                break;
+            }
+            default:
+                memcpy(dst + offset, src + offset, len);
+                break;
+        }
+        offset += len;
+    }
+}
+
+/**
+ * @brief ix_encode_key的逆变换，把结点中保存的key还原成record格式
+ */
+inline void ix_decode_key(const IxFileHdr *file_hdr, const char *src, char *dst) {
+    int offset = 0;
+    for(int i = 0; i < file_hdr->col_num_; i++) {
+        int len = file_hdr->col_lens_[i];
+        switch (file_hdr->col_types_[i]) {
+            case TYPE_INT: {
+                uint32_t v;
+                memcpy(&v, src + offset, sizeof(v));
+                v = __builtin_bswap32(v) ^ 0x80000000u;
+                memcpy(dst + offset, &v, sizeof(v));
+                break;
+            }
+            case TYPE_FLOAT: {
+                uint32_t v;
+                memcpy(&v, src + offset, sizeof(v));
+                v = __builtin_bswap32(v);
+                v = (v & 0x80000000u) ? (v ^ 0x80000000u) : ~v;
+                memcpy(dst + offset, &v, sizeof(v));
+                break;
+            }
+            case TYPE_BIGINT: {
+                uint64_t v;
+                memcpy(&v, src + offset, sizeof(v));
+                v = __builtin_bswap64(v) ^ 0x8000000000000000ull;
+                memcpy(dst + offset, &v, sizeof(v));
+                break;
+            }
+            case TYPE_DATETIME: {
+                uint64_t v;
+                memcpy(&v, src + offset, sizeof(v));
+                v = __builtin_bswap64(v);
+                memcpy(dst + offset, &v, sizeof(v));
+                break;
+            }
+            default:
+                memcpy(dst + offset, src + offset, len);
+                break;
+        }
+        offset += len;
+    }
+}
+
+/**
+ * @brief 根据索引的字段类型选择key比较函数和结点内查找方式，只在打开索引时调用一次
+ */
+inline void ix_init_key_compare(IxFileHdr *file_hdr) {
+    file_hdr->key_kind_ = IxKeyKind::GENERIC;
+    file_hdr->key_compare_ = ix_compare_composite;
+    if(file_hdr->is_normalized_) {
+        // 编码后的key整体memcmp即可
+        file_hdr->key_compare_ = ix_compare_single_string;
+        return;
+    }
+    if(file_hdr->col_num_ != 1) {
+        return;
+    }
+    switch (file_hdr->col_types_[0]) {
+        case TYPE_INT:
+            file_hdr->key_kind_ = IxKeyKind::INT;
+            file_hdr->key_compare_ = ix_compare_single<int32_t>;
+            break;
+        case TYPE_FLOAT:
+            file_hdr->key_compare_ = ix_compare_single<float>;
+            break;
+        case TYPE_BIGINT:
+            file_hdr->key_kind_ = IxKeyKind::BIGINT;
+            file_hdr->key_compare_ = ix_compare_single<int64_t>;
+            break;
+        case TYPE_DATETIME:
+            file_hdr->key_kind_ = IxKeyKind::DATETIME;
+            file_hdr->key_compare_ = ix_compare_single<uint64_t>;
+            break;
+        case TYPE_STRING:
+            file_hdr->key_compare_ = ix_compare_single_string;
+            break;
+        default:
+            break;
+    }
+}
+
+/* 结点内二分查找缩小到这个范围以内之后，改为顺序（SIMD）统计 */
+static constexpr int IX_SEARCH_WINDOW = 16;
+
+/**
+ * @brief 统计keys[0, n)中小于target（or_equal时为小于等于）的个数
+ */
+template <typename T>
+inline int ix_count_less(const T *keys, int n, T target, bool or_equal) {
+    int cnt = 0;
+    for(int i = 0; i < n; i++) {
+        cnt += or_equal ? (keys[i] <= target) : (keys[i] < target);
+    }
+    return cnt;
+}
+
+#if defined(__SSE2__)
+template <>
+inline int ix_count_less<int32_t>(const int32_t *keys, int n, int32_t target, bool or_equal) {
+    // 小于等于target的个数 = 小于(target+1)的个数，target为INT32_MAX时全部满足
+    if(or_equal) {
+        if(target == INT32_MAX) {
+            return n;
+        }
+        target++;
+    }
+    __m128i t = _mm_set1_epi32(target);
+    int cnt = 0, i = 0;
+    for(; i + 4 <= n; i += 4) {
+        __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+        cnt += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(k, t))));
+    }
+    for(; i < n; i++) {
+        cnt += keys[i] < target;
+    }
+    return cnt;
+}
+#endif
+
+#if defined(__SSE4_2__)
+template <>
+inline int ix_count_less<int64_t>(const int64_t *keys, int n, int64_t target, bool or_equal) {
+    if(or_equal) {
+        if(target == INT64_MAX) {
+            return n;
+        }
+        target++;
+    }
+    __m128i t = _mm_set1_epi64x(target);
+    int cnt = 0, i = 0;
+    for(; i + 2 <= n; i += 2) {
+        __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+        cnt += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(t, k))));
+    }
+    for(; i < n; i++) {
+        cnt += keys[i] < target;
+    }
+    return cnt;
+}
+
+template <>
+inline int ix_count_less<uint64_t>(const uint64_t *keys, int n, uint64_t target, bool or_equal) {
+    if(or_equal) {
+        if(target == UINT64_MAX) {
+            return n;
+        }
+        target++;
+    }
+    // SSE只有有符号64位比较，翻转符号位之后比较无符号数
+    const __m128i sign = _mm_set1_epi64x(INT64_MIN);
+    __m128i t = _mm_xor_si128(_mm_set1_epi64x(static_cast<int64_t>(target)), sign);
+    int cnt = 0, i = 0;
+    for(; i + 2 <= n; i += 2) {
+        __m128i k = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i)), sign);
+        cnt += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(t, k))));
+    }
+    for(; i < n; i++) {
+        cnt += keys[i] < target;
+    }
+    return cnt;
+}
+#endif
+
+/**
+ * @brief 在有序数组keys的[left, right)中查找第一个>=target（upper时为>target）的位置，找不到返回right
+ * 先用无分支的二分把范围缩小到IX_SEARCH_WINDOW以内，再统计窗口中小于target的个数
+ */
+template <typename T>
+inline int ix_search_sorted(const T *keys, int left, int right, T target, bool upper) {
+    if(right <= left) {
+        return left;
+    }
+    while(right - left > IX_SEARCH_WINDOW) {
+        int mid = left + (right - left) / 2;
+        bool go_right = upper ? !(target < keys[mid]) : (keys[mid] < target);
+        left = go_right ? mid + 1 : left;
+        right = go_right ? right : mid;
+    }
+    return left + ix_count_less<T>(keys + left, right - left, target, upper);
+}
+
 /* 管理B+树中的每个节点 */
 class IxNodeHandle {
     friend class IxIndexHandle;
@@ -73,6 +347,14 @@ class IxNodeHandle {
     char *keys;                     // page->data的第二部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len
     Rid *rids;                      // page->data的第三部分，指针指向首地址
 
+    // 压缩结点第一次访问key时整个结点解码到缓存中，get_key/get_rid返回缓存中的地址；
+    // 之后的修改先改缓存再整体编码写回页面，编码后页面放不下时置overfull_，由调用者分裂结点
+    mutable std::vector<char> key_cache_;
+    mutable std::vector<Rid> rid_cache_;
+    mutable int cache_size_ = 0;
+    mutable bool loaded_ = false;
+    bool overfull_ = false;
+
    public:
     IxNodeHandle() = default;
 
@@ -82,13 +364,24 @@ class IxNodeHandle {
         rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
     }
 
-    int get_size() { return page_hdr->num_key; }
+    bool is_compressed() const { return file_hdr->is_compressed_; }
 
-    void set_size(int size) { page_hdr->num_key = size; }
+    int get_size() const { return (is_compressed() && loaded_) ? cache_size_ : page_hdr->num_key; }
 
-    int get_max_size() { return file_hdr->btree_order_ + 1; }
+    void set_size(int size);
 
-    int get_min_size() { return get_max_size() / 2; }
+    /**
+     * 结点中的键值对数量达到max_size时需要分裂。压缩结点最多保存2*btree_order-2个键值对，
+     * 这样分裂出的两个结点即使不压缩也放得下；编码后页面放不下时当前数量就是max_size
+     */
+    int get_max_size() const {
+        if(is_compressed()) {
+            return overfull_ ? get_size() : 2 * file_hdr->btree_order_ - 1;
+        }
+        return file_hdr->btree_order_ + 1;
+    }
+
+    int get_min_size() const { return is_compressed() ? (file_hdr->btree_order_ + 1) / 2 : get_max_size() / 2; }
 
     int key_at(int i) { return *(int *)get_key(i); }
 
@@ -115,13 +408,65 @@ class IxNodeHandle {
 
     void set_parent_page_no(page_id_t parent) { page_hdr->parent = parent; }
 
-    char *get_key(int key_idx) const { return keys + key_idx * file_hdr->col_tot_len_; }
+    /* B-link树中右兄弟的page_no，最右边的结点返回IX_NO_PAGE */
+    page_id_t get_right_link() {
+        page_id_t right = page_hdr->next_leaf;
+        return right == IX_LEAF_HEADER_PAGE ? IX_NO_PAGE : right;
+    }
+
+    /* B-link树中结点的high key，保存在rids之后（压缩结点保存在模板key之后），结点中所有key都小于high key，只有存在右兄弟时有效 */
+    char *get_high_key() const {
+        if(is_compressed()) {
+            return packed_template_key() + file_hdr->col_tot_len_;
+        }
+        return reinterpret_cast<char *>(rids + file_hdr->btree_order_ + 1);
+    }
+
+    void set_high_key(const char *key) { memcpy(get_high_key(), key, file_hdr->col_tot_len_); }
+
+    char *get_key(int key_idx) const {
+        if(is_compressed()) {
+            load();
+            return key_cache_.data() + key_idx * file_hdr->col_tot_len_;
+        }
+        return keys + key_idx * file_hdr->col_tot_len_;
+    }
+
+    int compare_key(const char *a, const char *b) const { return file_hdr->key_compare_(a, b, file_hdr); }
+
+    /* 比较第key_idx个key和target，压缩结点不需要先解码 */
+    int compare_at(int key_idx, const char *target) const {
+        if(is_compressed() && !loaded_) {
+            return packed_compare(key_idx, target);
+        }
+        return compare_key(get_key(key_idx), target);
+    }
+
+    // 压缩结点解码之后返回缓存中的rid，直接通过指针修改时需要之后调用set_size写回页面
+    Rid *get_rid(int rid_idx) const {
+        if(is_compressed()) {
+            return loaded_ ? &rid_cache_[rid_idx] : packed_rids() + rid_idx;
+        }
+        return &rids[rid_idx];
+    }
 
-    Rid *get_rid(int rid_idx) const { return &rids[rid_idx]; }
+    void set_key(int key_idx, const char *key);
 
-    void set_key(int key_idx, const char *key) { memcpy(keys + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_); }
+    void set_rid(int rid_idx, const Rid &rid);
 
-    void set_rid(int rid_idx, const Rid &rid) { rids[rid_idx] = rid; }
+    // 插入key之后结点是否不需要分裂
+    bool can_insert(const char *key) const;
+
+    // 压缩结点中rids在页面中的偏移，与key的数量无关
+    static int packed_rids_offset(const IxFileHdr *file_hdr) {
+        int offset = sizeof(IxPageHdr) + sizeof(IxCompressHdr) + 2 * file_hdr->col_tot_len_;
+        return (offset + alignof(Rid) - 1) / alignof(Rid) * alignof(Rid);
+    }
+
+    // 压缩结点保存n个中间部分长度为mid_len的key是否放得下
+    static bool packed_fits(const IxFileHdr *file_hdr, int n, int mid_len) {
+        return packed_rids_offset(file_hdr) + n * static_cast<int>(sizeof(Rid) + mid_len) <= PAGE_SIZE;
+    }
 
     bool is_exist_key(const char *key) const;
 
@@ -164,14 +509,34 @@ class IxNodeHandle {
      */
     int find_child(IxNodeHandle *child) {
         int rid_idx;
-        for (rid_idx = 0; rid_idx < page_hdr->num_key; rid_idx++) {
+        for (rid_idx = 0; rid_idx < get_size(); rid_idx++) {
             if (get_rid(rid_idx)->page_no == child->get_page_no()) {
                 break;
             }
         }
-        assert(rid_idx < page_hdr->num_key);
+        assert(rid_idx < get_size());
         return rid_idx;
     }
+
+   private:
+    // for compressed node
+    IxCompressHdr *packed_hdr() const {
+        return reinterpret_cast<IxCompressHdr *>(page->get_data() + sizeof(IxPageHdr));
+    }
+
+    char *packed_template_key() const { return page->get_data() + sizeof(IxPageHdr) + sizeof(IxCompressHdr); }
+
+    Rid *packed_rids() const { return reinterpret_cast<Rid *>(page->get_data() + packed_rids_offset(file_hdr)); }
+
+    char *packed_mids() const { return reinterpret_cast<char *>(packed_rids() + page_hdr->num_key); }
+
+    int packed_compare(int key_idx, const char *target) const;
+
+    int packed_search(const char *target, int left, bool upper) const;
+
+    void load() const;
+
+    void store();
 };
 
 /* B+树 */
@@ -185,6 +550,11 @@ class IxIndexHandle {
     int fd_;                                    // 存储B+树的文件
     IxFileHdr* file_hdr_;                       // 存了root_page，但其初始化为2（第0页存FILE_HDR_PAGE，第1页存LEAF_HEADER_PAGE）
     std::mutex root_latch_;
+    std::unique_ptr<IxHashTable> hash_;         // 哈希索引的实现，B+树索引为空
+    std::unique_ptr<IxArt> art_;                // 内存中的ART索引的实现，其它索引为空
+    // 读路径下降时访问过的内部结点保持pin，之后直接使用缓存的页面，不再经过缓冲池查找和pin/unpin
+    mutable std::shared_mutex inner_cache_latch_;
+    mutable std::unordered_map<page_id_t, Page *> inner_cache_;
 
    public:
     IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
@@ -195,17 +565,28 @@ class IxIndexHandle {
     // for search
     bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
 
+    // 批量查找：key排序后从左向右一趟完成，结果按keys的顺序写入result和found，返回找到的key数量
+    int get_values(const std::vector<const char *> &keys, std::vector<Rid> *result, std::vector<bool> *found,
+                   Transaction *transaction);
+
     std::pair<IxNodeHandle *, bool> find_leaf_page(const char *key, Operation operation, Transaction *transaction,
                                                  bool find_first = false);
 
     // for insert
     page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
+    // 唯一索引插入：key已经存在时不插入并返回false，不需要先调用get_value检查
+    bool insert_entry_if_absent(const char *key, const Rid &value, Transaction *transaction);
     // 批量插入的情况
     void massive_insert(std::vector<char *> &keys, std::vector<Rid> &rids, Transaction *transaction);
 
-    IxNodeHandle *split(IxNodeHandle *node);
+    // 从排好序的(key, rid)批量建树，空树按索引的填充率自底向上构建，否则按顺序逐个插入
+    void bulk_load(IxBulkSorter *sorter, Transaction *transaction);
+
+    // append为true表示插入发生在最右结点的末尾（顺序插入），此时按填充率分裂，否则从中间分裂
+    IxNodeHandle *split(IxNodeHandle *node, bool append = false);
 
-    void insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node, Transaction *transaction);
+    void insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node, Transaction *transaction,
+                            bool *root_is_latched, bool append = false);
 
     // for delete
     bool delete_entry(const char *key, Transaction *transaction);
@@ -219,6 +600,12 @@ class IxIndexHandle {
     bool coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
                   Transaction *transaction, bool *root_is_latched);
 
+    // 叶子平均填充率或者仍在使用的页面比例低于min_fill时返回true，表示需要重建
+    bool needs_compact(double min_fill);
+
+    // 统计树高、结点个数、填充率和各前缀的不同取值个数，叶子多于max_sample_leaves时抽样估计
+    IxIndexStats get_stats(int max_sample_leaves);
+
     Iid lower_bound(const char *key);
 
     Iid upper_bound(const char *key);
@@ -231,15 +618,50 @@ class IxIndexHandle {
 
     std::pair<bool, std::unique_ptr<RmRecord>> get_max_key(Transaction *transaction) ;
 
+    const IxFileHdr *get_file_hdr() const { return file_hdr_; }
+
+    bool is_hash() const { return hash_ != nullptr; }
+
+    bool is_art() const { return art_ != nullptr; }
+
    private:
     // 辅助函数
-    void update_root_page_no(page_id_t root) { file_hdr_->root_page_ = root; }
+    // B-link树的读者不加root_latch_读取根结点，所以这里需要原子写
+    void update_root_page_no(page_id_t root) { __atomic_store_n(&file_hdr_->root_page_, root, __ATOMIC_RELEASE); }
 
     bool is_empty() const { return file_hdr_->root_page_ == IX_NO_PAGE; }
 
+    int compare_key(const char *a, const char *b) const { return file_hdr_->key_compare_(a, b, file_hdr_); }
+
+    // B-link树和压缩索引删除时只修改叶子结点，不合并、不重分配，也不维护父结点中的分隔key
+    // 压缩结点的容量和key有关，合并后的结点不一定放得下；建索引时指定LAZY DELETE的B+树也这样删除，由vacuum整体重建
+    bool no_rebalance() const { return file_hdr_->is_lazy_delete_ || file_hdr_->is_blink_ || file_hdr_->is_compressed_; }
+
+    const char *shortest_separator(const char *left_last, const char *right_first, char *buf) const;
+
+    // 上层传入的key都是record格式，编码索引在进入B+树之前先编码到buf中
+    const char *normalize_key(const char *key, char *buf) const {
+        if(!file_hdr_->is_normalized_ || key == nullptr) {
+            return key;
+        }
+        ix_encode_key(file_hdr_, key, buf);
+        return buf;
+    }
+
     // for get/create node
     IxNodeHandle* fetch_node(int page_no) const;
 
+    // 读路径获取结点：命中常驻的内部结点时不访问缓冲池，*cached返回结点是否来自缓存，释放时用unpin_read_node
+    IxNodeHandle *fetch_read_node(page_id_t page_no, bool *cached) const;
+
+    void unpin_read_node(IxNodeHandle *node, bool cached) const;
+
+    // 内部结点被删除时从缓存中移除，否则常驻的pin会让缓冲池无法删除该页面
+    void evict_inner_node(page_id_t page_no);
+
+    // 关闭索引前释放所有常驻结点的pin
+    void unpin_inner_cache() const;
+
     IxNodeHandle* create_node();
 
     // for maintain data structure
@@ -251,12 +673,32 @@ class IxIndexHandle {
 
     void maintain_child(IxNodeHandle *node, int child_idx);
 
-    bool is_secure(IxNodeHandle *node, Operation operation);
+    // key为本次插入或删除的key
+    bool is_secure(IxNodeHandle *node, Operation operation, const char *key);
 
     void unlock_unpin_all_pages(Transaction* transaction);
 
     void unlock_all_pages(Transaction* transaction);
 
+    // for optimistic latch crabbing
+    IxNodeHandle *find_leaf_page_optimistic(const char *key);
+
+    page_id_t insert_entry_optimistic(const char *key, const Rid &value);
+
+    page_id_t insert_normalized(const char *key, const Rid &value, Transaction *transaction);
+
+    bool delete_entry_optimistic(const char *key, bool *deleted);
+
+    // for bulk load
+    void build_bottom_up(IxBulkSorter *sorter, IxNodeHandle *first_leaf, double fill_factor);
+
+    // for B-link tree
+    std::pair<IxNodeHandle *, bool> find_leaf_page_blink(const char *key, bool find_first);
+
+    page_id_t get_root_page_no() const { return __atomic_load_n(&file_hdr_->root_page_, __ATOMIC_ACQUIRE); }
+
+    Iid skip_empty_leaves(Iid iid) const;
+
     // for index test
     Rid get_rid(const Iid &iid) const;
 };
\ No newline at end of file
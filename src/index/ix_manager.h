@@ -54,8 +54,19 @@ class IxManager {
         return disk_manager_->is_file(ix_name);
     }
 
-    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
-        std::string ix_name = get_index_name(filename, index_cols);
+    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols, bool is_blink = false,
+                      bool is_hash = false, int fill_factor = IX_DEFAULT_FILL_FACTOR, bool is_art = false,
+                      bool is_lazy_delete = false) {
+        create_index_file(get_index_name(filename, index_cols), index_cols, is_blink, is_hash, fill_factor, is_art,
+                          is_lazy_delete);
+    }
+
+    /**
+     * @brief 按文件名创建索引文件，vacuum重建索引时先建在临时文件中
+     */
+    void create_index_file(const std::string &ix_name, const std::vector<ColMeta>& index_cols, bool is_blink = false,
+                           bool is_hash = false, int fill_factor = IX_DEFAULT_FILL_FACTOR, bool is_art = false,
+                           bool is_lazy_delete = false) {
         // Create index file
         disk_manager_->create_file(ix_name);
         // Open index file
@@ -73,9 +84,28 @@ class IxManager {
         if (col_tot_len > IX_MAX_COL_LEN) {
             throw InvalidColLengthError(col_tot_len);
         }
+        if(is_hash) {
+            create_hash_index(fd, index_cols, col_tot_len);
+            disk_manager_->close_file(fd);
+            return;
+        }
+        if(is_art) {
+            create_art_index(fd, index_cols, col_tot_len);
+            disk_manager_->close_file(fd);
+            return;
+        }
         // 根据 |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE 求得n的最大值btree_order
         // 即 n <= btree_order，那么btree_order就是每个结点最多可插入的键值对数量（实际还多留了一个空位，但其不可插入）
-        int btree_order = static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr)) / (col_tot_len + sizeof(Rid)) - 1);
+        // B-link树在rids之后还要为high key保留一个key的空间
+        int high_key_len = is_blink ? col_tot_len : 0;
+        // 包含字符串字段的索引key可以memcmp比较（单字段字符串，或者编码后的多字段key），结点按前缀/后缀压缩保存，
+        // 此时页面中固定有IxCompressHdr、模板key和high key，btree_order是不压缩时能放下的键值对数量
+        bool is_compressed = false;
+        for(auto &col : index_cols) {
+            is_compressed |= col.type == TYPE_STRING;
+        }
+        int reserved_len = is_compressed ? sizeof(IxCompressHdr) + 2 * col_tot_len + alignof(Rid) : high_key_len;
+        int btree_order = static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr) - reserved_len) / (col_tot_len + sizeof(Rid)) - 1);
         assert(btree_order > 2);
 
         // Create file header and write to file
@@ -86,6 +116,12 @@ class IxManager {
             fhdr->col_types_.push_back(index_cols[i].type);
             fhdr->col_lens_.push_back(index_cols[i].len);
         }
+        fhdr->is_blink_ = is_blink;
+        // 多字段索引的key按可memcmp比较的格式保存，单字段索引已经有按类型特化的比较
+        fhdr->is_normalized_ = col_num > 1;
+        fhdr->is_compressed_ = is_compressed;
+        fhdr->fill_factor_ = fill_factor;
+        fhdr->is_lazy_delete_ = is_lazy_delete;
         fhdr->update_tot_len();
         
         char* data = new char[fhdr->tot_len_];
@@ -136,6 +172,54 @@ class IxManager {
         disk_manager_->close_file(fd);
     }
 
+    /**
+     * @brief 初始化哈希索引文件，key总是编码后保存，btree_order记录每个桶的容量
+     */
+    void create_hash_index(int fd, const std::vector<ColMeta>& index_cols, int col_tot_len) {
+        int col_num = index_cols.size();
+        int bucket_capacity = IxHashTable::bucket_capacity(col_tot_len);
+        IxFileHdr* fhdr = new IxFileHdr(IX_NO_PAGE, IX_HASH_INIT_NUM_PAGES, IX_NO_PAGE, col_num, col_tot_len,
+                                        bucket_capacity, bucket_capacity * col_tot_len, IX_NO_PAGE, IX_NO_PAGE);
+        for(int i = 0; i < col_num; ++i) {
+            fhdr->col_types_.push_back(index_cols[i].type);
+            fhdr->col_lens_.push_back(index_cols[i].len);
+        }
+        fhdr->is_normalized_ = true;
+        fhdr->is_hash_ = true;
+        fhdr->update_tot_len();
+
+        char* data = new char[fhdr->tot_len_];
+        fhdr->serialize(data);
+        disk_manager_->write_page(fd, IX_FILE_HDR_PAGE, data, fhdr->tot_len_);
+        delete[] data;
+        delete fhdr;
+
+        IxHashTable::init_file(disk_manager_, fd);
+    }
+
+    /**
+     * @brief 初始化ART索引文件，树只在内存中，文件里只写入文件头，用来在打开数据库时识别索引类型
+     */
+    void create_art_index(int fd, const std::vector<ColMeta>& index_cols, int col_tot_len) {
+        int col_num = index_cols.size();
+        IxFileHdr* fhdr = new IxFileHdr(IX_NO_PAGE, IX_FILE_HDR_PAGE + 1, IX_NO_PAGE, col_num, col_tot_len,
+                                        1, col_tot_len, IX_NO_PAGE, IX_NO_PAGE);
+        for(int i = 0; i < col_num; ++i) {
+            fhdr->col_types_.push_back(index_cols[i].type);
+            fhdr->col_lens_.push_back(index_cols[i].len);
+        }
+        fhdr->is_normalized_ = true;
+        fhdr->is_art_ = true;
+        fhdr->update_tot_len();
+
+        // 打开索引时按整页读取文件头，这里写满一页
+        char page_buf[PAGE_SIZE];
+        memset(page_buf, 0, PAGE_SIZE);
+        fhdr->serialize(page_buf);
+        disk_manager_->write_page(fd, IX_FILE_HDR_PAGE, page_buf, PAGE_SIZE);
+        delete fhdr;
+    }
+
     void destroy_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
         std::string ix_name = get_index_name(filename, index_cols);
         disk_manager_->destroy_file(ix_name);
@@ -161,12 +245,27 @@ class IxManager {
         return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
     }
 
+    std::unique_ptr<IxIndexHandle> open_index_file(const std::string &ix_name) {
+        int fd = disk_manager_->open_file(ix_name);
+        return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
+    }
+
     void close_index(const IxIndexHandle *ih) {
         char* data = new char[ih->file_hdr_->tot_len_];
         ih->file_hdr_->serialize(data);
         disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data, ih->file_hdr_->tot_len_);
+        // 释放常驻缓冲池的内部结点，否则这些页面关闭文件之后仍然占用缓冲池
+        ih->unpin_inner_cache();
         // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
         buffer_pool_manager_->flush_all_pages(ih->fd_);
         disk_manager_->close_file(ih->fd_);
     }
+
+    /**
+     * @brief 关闭索引文件并把它的页面从缓冲池中删除，之后fd可能分配给别的文件，缓冲池中不能留下这个fd的页面
+     */
+    void close_and_evict_index(const IxIndexHandle *ih) {
+        close_index(ih);
+        buffer_pool_manager_->delete_all_pages(ih->fd_);
+    }
 };
\ No newline at end of file
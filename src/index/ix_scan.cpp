@@ -11,26 +11,149 @@ See the Mulan PSL v2 for more details. */
 #include "ix_scan.h"
 
 /**
- * @brief 
- * @todo 加上读锁（需要使用缓冲池得到page）
+ * @brief 移动到下一个键值对，当前叶子读完之后再读取后面第一个非空叶子
  */
 void IxScan::next() {
     assert(!is_end());
-    IxNodeHandle *node = ih_->fetch_node(iid_.page_no);
-    assert(node->is_leaf_page());
-    assert(iid_.slot_no < node->get_size());
+    if(reverse_) {
+        iid_.slot_no--;
+        pos_++;
+        if(pos_ < rids_.size()) {
+            return;
+        }
+        if(iid_.page_no == begin_.page_no || prev_leaf_ == IX_LEAF_HEADER_PAGE) {
+            iid_ = end_;
+            return;
+        }
+        load_leaf_reverse(prev_leaf_, -1, iid_.page_no);
+        return;
+    }
     // increment slot no
     iid_.slot_no++;
-    if (iid_.page_no != ih_->file_hdr_->last_leaf_ && iid_.slot_no == node->get_size()) {
-        // go to next leaf
-        iid_.slot_no = 0;
-        iid_.page_no = node->get_next_leaf();
+    pos_++;
+    if(pos_ < rids_.size() || is_end()) {
+        return;
+    }
+    // go to next non-empty leaf
+    if(iid_.slot_no >= leaf_size_ && iid_.page_no != ih_->file_hdr_->last_leaf_) {
+        iid_ = ih_->skip_empty_leaves({.page_no = next_leaf_, .slot_no = 0});
     }
-    // 增加unpin 和delete
-    bpm_->unpin_page(node->get_page_id(), false);
-    delete node;
+    load_leaf();
 }
 
 Rid IxScan::rid() const {
-    return ih_->get_rid(iid_);
-}
\ No newline at end of file
+    assert(pos_ < rids_.size());
+    return rids_[pos_];
+}
+
+const char *IxScan::key() const {
+    assert(with_keys_ && pos_ < rids_.size());
+    return keys_.data() + pos_ * ih_->file_hdr_->col_tot_len_;
+}
+
+/**
+ * @brief 在读锁保护下复制iid_所在叶子中剩余的rid，到end_为止
+ * 叶子在定位之后被其它事务删空时，继续读取后面的叶子
+ */
+void IxScan::load_leaf() {
+    rids_.clear();
+    keys_.clear();
+    pos_ = 0;
+    int key_len = ih_->file_hdr_->col_tot_len_;
+    while(!is_end()) {
+        IxNodeHandle *node = ih_->fetch_node(iid_.page_no);
+        node->page->RLatch();
+        assert(node->is_leaf_page());
+        leaf_size_ = node->get_size();
+        next_leaf_ = node->get_next_leaf();
+        int end_slot = iid_.page_no == end_.page_no ? std::min(end_.slot_no, leaf_size_) : leaf_size_;
+        for(int slot = iid_.slot_no; slot < end_slot; slot++) {
+            rids_.push_back(*node->get_rid(slot));
+        }
+        if(with_keys_ && end_slot > iid_.slot_no) {
+            keys_.resize((size_t)(end_slot - iid_.slot_no) * key_len);
+            char *dst = keys_.data();
+            for(int slot = iid_.slot_no; slot < end_slot; slot++, dst += key_len) {
+                copy_key(node, slot, dst);
+            }
+        }
+        node->page->RUnlatch();
+        bpm_->unpin_page(node->get_page_id(), false);
+        delete node;
+
+        if(!rids_.empty()) {
+            return;
+        }
+        if(iid_.page_no == end_.page_no || iid_.page_no == ih_->file_hdr_->last_leaf_) {
+            iid_ = end_;
+            return;
+        }
+        iid_ = {.page_no = next_leaf_, .slot_no = 0};
+    }
+}
+
+/**
+ * @brief 反向遍历时在读锁保护下复制page_no中[lower, end_slot)的rid，按从大到小的顺序保存
+ * end_slot为-1时表示从叶子末尾开始；from_page是上一片叶子，前驱在读取prev_leaf之后分裂过时，
+ * 它的next_leaf不再指向from_page，需要沿next_leaf向右找到真正的前驱
+ */
+void IxScan::load_leaf_reverse(page_id_t page_no, int end_slot, page_id_t from_page) {
+    rids_.clear();
+    keys_.clear();
+    pos_ = 0;
+    int key_len = ih_->file_hdr_->col_tot_len_;
+    while(true) {
+        IxNodeHandle *node = ih_->fetch_node(page_no);
+        node->page->RLatch();
+        assert(node->is_leaf_page());
+        leaf_size_ = node->get_size();
+        next_leaf_ = node->get_next_leaf();
+        prev_leaf_ = node->get_prev_leaf();
+        if(from_page != IX_NO_PAGE && next_leaf_ != from_page && next_leaf_ != IX_LEAF_HEADER_PAGE &&
+           page_no != begin_.page_no) {
+            node->page->RUnlatch();
+            bpm_->unpin_page(node->get_page_id(), false);
+            delete node;
+            page_no = next_leaf_;
+            continue;
+        }
+        int hi = end_slot < 0 ? leaf_size_ : std::min(end_slot, leaf_size_);
+        int lo = page_no == begin_.page_no ? begin_.slot_no : 0;
+        for(int slot = hi - 1; slot >= lo; slot--) {
+            rids_.push_back(*node->get_rid(slot));
+        }
+        if(with_keys_ && hi > lo) {
+            keys_.resize((size_t)(hi - lo) * key_len);
+            char *dst = keys_.data();
+            for(int slot = hi - 1; slot >= lo; slot--, dst += key_len) {
+                copy_key(node, slot, dst);
+            }
+        }
+        node->page->RUnlatch();
+        bpm_->unpin_page(node->get_page_id(), false);
+        delete node;
+
+        if(!rids_.empty()) {
+            iid_ = {.page_no = page_no, .slot_no = hi - 1};
+            return;
+        }
+        if(page_no == begin_.page_no || prev_leaf_ == IX_LEAF_HEADER_PAGE) {
+            iid_ = end_;
+            return;
+        }
+        from_page = page_no;
+        page_no = prev_leaf_;
+        end_slot = -1;
+    }
+}
+
+/**
+ * @brief 复制slot处的key，编码索引还原成record格式
+ */
+void IxScan::copy_key(IxNodeHandle *node, int slot, char *dst) const {
+    if(ih_->file_hdr_->is_normalized_) {
+        ix_decode_key(ih_->file_hdr_, node->get_key(slot), dst);
+    } else {
+        memcpy(dst, node->get_key(slot), ih_->file_hdr_->col_tot_len_);
+    }
+}
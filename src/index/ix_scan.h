@@ -17,16 +17,41 @@ See the Mulan PSL v2 for more details. */
 
 // 用于遍历叶子结点
 // 用于直接遍历叶子结点，而不用findleafpage来得到叶子结点
-// TODO：对page遍历时，要加上读锁
+// 每次进入一片叶子时加读锁，把这片叶子中[iid_, 叶子末尾或end_)的rid复制出来后立即释放读锁，
+// 之后逐个返回，一次只缓存一片叶子，不会在上层处理记录期间持有索引的锁
+// reverse时从upper的前一个键值对开始沿prev_leaf向前遍历到lower，用于order by desc
 class IxScan : public RecScan {
     const IxIndexHandle *ih_;
     Iid iid_;  // 初始为lower（用于遍历的指针）
     Iid end_;  // 初始为upper
     BufferPoolManager *bpm_;
 
+    std::vector<Rid> rids_;     // 当前叶子中从iid_开始的rid
+    size_t pos_;                // iid_对应rids_中的下标
+    int leaf_size_;             // 读取时当前叶子中的键值对数量
+    page_id_t next_leaf_;       // 读取时当前叶子的后继
+    page_id_t prev_leaf_;       // 读取时当前叶子的前驱
+
+    bool reverse_;              // 是否反向遍历
+    Iid begin_;                 // 反向遍历时的终点lower，end_保存upper
+
+    bool with_keys_;            // 是否同时复制key，index-only扫描时直接用key构造元组
+    std::vector<char> keys_;    // 和rids_一一对应的key，已经还原成record格式
+
    public:
-    IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm)
-        : ih_(ih), iid_(lower), end_(upper), bpm_(bpm) {}
+    IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm, bool with_keys = false,
+           bool reverse = false)
+        : ih_(ih), iid_(lower), end_(upper), bpm_(bpm), reverse_(reverse), begin_(lower), with_keys_(with_keys) {
+        if(!reverse_) {
+            load_leaf();
+        } else if(lower == upper) {
+            iid_ = end_;
+            rids_.clear();
+            pos_ = 0;
+        } else {
+            load_leaf_reverse(end_.page_no, end_.slot_no, IX_NO_PAGE);
+        }
+    }
 
     void next() override;
 
@@ -34,5 +59,15 @@ class IxScan : public RecScan {
 
     Rid rid() const override;
 
+    // 当前位置的key，只有with_keys时可用
+    const char *key() const;
+
     const Iid &iid() const { return iid_; }
+
+   private:
+    void load_leaf();
+
+    void load_leaf_reverse(page_id_t page_no, int end_slot, page_id_t from_page);
+
+    void copy_key(IxNodeHandle *node, int slot, char *dst) const;
 };
\ No newline at end of file
@@ -43,6 +43,15 @@ class Optimizer {
         } else if (auto x = std::dynamic_pointer_cast<ast::ShowIndex>(query->parse)) {
             // 增加show index
             return std::make_shared<OtherPlan>(T_ShowIndex, x->tab_name);
+        } else if (auto x = std::dynamic_pointer_cast<ast::ShowIndexStats>(query->parse)) {
+            // show index stats table;
+            return std::make_shared<OtherPlan>(T_ShowIndexStats, x->tab_name);
+        } else if (auto x = std::dynamic_pointer_cast<ast::Vacuum>(query->parse)) {
+            // vacuum table;
+            return std::make_shared<OtherPlan>(T_Vacuum, x->tab_name);
+        } else if (auto x = std::dynamic_pointer_cast<ast::Reindex>(query->parse)) {
+            // reindex table;
+            return std::make_shared<OtherPlan>(T_Reindex, x->tab_name);
         } else if (auto x = std::dynamic_pointer_cast<ast::DescTable>(query->parse)) {
             // desc table;
             return std::make_shared<OtherPlan>(T_DescTable, x->tab_name);
@@ -24,6 +24,7 @@ typedef enum PlanTag{
     T_Help,
     T_ShowTable,
     T_ShowIndex, // 增加show index
+    T_ShowIndexStats,
     T_DescTable,
     T_CreateTable,
     T_DropTable,
@@ -35,6 +36,8 @@ typedef enum PlanTag{
     T_Aggre,  // 增加Aggregation
     T_LoadData, //增加LoadData
     T_OutputOff, // 增加output off
+    T_Vacuum, // 增加vacuum
+    T_Reindex,
     T_select,
     T_Transaction_begin,
     T_Transaction_commit,
@@ -43,6 +46,7 @@ typedef enum PlanTag{
     T_SeqScan,
     T_IndexScan,
     T_IndexModeOneScan,
+    T_HashIndexScan,
     T_NestLoop,
     T_Sort,
     T_Projection
@@ -81,6 +85,12 @@ class ScanPlan : public Plan
         std::vector<std::string> index_col_names_;
         // 增加的变量Index_meta
         IndexMeta index_meta_;
+        // 索引顺序已经满足order by时下推的limit，-1表示没有limit
+        int limit_ = -1;
+        // 输出和过滤的字段都被索引覆盖时只扫描索引，不读表
+        bool index_only_ = false;
+        // 用反向的索引扫描满足order by desc
+        bool reverse_ = false;
 };
 
 class JoinPlan : public Plan
@@ -168,6 +178,9 @@ class DMLPlan : public Plan
         // 只有聚合算子能用到
         AggreMeta aggre_meta_;
         std::vector<TabCol> output_col_;
+        // MIN/MAX直接取索引区间的端点时为true，此时没有subplan_
+        bool index_endpoint_ = false;
+        IndexMeta index_meta_;
 
         // 只有load算子能用到
         std::string file_path_;
@@ -188,6 +201,12 @@ class DDLPlan : public Plan
         std::string tab_name_;
         std::vector<std::string> tab_col_names_;
         std::vector<ColDef> cols_;
+        bool is_pax_ = false;   // create table是否使用PAX页面布局
+        bool is_blink_ = false; // create index是否建立B-link树
+        bool is_hash_ = false;  // create index是否建立哈希索引
+        bool is_art_ = false;   // create index是否建立内存中的ART索引
+        bool is_lazy_delete_ = false;   // create index的B+树删除时是否不合并结点
+        int fill_factor_ = IX_DEFAULT_FILL_FACTOR;  // create index的填充率(%)
 };
 
 // help; show tables; desc tables; begin; abort; commit; rollback语句对应的plan
@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #include "planner.h"
 
 #include <memory>
+#include <set>
 
 #include "execution/executor_delete.h"
 #include "execution/executor_index_scan.h"
@@ -33,6 +34,25 @@ std::pair<int, IndexMeta> Planner::get_index_cols(std::string tab_name, std::vec
             index_col_names.push_back(cond.lhs_col.col_name);
     }
     TabMeta& tab = sm_manager_->db_.get_table(tab_name);
+
+    // 哈希索引或ART索引的每个字段都有等值条件时直接点查，mode = 2
+    for(auto &index : tab.indexes) {
+        if(!index.is_hash && !index.is_art) {
+            continue;
+        }
+        bool all_eq = true;
+        for(auto &col : index.cols) {
+            bool has_eq = false;
+            for(auto &cond : curr_conds) {
+                has_eq |= cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.tab_name == tab_name &&
+                          cond.lhs_col.col_name == col.name;
+            }
+            all_eq &= has_eq;
+        }
+        if(all_eq) {
+            return {2, index};
+        }
+    }
     
     // return tab.is_index(index_col_names);
     return tab.have_index(index_col_names);
@@ -225,12 +245,24 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> query)
             auto index_scan = std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, tables[i], curr_conds, index_col_names);
             // 将找到的最匹配的索引赋给index_scan plan
             index_scan->index_meta_ = index_meta;
+            // 单表查询中投影列、排序列和条件都在索引中时，只扫描索引
+            if(tables.size() == 1) {
+                std::vector<TabCol> used_cols = query->cols;
+                for(auto &order : x->orders) {
+                    used_cols.push_back({.tab_name = tables[i], .col_name = order->cols->col_name});
+                }
+                index_scan->index_only_ = index_covers(index_meta, curr_conds, used_cols);
+            }
             table_scan_executors[i] = index_scan;
         } else if(index_mode == 1) {
             auto index_scan = std::make_shared<ScanPlan>(T_IndexModeOneScan, sm_manager_, tables[i], curr_conds, index_col_names);
             // 将找到的最匹配的索引赋给index_scan plan
             index_scan->index_meta_ = index_meta;
             table_scan_executors[i] = index_scan;
+        } else if(index_mode == 2) {  // 哈希索引或ART索引等值查找
+            auto index_scan = std::make_shared<ScanPlan>(T_HashIndexScan, sm_manager_, tables[i], curr_conds, index_col_names);
+            index_scan->index_meta_ = index_meta;
+            table_scan_executors[i] = index_scan;
         }
     }
     // 只有一个表，不需要join。
@@ -353,9 +385,130 @@ std::shared_ptr<Plan> Planner::generate_sort_plan(std::shared_ptr<Query> query,
     //     if(col.name.compare(x->order->cols->col_name) == 0 )
     //     sel_col = {.tab_name = col.tab_name, .col_name = col.name};
     // }
+
+    // 索引扫描输出的顺序（正向或反向）已经满足order by时不需要排序，limit直接下推到索引扫描
+    if(auto scan = std::dynamic_pointer_cast<ScanPlan>(plan)) {
+        if(index_satisfies_order(scan, order_cols)) {
+            scan->limit_ = x->limit;
+            scan->reverse_ = order_cols[0].is_desc;
+            return plan;
+        }
+    }
     return std::make_shared<SortPlan>(T_Sort, std::move(plan), order_cols, x->limit);
 }
 
+/**
+ * @brief 判断索引是否覆盖了扫描用到的所有字段
+ * 条件必须都是和常量比较的单表条件，cols中的字段都要在索引中
+ */
+bool Planner::index_covers(const IndexMeta &index_meta, const std::vector<Condition> &conds, const std::vector<TabCol> &cols)
+{
+    auto in_index = [&](const std::string &col_name) {
+        for(auto &col : index_meta.cols) {
+            if(col.name == col_name) {
+                return true;
+            }
+        }
+        return false;
+    };
+    for(auto &cond : conds) {
+        if(!cond.is_rhs_val || cond.lhs_col.tab_name != index_meta.tab_name || !in_index(cond.lhs_col.col_name)) {
+            return false;
+        }
+    }
+    for(auto &col : cols) {
+        if(col.tab_name != index_meta.tab_name || !in_index(col.col_name)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 寻找能直接用区间端点回答MIN/MAX(col)的B+树索引
+ * 要求col是索引的第k列，前k列都有等值条件，其余条件只能是col上的范围条件；
+ * 这样满足条件的key在索引中连续且按col有序，MIN/MAX就是区间第一个/最后一个key中col的值
+ */
+bool Planner::get_endpoint_index(const std::string &tab_name, const std::vector<Condition> &conds, const TabCol &col,
+                                 IndexMeta *index_meta)
+{
+    TabMeta &tab = sm_manager_->db_.get_table(tab_name);
+    for(auto &index : tab.indexes) {
+        if(index.is_hash || index.is_art) {
+            continue;
+        }
+        size_t k = 0;
+        while(k < index.cols.size() && index.cols[k].name != col.col_name) {
+            k++;
+        }
+        if(k == index.cols.size()) {
+            continue;
+        }
+        auto is_prefix = [&](const std::string &col_name) {
+            for(size_t i = 0; i < k; i++) {
+                if(index.cols[i].name == col_name) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        bool ok = true;
+        std::set<std::string> eq_cols;
+        for(auto &cond : conds) {
+            if(!cond.is_rhs_val || cond.lhs_col.tab_name != tab_name) {
+                ok = false;
+            } else if(cond.op == OP_EQ && is_prefix(cond.lhs_col.col_name)) {
+                eq_cols.insert(cond.lhs_col.col_name);
+            } else if(cond.op == OP_NE || cond.lhs_col.col_name != col.col_name) {
+                ok = false;
+            }
+        }
+        if(ok && eq_cols.size() == k) {
+            *index_meta = index;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 判断索引扫描的输出顺序是否满足order by
+ * 要求排序键的方向相同，并且依次对应索引的第k..k+m-1列，前k列都有等值条件；全部降序时反向扫描索引
+ */
+bool Planner::index_satisfies_order(std::shared_ptr<ScanPlan> scan, const std::vector<OrderByCol> &order_cols)
+{
+    if(scan->tag != T_IndexScan || order_cols.empty()) {
+        return false;
+    }
+    auto &index_cols = scan->index_meta_.cols;
+    auto has_eq_cond = [&](const ColMeta &col) {
+        for(auto &cond : scan->conds_) {
+            if(cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.tab_name == scan->tab_name_ &&
+               cond.lhs_col.col_name == col.name) {
+                return true;
+            }
+        }
+        return false;
+    };
+    size_t k = 0;
+    while(k < index_cols.size() && index_cols[k].name != order_cols[0].tabcol.col_name) {
+        if(!has_eq_cond(index_cols[k])) {
+            return false;
+        }
+        k++;
+    }
+    if(k + order_cols.size() > index_cols.size()) {
+        return false;
+    }
+    for(size_t i = 0; i < order_cols.size(); i++) {
+        if(order_cols[i].is_desc != order_cols[0].is_desc || order_cols[i].tabcol.tab_name != scan->tab_name_ ||
+           order_cols[i].tabcol.col_name != index_cols[k + i].name) {
+            return false;
+        }
+    }
+    return true;
+}
+
 
 /**
  * @brief select plan 生成
@@ -388,19 +541,30 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
             if (auto sv_col_def = std::dynamic_pointer_cast<ast::ColDef>(field)) {
                 ColDef col_def = {.name = sv_col_def->col_name,
                                   .type = interp_sv_type(sv_col_def->type_len->type),
-                                  .len = sv_col_def->type_len->len};
+                                  .len = sv_col_def->type_len->len,
+                                  .dict = sv_col_def->is_dict};
                 col_defs.push_back(col_def);
             } else {
                 throw InternalError("Unexpected field type");
             }
         }
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateTable, x->tab_name, std::vector<std::string>(), col_defs);
+        auto ddl_plan = std::make_shared<DDLPlan>(T_CreateTable, x->tab_name, std::vector<std::string>(), col_defs);
+        ddl_plan->is_pax_ = x->is_pax;
+        plannerRoot = ddl_plan;
     } else if (auto x = std::dynamic_pointer_cast<ast::DropTable>(query->parse)) {
         // drop table;
         plannerRoot = std::make_shared<DDLPlan>(T_DropTable, x->tab_name, std::vector<std::string>(), std::vector<ColDef>());
     } else if (auto x = std::dynamic_pointer_cast<ast::CreateIndex>(query->parse)) {
         // create index;
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+        auto ddl_plan = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+        ddl_plan->is_blink_ = x->is_blink;
+        ddl_plan->is_hash_ = x->is_hash;
+        ddl_plan->is_art_ = x->is_art;
+        ddl_plan->is_lazy_delete_ = x->is_lazy_delete;
+        if(x->has_fill_factor) {
+            ddl_plan->fill_factor_ = x->fill_factor;
+        }
+        plannerRoot = ddl_plan;
     } else if (auto x = std::dynamic_pointer_cast<ast::DropIndex>(query->parse)) {
         // drop index
         plannerRoot = std::make_shared<DDLPlan>(T_DropIndex, x->tab_name, x->col_names, std::vector<ColDef>());
@@ -437,6 +601,10 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
             // 将找到的最匹配的索引赋给index_scan plan
             index_scan->index_meta_ = index_meta;
             table_scan_executors = index_scan;
+        } else if(index_mode == 2) {  // 哈希索引或ART索引等值查找
+            auto index_scan = std::make_shared<ScanPlan>(T_HashIndexScan, sm_manager_, x->tab_name, query->conds, index_col_names);
+            index_scan->index_meta_ = index_meta;
+            table_scan_executors = index_scan;
         }
 
         plannerRoot = std::make_shared<DMLPlan>(T_Delete, table_scan_executors, x->tab_name,  
@@ -463,6 +631,10 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
             // 将找到的最匹配的索引赋给index_scan plan
             index_scan->index_meta_ = index_meta;
             table_scan_executors = index_scan;
+        } else if(index_mode == 2) {  // 哈希索引或ART索引等值查找
+            auto index_scan = std::make_shared<ScanPlan>(T_HashIndexScan, sm_manager_, x->tab_name, query->conds, index_col_names);
+            index_scan->index_meta_ = index_meta;
+            table_scan_executors = index_scan;
         }
 
         plannerRoot = std::make_shared<DMLPlan>(T_Update, table_scan_executors, x->tab_name,
@@ -470,6 +642,21 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
                                                      query->set_clauses);
     } else if (auto x = std::dynamic_pointer_cast<ast::AggreStmt>(query->parse)){
         // aggre
+        // MIN/MAX的字段在索引中且前面的字段都是等值条件时，只需要定位索引区间的一端，不扫描表
+        IndexMeta endpoint_index;
+        if((query->aggre_meta.op_ == AG_MIN || query->aggre_meta.op_ == AG_MAX) &&
+           get_endpoint_index(x->tab_name, query->conds, query->aggre_meta.tabcol_, &endpoint_index)) {
+            ColType type = sm_manager_->db_.get_table(x->tab_name).get_col(query->aggre_meta.tabcol_.col_name)->type;
+            if(type == TYPE_INT || type == TYPE_FLOAT || type == TYPE_STRING) {
+                auto aggre_plan = std::make_shared<DMLPlan>(T_Aggre, nullptr, x->tab_name, std::vector<Value>(),
+                                                            query->conds, std::vector<SetClause>());
+                aggre_plan->aggre_meta_ = query->aggre_meta;
+                aggre_plan->output_col_ = query->cols;
+                aggre_plan->index_endpoint_ = true;
+                aggre_plan->index_meta_ = endpoint_index;
+                return aggre_plan;
+            }
+        }
         // 生成表扫描方式
         std::shared_ptr<Plan> table_scan_executors;
         // 只有一张表，不需要进行物理优化了
@@ -483,6 +670,10 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
             auto index_scan = std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, x->tab_name, query->conds, index_col_names);
             // 将找到的最匹配的索引赋给index_scan plan
             index_scan->index_meta_ = index_meta;
+            // count只需要满足条件的rid个数，条件都在索引中时不用读表
+            if(query->aggre_meta.op_ == AG_COUNT) {
+                index_scan->index_only_ = index_covers(index_meta, query->conds, {});
+            }
             table_scan_executors = index_scan;
 
             // // 优化点：如果是MAX或者MIN算子，并且发现用索引扫描，那么可以用
@@ -509,6 +700,10 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
             // 将找到的最匹配的索引赋给index_scan plan
             index_scan->index_meta_ = index_meta;
             table_scan_executors = index_scan;
+        } else if(index_mode == 2) {  // 哈希索引或ART索引等值查找
+            auto index_scan = std::make_shared<ScanPlan>(T_HashIndexScan, sm_manager_, x->tab_name, query->conds, index_col_names);
+            index_scan->index_meta_ = index_meta;
+            table_scan_executors = index_scan;
         }
         auto aggre_plan = std::make_shared<DMLPlan>(T_Aggre, table_scan_executors, x->tab_name,  
                                                 std::vector<Value>(), query->conds, std::vector<SetClause>());
@@ -43,6 +43,13 @@ class Planner {
     std::shared_ptr<Plan> make_one_rel(std::shared_ptr<Query> query);
 
     std::shared_ptr<Plan> generate_sort_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan);
+
+    bool index_covers(const IndexMeta &index_meta, const std::vector<Condition> &conds, const std::vector<TabCol> &cols);
+
+    bool index_satisfies_order(std::shared_ptr<ScanPlan> scan, const std::vector<OrderByCol> &order_cols);
+
+    bool get_endpoint_index(const std::string &tab_name, const std::vector<Condition> &conds, const TabCol &col,
+                            IndexMeta *index_meta);
     
     std::shared_ptr<Plan> generate_select_plan(std::shared_ptr<Query> query, Context *context);
 
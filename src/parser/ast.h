@@ -62,6 +62,27 @@ struct ShowIndex : public TreeNode {
     ShowIndex(std::string tab_name_) : tab_name(std::move(tab_name_)) {}
 };
 
+// 显示表上各个索引的统计信息
+struct ShowIndexStats : public TreeNode {
+    std::string tab_name;
+
+    ShowIndexStats(std::string tab_name_) : tab_name(std::move(tab_name_)) {}
+};
+
+// 整理表的数据文件
+struct Vacuum : public TreeNode {
+    std::string tab_name;
+
+    Vacuum(std::string tab_name_) : tab_name(std::move(tab_name_)) {}
+};
+
+// 重建表上的所有索引
+struct Reindex : public TreeNode {
+    std::string tab_name;
+
+    Reindex(std::string tab_name_) : tab_name(std::move(tab_name_)) {}
+};
+
 struct TxnBegin : public TreeNode {
 };
 
@@ -87,17 +108,19 @@ struct Field : public TreeNode {
 struct ColDef : public Field {
     std::string col_name;
     std::shared_ptr<TypeLen> type_len;
+    bool is_dict;   // 是否使用字典编码
 
-    ColDef(std::string col_name_, std::shared_ptr<TypeLen> type_len_) :
-            col_name(std::move(col_name_)), type_len(std::move(type_len_)) {}
+    ColDef(std::string col_name_, std::shared_ptr<TypeLen> type_len_, bool is_dict_ = false) :
+            col_name(std::move(col_name_)), type_len(std::move(type_len_)), is_dict(is_dict_) {}
 };
 
 struct CreateTable : public TreeNode {
     std::string tab_name;
     std::vector<std::shared_ptr<Field>> fields;
+    bool is_pax;    // 是否使用PAX页面布局
 
-    CreateTable(std::string tab_name_, std::vector<std::shared_ptr<Field>> fields_) :
-            tab_name(std::move(tab_name_)), fields(std::move(fields_)) {}
+    CreateTable(std::string tab_name_, std::vector<std::shared_ptr<Field>> fields_, bool is_pax_ = false) :
+            tab_name(std::move(tab_name_)), fields(std::move(fields_)), is_pax(is_pax_) {}
 };
 
 struct DropTable : public TreeNode {
@@ -115,9 +138,17 @@ struct DescTable : public TreeNode {
 struct CreateIndex : public TreeNode {
     std::string tab_name;
     std::vector<std::string> col_names;
-
-    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_) :
-            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
+    bool is_blink;  // 是否建立B-link树索引
+    bool is_hash;   // 是否建立哈希索引
+    bool has_fill_factor;   // 是否指定了FILLFACTOR，没有指定时使用默认值
+    int fill_factor;        // FILLFACTOR指定的填充率(%)
+    bool is_art;    // 是否建立内存中的ART索引
+    bool is_lazy_delete;    // B+树删除时是否只修改叶子结点，不合并结点
+
+    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_, bool is_blink_ = false, bool is_hash_ = false,
+                bool has_fill_factor_ = false, int fill_factor_ = 0, bool is_art_ = false, bool is_lazy_delete_ = false) :
+            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)), is_blink(is_blink_), is_hash(is_hash_),
+            has_fill_factor(has_fill_factor_), fill_factor(fill_factor_), is_art(is_art_), is_lazy_delete(is_lazy_delete_) {}
 };
 
 struct DropIndex : public TreeNode {
@@ -23,7 +23,7 @@ using namespace ast;
 // keywords
 %token SHOW TABLES CREATE TABLE DROP LOAD DESC INSERT INTO VALUES DELETE FROM ASC ORDER BY
 WHERE UPDATE SET SELECT INT BIGINT CHAR FLOAT DATETIME INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_COMMIT TXN_ABORT TXN_ROLLBACK ORDER_BY LIMIT AS
-SUM COUNT MAX MIN OUTPUT_FILE OFF
+SUM COUNT MAX MIN OUTPUT_FILE OFF VACUUM USING PAX DICT BLINK REINDEX HASH FILLFACTOR STATS ART LAZY
 // non-keywords
 %token LEQ NEQ GEQ T_EOF
 
@@ -124,6 +124,21 @@ dbStmt:
     {
         $$ = std::make_shared<ShowIndex>($4);
     }
+    |
+        SHOW INDEX STATS tbName
+    {
+        $$ = std::make_shared<ShowIndexStats>($4);
+    }
+    |
+        VACUUM tbName
+    {
+        $$ = std::make_shared<Vacuum>($2);
+    }
+    |
+        REINDEX tbName
+    {
+        $$ = std::make_shared<Reindex>($2);
+    }
     ;
 
 ddl:
@@ -131,6 +146,10 @@ ddl:
     {
         $$ = std::make_shared<CreateTable>($3, $5);
     }
+    |   CREATE TABLE tbName '(' fieldList ')' USING PAX
+    {
+        $$ = std::make_shared<CreateTable>($3, $5, true);
+    }
     |   DROP TABLE tbName
     {
         $$ = std::make_shared<DropTable>($3);
@@ -143,6 +162,34 @@ ddl:
     {
         $$ = std::make_shared<CreateIndex>($3, $5);
     }
+    |   CREATE INDEX tbName '(' colNameList ')' FILLFACTOR VALUE_INT
+    {
+        $$ = std::make_shared<CreateIndex>($3, $5, false, false, true, $8);
+    }
+    |   CREATE INDEX tbName '(' colNameList ')' LAZY DELETE
+    {
+        $$ = std::make_shared<CreateIndex>($3, $5, false, false, false, 0, false, true);
+    }
+    |   CREATE INDEX tbName '(' colNameList ')' FILLFACTOR VALUE_INT LAZY DELETE
+    {
+        $$ = std::make_shared<CreateIndex>($3, $5, false, false, true, $8, false, true);
+    }
+    |   CREATE INDEX tbName '(' colNameList ')' USING BLINK
+    {
+        $$ = std::make_shared<CreateIndex>($3, $5, true);
+    }
+    |   CREATE INDEX tbName '(' colNameList ')' USING BLINK FILLFACTOR VALUE_INT
+    {
+        $$ = std::make_shared<CreateIndex>($3, $5, true, false, true, $10);
+    }
+    |   CREATE INDEX tbName '(' colNameList ')' USING HASH
+    {
+        $$ = std::make_shared<CreateIndex>($3, $5, false, true);
+    }
+    |   CREATE INDEX tbName '(' colNameList ')' USING ART
+    {
+        $$ = std::make_shared<CreateIndex>($3, $5, false, false, false, 0, true);
+    }
     |   DROP INDEX tbName '(' colNameList ')'
     {
         $$ = std::make_shared<DropIndex>($3, $5);
@@ -204,6 +251,10 @@ field:
     {
         $$ = std::make_shared<ColDef>($1, $2);
     }
+    |   colName type DICT
+    {
+        $$ = std::make_shared<ColDef>($1, $2, true);
+    }
     ;
 
 type:
@@ -490,6 +541,7 @@ opt_asc_desc:
     |       { $$ = OrderBy_DEFAULT; }
     ;    
 
+
 tbName: IDENTIFIER;
 
 filePath: VALUE_FILEPATH;
@@ -27,6 +27,7 @@ See the Mulan PSL v2 for more details. */
 #include "execution/execution_aggregation.h"
 #include "execution/execution_load_data.h"
 #include "execution/execution_index_scan_mode1.h"
+#include "execution/executor_hash_index_scan.h"
 #include "common/common.h"
 
 typedef enum portalTag{
@@ -119,6 +120,11 @@ class Portal
 
                 case T_Aggre:
                 {
+                    if(x->index_endpoint_) {
+                        std::unique_ptr<AbstractExecutor> root = std::make_unique<AggregationExecutor>(sm_manager_,
+                                                                x->tab_name_, x->conds_, x->aggre_meta_, x->index_meta_, context);
+                        return std::make_shared<PortalStmt>(PORTAL_ONE_SELECT, std::move(x->output_col_), std::move(root), plan);
+                    }
                     std::unique_ptr<AbstractExecutor> scan= convert_plan_executor(x->subplan_, context);
                     std::vector<Rid> rids;
                     for (scan->beginTuple(); !scan->is_end(); scan->nextTuple()) {
@@ -187,7 +193,10 @@ class Portal
             }
             else if(x->tag == T_IndexScan){
                 // 索引扫描
-                return std::make_unique<IndexScanExecutor>(sm_manager_, x->tab_name_, x->conds_, x->index_col_names_, x->index_meta_, context);
+                return std::make_unique<IndexScanExecutor>(sm_manager_, x->tab_name_, x->conds_, x->index_col_names_, x->index_meta_, context, x->limit_, x->index_only_, x->reverse_);
+            } else if(x->tag == T_HashIndexScan) {
+                // 哈希索引等值查找
+                return std::make_unique<HashIndexScanExecutor>(sm_manager_, x->tab_name_, x->conds_, x->index_meta_, context);
             } else {
                 // Mode = 1
                 return std::make_unique<IndexScanModeOneExecutor>(sm_manager_, x->tab_name_, x->conds_, x->index_col_names_, x->index_meta_, context);
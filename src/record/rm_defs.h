@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 
 #include <cassert>
 #include <list>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -28,14 +29,32 @@ constexpr int RM_NO_PAGE = -1;
 constexpr int RM_FILE_HDR_PAGE = 0;
 constexpr int RM_FIRST_RECORD_PAGE = 1;
 constexpr int RM_MAX_RECORD_SIZE = 512;
+constexpr int RM_MAX_FILE_COLS = 32;
+constexpr int RM_DICT_CODE_SIZE = sizeof(int);   // 字典编码字段在记录中存储的编码长度
+static const std::string RM_DICT_FILE_SUFFIX = ".dict";     // 字典文件为表数据文件名加上该后缀
+
+/* 页面内记录的组织方式 */
+enum RmPageLayout {
+    RM_LAYOUT_ROW = 0,  // 行存，每个slot存一条完整的记录
+    RM_LAYOUT_PAX = 1   // PAX，页面内每个字段占一个minipage，同一字段的值连续存放
+};
 
 /* 文件头，记录表数据文件的元信息，写入磁盘中文件的第0号页面 */
 struct RmFileHdr {
-    int record_size;            // 表中每条记录的大小，由于不包含变长字段，因此当前字段初始化后保持不变
+    int record_size;            // 每个slot中存储的记录大小，字典编码字段按编码长度计算，初始化后保持不变
     int num_pages;              // 文件中分配的页面个数（初始化为1）
     int num_records_per_page;   // 每个页面最多能存储的元组个数
     int first_free_page_no;     // 文件中当前第一个包含空闲空间的页面号（初始化为-1）
     int bitmap_size;            // 每个页面bitmap大小
+    int layout;                 // 页面布局，取值为RmPageLayout
+    int num_cols;               // PAX布局或者有字典编码字段时的字段个数，否则为0
+    int col_lens[RM_MAX_FILE_COLS]; // 每个字段解码后的长度，按照字段在记录中的offset排列
+    int dict_mask;              // 第i位为1表示第i个字段使用字典编码
+
+    bool is_dict_col(int col_idx) const { return (dict_mask >> col_idx) & 1; }
+
+    // 字段在slot中实际占用的长度
+    int stored_col_len(int col_idx) const { return is_dict_col(col_idx) ? RM_DICT_CODE_SIZE : col_lens[col_idx]; }
 };
 
 /* 表数据文件中每个页面的页头，记录每个页面的元信息 */
@@ -44,6 +63,45 @@ struct RmPageHdr {
     int num_records;        // 当前页面中当前已经存储的记录个数（初始化为0）
 };
 
+/* vacuum过程中的游标，dest_page_no从前往后找有空闲slot的页面，src_page_no从后往前找存有记录的页面 */
+struct RmVacuumCursor {
+    int dest_page_no;       // 当前搬入记录的页面号（初始化为RM_FIRST_RECORD_PAGE）
+    int src_page_no;        // 当前搬出记录的页面号（初始化为RM_NO_PAGE，第一批从文件的最后一个页面开始）
+};
+
+/* 一个字典编码字段的字典，编码就是值在values中的下标 */
+struct RmColumnDict {
+    std::vector<std::string> values;                // code -> 解码后的定长值
+    std::unordered_map<std::string, int> codes;     // 解码后的定长值 -> code
+};
+
+/* zone map中一个字段在一个页面上出现过的取值范围，INT/BIGINT/DATETIME使用int_min/int_max，FLOAT使用float_min/float_max */
+struct RmZone {
+    bool empty = true;      // 页面上还没有插入过记录
+    int64_t int_min;
+    int64_t int_max;
+    double float_min;
+    double float_max;
+};
+
+/* zone map维护的字段，只维护数值和datetime类型的字段 */
+struct RmZoneCol {
+    int offset;             // 字段在记录中的偏移
+    int len;                // 字段长度
+    ColType type;           // 字段类型
+};
+
+/* 扫描条件转换得到的字段取值范围[lo, hi]，用于判断页面是否可能有满足条件的记录 */
+struct RmZonePred {
+    int zone_col;           // zone map中字段的下标
+    bool has_lo = false;
+    bool has_hi = false;
+    int64_t int_lo = 0;
+    int64_t int_hi = 0;
+    double float_lo = 0;
+    double float_hi = 0;
+};
+
 /* 表中的记录 */
 struct RmRecord {
     char* data;  // 记录的数据
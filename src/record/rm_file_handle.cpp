@@ -10,6 +10,9 @@ See the Mulan PSL v2 for more details. */
 
 #include "rm_file_handle.h"
 
+#include <algorithm>
+#include <fstream>
+
 /**
  * @description: 获取当前表中记录号为rid的记录
  * @param {Rid&} rid 记录号，指定记录的位置
@@ -32,13 +35,17 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
     RmPageHandle page_hdl = fetch_page_handle(rid.page_no);
 
     // 2.1 初始化一个指向RmRecord的指针
-    int record_size = file_hdr_.record_size;
+    int record_size = record_size_;
     auto rm_rcd = std::make_unique<RmRecord>(record_size);
     
-    // 2.2 赋值RmRecord指针内部的data和size
-    char* data_ptr = page_hdl.get_slot(rid.slot_no);
-    // rm_rcd->data = data_ptr;
-    std::memcpy(rm_rcd->data,data_ptr,record_size);
+    // 2.2 赋值RmRecord指针内部的data和size，有字典编码字段时需要解码
+    if(file_hdr_.dict_mask == 0) {
+        page_hdl.read_record(rid.slot_no, rm_rcd->data);
+    } else {
+        char stored[file_hdr_.record_size];
+        page_hdl.read_record(rid.slot_no, stored);
+        decode_record(stored, rm_rcd->data);
+    }
     rm_rcd->size = record_size;
 
     buffer_pool_manager_->unpin_page(page_hdl.page->get_page_id(), false);
@@ -46,6 +53,79 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
     return rm_rcd;
 }
 
+/**
+ * @description: 只读取记录号为rid的记录中的一个字段，PAX布局下只访问该字段所在的minipage
+ * @param {Rid&} rid 记录号
+ * @param {int} offset 字段在记录中的偏移
+ * @param {int} len 字段长度
+ * @param {char*} dest 字段值的拷贝目标
+ * @note 不加锁，调用者需要已经持有表上的锁
+ */
+void RmFileHandle::get_field(const Rid& rid, int offset, int len, char* dest) const {
+    RmPageHandle page_hdl = fetch_page_handle(rid.page_no);
+    if(file_hdr_.num_cols == 0) {
+        std::memcpy(dest, page_hdl.get_field(rid.slot_no, offset, len), len);
+    } else {
+        // 解码后的offset转换为slot中的存储位置
+        int col_idx = std::lower_bound(col_offsets_.begin(), col_offsets_.end(), offset) - col_offsets_.begin();
+        assert(col_idx < file_hdr_.num_cols && col_offsets_[col_idx] == offset);
+        int stored_len = file_hdr_.stored_col_len(col_idx);
+        char *field = page_hdl.get_field(rid.slot_no, stored_offsets_[col_idx], stored_len);
+        if(file_hdr_.is_dict_col(col_idx)) {
+            int code = *reinterpret_cast<int *>(field);
+            std::scoped_lock lock{dict_latch_};
+            std::memcpy(dest, dicts_.at(col_idx).values[code].data(), len);
+        } else {
+            std::memcpy(dest, field, len);
+        }
+    }
+    buffer_pool_manager_->unpin_page(page_hdl.page->get_page_id(), false);
+}
+
+/**
+ * @description: 获取解码后offset处的字典编码字段下标
+ * @param {int} offset 字段在解码后记录中的偏移
+ * @return {int} 字段下标，如果该字段没有使用字典编码则返回-1
+ */
+int RmFileHandle::get_dict_col(int offset) const {
+    if(file_hdr_.dict_mask == 0) {
+        return -1;
+    }
+    auto pos = std::lower_bound(col_offsets_.begin(), col_offsets_.end(), offset);
+    if(pos == col_offsets_.end() || *pos != offset) {
+        return -1;
+    }
+    int col_idx = pos - col_offsets_.begin();
+    return file_hdr_.is_dict_col(col_idx) ? col_idx : -1;
+}
+
+/**
+ * @description: 查找字典编码字段中某个值对应的编码，不会为不存在的值分配编码
+ * @param {int} col_idx 字典编码字段的下标
+ * @param {char*} value 定长的字段值，长度为该字段的长度
+ * @return {int} 编码，如果字典中没有该值则返回-1，此时表中不存在等于该值的记录
+ */
+int RmFileHandle::lookup_code(int col_idx, const char* value) const {
+    std::scoped_lock lock{dict_latch_};
+    auto &dict = dicts_.at(col_idx);
+    auto pos = dict.codes.find(std::string(value, file_hdr_.col_lens[col_idx]));
+    return pos == dict.codes.end() ? -1 : pos->second;
+}
+
+/**
+ * @description: 判断记录号为rid的记录中字典编码字段的编码是否等于code，只读取编码，不解码整条记录
+ * @param {Rid&} rid 记录号
+ * @param {int} col_idx 字典编码字段的下标
+ * @param {int} code 要比较的编码
+ */
+bool RmFileHandle::match_code(const Rid& rid, int col_idx, int code) const {
+    RmPageHandle page_hdl = fetch_page_handle(rid.page_no);
+    char *field = page_hdl.get_field(rid.slot_no, stored_offsets_[col_idx], RM_DICT_CODE_SIZE);
+    bool result = *reinterpret_cast<int *>(field) == code;
+    buffer_pool_manager_->unpin_page(page_hdl.page->get_page_id(), false);
+    return result;
+}
+
 /**
  * @description: 在当前表中插入一条记录，不指定插入位置
  * @param {char*} buf 要插入的记录的数据
@@ -76,7 +156,6 @@ Rid RmFileHandle::insert_record(char* buf, Context* context, const std::string t
     RmPageHandle page_hdl = create_page_handle();
 
     // 2. 在page_hdl中找到空闲slot位置
-    int record_size = file_hdr_.record_size;
     int record_nums = file_hdr_.num_records_per_page;
     int slot_no = Bitmap::first_bit(false, page_hdl.bitmap, record_nums);
     if(slot_no == record_nums){ 
@@ -90,9 +169,10 @@ Rid RmFileHandle::insert_record(char* buf, Context* context, const std::string t
     }
 
     // 3. 将buf复制到空闲slot位置
-    char* slot_ptr = page_hdl.get_slot(slot_no);
-    std::memcpy(slot_ptr, buf, record_size);
+    char stored[file_hdr_.record_size];
+    page_hdl.write_record(slot_no, encode_record(buf, stored));
     Bitmap::set(page_hdl.bitmap, slot_no);
+    update_zone(page_hdl.page->get_page_id().page_no, buf);
 
     // 4. 更新page_handle.page_hdr的数据结构
     // 4.1 当插入该record以后，该页面满了，更新RmFileHdr的first_page_no
@@ -110,8 +190,8 @@ void RmFileHandle::massive_insert(const std::vector<std::unique_ptr<RmRecord>> *
         assert(rids->size() == 0);
     }
 
-    int record_size = file_hdr_.record_size;
     int record_nums = file_hdr_.num_records_per_page;
+    char stored[file_hdr_.record_size];
 
     RmPageHandle page_hdl = create_page_handle();
     for(size_t i = 0; i < records->size(); i++) {
@@ -129,9 +209,9 @@ void RmFileHandle::massive_insert(const std::vector<std::unique_ptr<RmRecord>> *
             rids->push_back(rid);
         }
         // 3. 将buf复制到空闲slot位置
-        char* slot_ptr = page_hdl.get_slot(slot_no);
-        std::memcpy(slot_ptr, (*records)[i]->data, record_size);
+        page_hdl.write_record(slot_no, encode_record((*records)[i]->data, stored));
         Bitmap::set(page_hdl.bitmap, slot_no);
+        update_zone(rid.page_no, (*records)[i]->data);
 
         // 当前page满了，取下一个page
         if(++page_hdl.page_hdr->num_records == record_nums){
@@ -169,9 +249,9 @@ void RmFileHandle::insert_record(const Rid& rid, char* buf) {
     assert(!Bitmap::is_set(page_hdl.bitmap, rid.slot_no));   
 
     // 3. 在指定位置插入记录
-    int record_size = file_hdr_.record_size;
-    char* slot_ptr = page_hdl.get_slot(rid.slot_no);
-    std::memcpy(slot_ptr, buf, record_size);
+    char stored[file_hdr_.record_size];
+    page_hdl.write_record(rid.slot_no, encode_record(buf, stored));
+    update_zone(rid.page_no, buf);
 
     // 4. 更新page_handle中的数据结构
     Bitmap::set(page_hdl.bitmap, rid.slot_no);
@@ -253,10 +333,10 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
     if(!Bitmap::is_set(page_hdl.bitmap, rid.slot_no)){
         throw RecordNotFoundError(rid.page_no,rid.slot_no);
     }
-    // 2. 更新记录
-    int record_size = file_hdr_.record_size;
-    char* slot_ptr = page_hdl.get_slot(rid.slot_no);
-    std::memcpy(slot_ptr, buf, record_size);
+    // 2. 更新记录，zone map只扩大不收缩，旧值留下的范围不影响正确性
+    char stored[file_hdr_.record_size];
+    page_hdl.write_record(rid.slot_no, encode_record(buf, stored));
+    update_zone(rid.page_no, buf);
 
     // 3. 确保bitmap标识为存有记录
     // Bitmap::set(page_hdl.bitmap,rid.slot_no);
@@ -267,6 +347,155 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
     buffer_pool_manager_->unpin_page(page_hdl.page->get_page_id(), true);
 }
 
+/**
+ * @description: 执行一批表文件的compaction，把文件尾部页面中的记录搬到前部页面的空闲slot中
+ * @param {RmVacuumCursor*} cursor 搬移游标，跨批次保存，dest_page_no >= src_page_no时表示搬移结束
+ * @param {int} max_moves 本批次最多搬移的记录个数
+ * @param {vector<pair<Rid, Rid>>*} moved 本批次搬移的记录，(旧rid, 新rid)，上层据此更新索引
+ * @param {string&} tab_name 表名称，写日志时使用
+ * @param {Context*} context 为nullptr时不写日志
+ * @return {bool} 是否还可能有需要搬移的记录
+ * @note 调用者需要持有表的X锁。批与批之间其它事务可以正常插入删除，本批结束前把被填满的页面和已经搬过的尾部页面
+ *       从空闲页面链表中摘除，避免插入落到要截断的页面上；空闲页面链表在vacuum_finish()中重建
+ */
+bool RmFileHandle::vacuum_batch(RmVacuumCursor *cursor, int max_moves, std::vector<std::pair<Rid, Rid>> *moved,
+                                const std::string &tab_name, Context *context) {
+    int record_nums = file_hdr_.num_records_per_page;
+    int moves = 0;
+    char buf[file_hdr_.record_size];
+    RmRecord rec(record_size_);
+    if(cursor->src_page_no == RM_NO_PAGE) {
+        cursor->src_page_no = file_hdr_.num_pages - 1;
+    }
+    if(cursor->dest_page_no >= cursor->src_page_no) {
+        return false;
+    }
+
+    while(moves < max_moves) {
+        // 1. 从前往后找到第一个有空闲slot的页面
+        RmPageHandle dest_hdl = fetch_page_handle(cursor->dest_page_no);
+        while(dest_hdl.page_hdr->num_records == record_nums && cursor->dest_page_no < cursor->src_page_no) {
+            buffer_pool_manager_->unpin_page(dest_hdl.page->get_page_id(), false);
+            dest_hdl = fetch_page_handle(++cursor->dest_page_no);
+        }
+        if(cursor->dest_page_no >= cursor->src_page_no) {
+            buffer_pool_manager_->unpin_page(dest_hdl.page->get_page_id(), false);
+            break;
+        }
+
+        // 2. 从后往前找到第一个存有记录的页面
+        RmPageHandle src_hdl = fetch_page_handle(cursor->src_page_no);
+        while(src_hdl.page_hdr->num_records == 0 && cursor->dest_page_no < cursor->src_page_no) {
+            buffer_pool_manager_->unpin_page(src_hdl.page->get_page_id(), false);
+            if(cursor->dest_page_no == --cursor->src_page_no) {
+                break;
+            }
+            src_hdl = fetch_page_handle(cursor->src_page_no);
+        }
+        if(cursor->dest_page_no >= cursor->src_page_no) {
+            buffer_pool_manager_->unpin_page(dest_hdl.page->get_page_id(), false);
+            break;
+        }
+
+        // 3. 在两个页面之间搬移记录，直到dest页面满了、src页面空了或者达到本批次上限
+        while(moves < max_moves && dest_hdl.page_hdr->num_records < record_nums && src_hdl.page_hdr->num_records > 0) {
+            int dest_slot = Bitmap::first_bit(false, dest_hdl.bitmap, record_nums);
+            int src_slot = Bitmap::first_bit(true, src_hdl.bitmap, record_nums);
+            src_hdl.read_record(src_slot, buf);
+            dest_hdl.write_record(dest_slot, buf);
+            Bitmap::set(dest_hdl.bitmap, dest_slot);
+            Bitmap::reset(src_hdl.bitmap, src_slot);
+            dest_hdl.page_hdr->num_records++;
+            src_hdl.page_hdr->num_records--;
+            Rid src_rid{cursor->src_page_no, src_slot};
+            Rid dest_rid{cursor->dest_page_no, dest_slot};
+            moved->emplace_back(src_rid, dest_rid);
+            moves++;
+
+            // 搬移记为一次删除加一次插入，页面还pin着的时候把两个页面的lsn更新为对应日志的lsn，
+            // 恢复时按页面lsn判断是否需要重做；日志中是解码后的记录，与其它插入删除日志一致
+            if(context != nullptr) {
+                Transaction *txn = context->txn_;
+                if(file_hdr_.dict_mask == 0) {
+                    memcpy(rec.data, buf, record_size_);
+                } else {
+                    decode_record(buf, rec.data);
+                }
+                DeleteLogRecord delete_log_rcd(txn->get_transaction_id(), rec, src_rid, tab_name);
+                delete_log_rcd.prev_lsn_ = txn->get_prev_lsn();
+                txn->set_prev_lsn(context->log_mgr_->add_log_to_buffer(&delete_log_rcd));
+                src_hdl.page->set_page_lsn(delete_log_rcd.lsn_);
+
+                InsertLogRecord insert_log_rcd(txn->get_transaction_id(), rec, dest_rid, tab_name);
+                insert_log_rcd.prev_lsn_ = txn->get_prev_lsn();
+                txn->set_prev_lsn(context->log_mgr_->add_log_to_buffer(&insert_log_rcd));
+                dest_hdl.page->set_page_lsn(insert_log_rcd.lsn_);
+            }
+        }
+
+        merge_zone(cursor->dest_page_no, cursor->src_page_no);
+        buffer_pool_manager_->unpin_page(dest_hdl.page->get_page_id(), true);
+        buffer_pool_manager_->unpin_page(src_hdl.page->get_page_id(), true);
+    }
+    unlink_free_pages(cursor->src_page_no);
+    return cursor->dest_page_no < cursor->src_page_no;
+}
+
+/**
+ * @description: vacuum结束后截断文件尾部的空页面，并按页面号从小到大重建空闲页面链表
+ * @note 调用者需要持有表的X锁。截断不写日志，之前各批搬移的日志在批事务提交时已经落盘，
+ *       恢复时重做被截掉页面上的旧日志由redo自行处理（插入补建页面，删除和更新跳过）
+ */
+void RmFileHandle::vacuum_finish() {
+    // 1. 找到最后一个非空页面
+    int num_pages = file_hdr_.num_pages;
+    while(num_pages > RM_FIRST_RECORD_PAGE) {
+        RmPageHandle page_hdl = fetch_page_handle(num_pages - 1);
+        bool is_empty = page_hdl.page_hdr->num_records == 0;
+        buffer_pool_manager_->unpin_page(page_hdl.page->get_page_id(), false);
+        if(!is_empty) {
+            break;
+        }
+        num_pages--;
+    }
+
+    // 2. 把尾部的空页面从缓冲池中删除，再截断磁盘文件
+    for(int page_no = num_pages; page_no < file_hdr_.num_pages; page_no++) {
+        buffer_pool_manager_->delete_page(PageId{fd_, page_no});
+    }
+    file_hdr_.num_pages = num_pages;
+    disk_manager_->truncate_file(fd_, num_pages);
+    {
+        std::scoped_lock lock{zone_latch_};
+        if(zones_built_ && (int)zones_.size() > num_pages) {
+            zones_.resize(num_pages);
+        }
+    }
+
+    // 3. 重建空闲页面链表
+    rebuild_free_list();
+
+    // 4. 文件头写回磁盘，避免截断后磁盘上的num_pages仍然是旧值
+    disk_manager_->write_page(fd_, RM_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
+}
+
+/**
+ * @description: 按页面内容重建空闲页面链表，从后往前依次头插，使得链表按页面号从小到大排列
+ * @note vacuum截断文件之后，以及恢复时按rid直接重做和回滚之后调用，这两种情况都没有维护空闲页面链表
+ */
+void RmFileHandle::rebuild_free_list() {
+    int record_nums = file_hdr_.num_records_per_page;
+    file_hdr_.first_free_page_no = RM_NO_PAGE;
+    for(int page_no = file_hdr_.num_pages - 1; page_no >= RM_FIRST_RECORD_PAGE; page_no--) {
+        RmPageHandle page_hdl = fetch_page_handle(page_no);
+        bool is_free = page_hdl.page_hdr->num_records < record_nums;
+        if(is_free) {
+            release_page_handle(page_hdl);
+        }
+        buffer_pool_manager_->unpin_page(page_hdl.page->get_page_id(), is_free);
+    }
+}
+
 /**
  * 以下函数为辅助函数，仅提供参考，可以选择完成如下函数，也可以删除如下函数，在单元测试中不涉及如下函数接口的直接调用
 */
@@ -388,4 +617,272 @@ void RmFileHandle::release_page_handle(RmPageHandle&page_handle) {
 
     // 2. file_hdr_.first_free_page_no
     file_hdr_.first_free_page_no = page_handle.page->get_page_id().page_no;
-}
\ No newline at end of file
+}
+
+/**
+ * @description: 把已经满了的页面和页面号大于last_page_no的页面从空闲页面链表中摘除，vacuum每一批结束时调用
+ * @param {int} last_page_no 链表中保留的最大页面号
+ */
+void RmFileHandle::unlink_free_pages(int last_page_no) {
+    int record_nums = file_hdr_.num_records_per_page;
+    int prev_page_no = RM_NO_PAGE;
+    int page_no = file_hdr_.first_free_page_no;
+    while(page_no != RM_NO_PAGE) {
+        RmPageHandle page_hdl = fetch_page_handle(page_no);
+        int next_page_no = page_hdl.page_hdr->next_free_page_no;
+        bool keep = page_hdl.page_hdr->num_records < record_nums && page_no <= last_page_no;
+        buffer_pool_manager_->unpin_page(page_hdl.page->get_page_id(), false);
+        if(keep) {
+            prev_page_no = page_no;
+        }else if(prev_page_no == RM_NO_PAGE) {
+            file_hdr_.first_free_page_no = next_page_no;
+        }else {
+            RmPageHandle prev_hdl = fetch_page_handle(prev_page_no);
+            prev_hdl.page_hdr->next_free_page_no = next_page_no;
+            buffer_pool_manager_->unpin_page(prev_hdl.page->get_page_id(), true);
+        }
+        page_no = next_page_no;
+    }
+}
+/**
+ * @description: 把上层传入的记录转换为slot中存储的格式，字典编码字段替换为编码，字典中没有的值分配新编码
+ * @param {char*} src 解码后的记录
+ * @param {char*} dest 转换结果的缓冲区，大小至少为file_hdr_.record_size
+ * @return {char*} 转换后的记录，没有字典编码字段时直接返回src
+ */
+const char* RmFileHandle::encode_record(const char* src, char* dest) {
+    if(file_hdr_.dict_mask == 0) {
+        return src;
+    }
+    std::scoped_lock lock{dict_latch_};
+    for(int i = 0; i < file_hdr_.num_cols; i++) {
+        const char *value = src + col_offsets_[i];
+        char *field = dest + stored_offsets_[i];
+        if(!file_hdr_.is_dict_col(i)) {
+            memcpy(field, value, file_hdr_.col_lens[i]);
+            continue;
+        }
+        auto &dict = dicts_[i];
+        std::string key(value, file_hdr_.col_lens[i]);
+        auto pos = dict.codes.find(key);
+        int code;
+        if(pos != dict.codes.end()) {
+            code = pos->second;
+        } else {
+            // 新值追加到字典文件中，编码即为追加的顺序
+            code = dict.values.size();
+            std::ofstream ofs(dict_path_, std::ios::binary | std::ios::app);
+            ofs.write(reinterpret_cast<const char *>(&i), sizeof(int));
+            ofs.write(key.data(), key.size());
+            ofs.close();
+            dict.codes.emplace(key, code);
+            dict.values.push_back(std::move(key));
+        }
+        memcpy(field, &code, RM_DICT_CODE_SIZE);
+    }
+    return dest;
+}
+
+/**
+ * @description: 把slot中存储的记录解码为上层看到的记录
+ * @param {char*} src slot中存储的记录
+ * @param {char*} dest 解码结果的缓冲区，大小至少为record_size_
+ */
+void RmFileHandle::decode_record(const char* src, char* dest) const {
+    std::scoped_lock lock{dict_latch_};
+    for(int i = 0; i < file_hdr_.num_cols; i++) {
+        const char *field = src + stored_offsets_[i];
+        if(file_hdr_.is_dict_col(i)) {
+            int code = *reinterpret_cast<const int *>(field);
+            memcpy(dest + col_offsets_[i], dicts_.at(i).values[code].data(), file_hdr_.col_lens[i]);
+        } else {
+            memcpy(dest + col_offsets_[i], field, file_hdr_.col_lens[i]);
+        }
+    }
+}
+
+/**
+ * @description: 打开表时从字典文件中读出所有字典编码字段的字典
+ */
+void RmFileHandle::load_dicts() {
+    for(int i = 0; i < file_hdr_.num_cols; i++) {
+        if(file_hdr_.is_dict_col(i)) {
+            dicts_[i];
+        }
+    }
+    std::ifstream ifs(dict_path_, std::ios::binary);
+    int col_idx;
+    while(ifs.read(reinterpret_cast<char *>(&col_idx), sizeof(int))) {
+        std::string value(file_hdr_.col_lens[col_idx], '\0');
+        if(!ifs.read(&value[0], value.size())) {
+            break;
+        }
+        auto &dict = dicts_[col_idx];
+        dict.codes.emplace(value, dict.values.size());
+        dict.values.push_back(std::move(value));
+    }
+}
+
+/**
+ * @description: 设置需要维护zone map的字段，zone map在第一次被扫描用到时才建立
+ * @param {vector<RmZoneCol>&} zone_cols 数值和datetime类型的字段
+ */
+void RmFileHandle::set_zone_cols(const std::vector<RmZoneCol>& zone_cols) {
+    std::scoped_lock lock{zone_latch_};
+    zone_cols_ = zone_cols;
+    zones_.clear();
+    zones_built_ = false;
+}
+
+/**
+ * @description: 获取offset处字段在zone map中的下标
+ * @return {int} 下标，如果该字段没有维护zone map则返回-1
+ */
+int RmFileHandle::get_zone_col(int offset) const {
+    for(size_t i = 0; i < zone_cols_.size(); i++) {
+        if(zone_cols_[i].offset == offset) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* 用一个字段值扩大zone的范围 */
+static void widen_zone(RmZone &zone, const RmZoneCol &col, const char *value) {
+    if(col.type == TYPE_FLOAT) {
+        double val = *reinterpret_cast<const float *>(value);
+        zone.float_min = zone.empty ? val : std::min(zone.float_min, val);
+        zone.float_max = zone.empty ? val : std::max(zone.float_max, val);
+    } else {
+        int64_t val;
+        switch(col.type) {
+            case TYPE_INT: val = *reinterpret_cast<const int *>(value); break;
+            case TYPE_BIGINT: val = *reinterpret_cast<const int64_t *>(value); break;
+            default: val = static_cast<int64_t>(*reinterpret_cast<const uint64_t *>(value)); break;
+        }
+        zone.int_min = zone.empty ? val : std::min(zone.int_min, val);
+        zone.int_max = zone.empty ? val : std::max(zone.int_max, val);
+    }
+    zone.empty = false;
+}
+
+/* 合并两个zone的范围 */
+static void merge_zone_range(RmZone &dest, const RmZone &src) {
+    if(src.empty) {
+        return;
+    }
+    if(dest.empty) {
+        dest = src;
+        return;
+    }
+    dest.int_min = std::min(dest.int_min, src.int_min);
+    dest.int_max = std::max(dest.int_max, src.int_max);
+    dest.float_min = std::min(dest.float_min, src.float_min);
+    dest.float_max = std::max(dest.float_max, src.float_max);
+}
+
+/**
+ * @description: 获取slot中非字典编码字段的地址
+ * @param {int} offset 字段在解码后记录中的偏移
+ * @param {int} len 字段长度
+ */
+char* RmFileHandle::get_stored_field(const RmPageHandle& page_hdl, int slot_no, int offset, int len) const {
+    if(file_hdr_.num_cols == 0) {
+        return page_hdl.get_field(slot_no, offset, len);
+    }
+    int col_idx = std::lower_bound(col_offsets_.begin(), col_offsets_.end(), offset) - col_offsets_.begin();
+    assert(col_idx < file_hdr_.num_cols && !file_hdr_.is_dict_col(col_idx));
+    return page_hdl.get_field(slot_no, stored_offsets_[col_idx], len);
+}
+
+/**
+ * @description: 插入或更新一条记录后扩大该页面的zone范围
+ * @param {int} page_no 记录所在页面
+ * @param {char*} record 解码后的记录
+ */
+void RmFileHandle::update_zone(int page_no, const char* record) {
+    if(zone_cols_.empty()) {
+        return;
+    }
+    std::scoped_lock lock{zone_latch_};
+    if(!zones_built_) {
+        return;
+    }
+    if(page_no >= (int)zones_.size()) {
+        zones_.resize(page_no + 1, std::vector<RmZone>(zone_cols_.size()));
+    }
+    for(size_t i = 0; i < zone_cols_.size(); i++) {
+        widen_zone(zones_[page_no][i], zone_cols_[i], record + zone_cols_[i].offset);
+    }
+}
+
+/**
+ * @description: vacuum把src页面上的记录搬到dest页面后，dest页面的zone需要包含src页面的范围
+ */
+void RmFileHandle::merge_zone(int dest_page_no, int src_page_no) {
+    std::scoped_lock lock{zone_latch_};
+    if(!zones_built_ || src_page_no >= (int)zones_.size()) {
+        return;
+    }
+    if(dest_page_no >= (int)zones_.size()) {
+        zones_.resize(dest_page_no + 1, std::vector<RmZone>(zone_cols_.size()));
+    }
+    for(size_t i = 0; i < zone_cols_.size(); i++) {
+        merge_zone_range(zones_[dest_page_no][i], zones_[src_page_no][i]);
+    }
+}
+
+/**
+ * @description: 遍历全表建立zone map，调用者需要持有zone_latch_
+ */
+void RmFileHandle::build_zones() const {
+    int record_nums = file_hdr_.num_records_per_page;
+    zones_.assign(file_hdr_.num_pages, std::vector<RmZone>(zone_cols_.size()));
+    for(int page_no = RM_FIRST_RECORD_PAGE; page_no < file_hdr_.num_pages; page_no++) {
+        RmPageHandle page_hdl = fetch_page_handle(page_no);
+        for(int slot_no = Bitmap::first_bit(true, page_hdl.bitmap, record_nums); slot_no < record_nums;
+            slot_no = Bitmap::next_bit(true, page_hdl.bitmap, record_nums, slot_no)) {
+            for(size_t i = 0; i < zone_cols_.size(); i++) {
+                auto &col = zone_cols_[i];
+                widen_zone(zones_[page_no][i], col, get_stored_field(page_hdl, slot_no, col.offset, col.len));
+            }
+        }
+        buffer_pool_manager_->unpin_page(page_hdl.page->get_page_id(), false);
+    }
+    zones_built_ = true;
+}
+
+/**
+ * @description: 根据zone map判断页面上是否可能存在满足所有范围条件的记录
+ * @param {int} page_no 页面号
+ * @param {vector<RmZonePred>&} preds 扫描条件转换得到的范围
+ * @return {bool} false表示该页面上一定没有满足条件的记录，可以不读取该页面
+ */
+bool RmFileHandle::page_may_match(int page_no, const std::vector<RmZonePred>& preds) const {
+    if(preds.empty()) {
+        return true;
+    }
+    std::scoped_lock lock{zone_latch_};
+    if(!zones_built_) {
+        build_zones();
+    }
+    if(page_no >= (int)zones_.size()) {
+        return true;
+    }
+    for(auto &pred : preds) {
+        auto &zone = zones_[page_no][pred.zone_col];
+        if(zone.empty) {
+            return false;
+        }
+        if(zone_cols_[pred.zone_col].type == TYPE_FLOAT) {
+            if((pred.has_lo && zone.float_max < pred.float_lo) || (pred.has_hi && zone.float_min > pred.float_hi)) {
+                return false;
+            }
+        } else {
+            if((pred.has_lo && zone.int_max < pred.int_lo) || (pred.has_hi && zone.int_min > pred.int_hi)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
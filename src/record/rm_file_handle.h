@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 #include <assert.h>
 
 #include <memory>
+#include <mutex>
 
 #include "bitmap.h"
 #include "common/context.h"
@@ -35,10 +36,48 @@ struct RmPageHandle {
         slots = bitmap + file_hdr->bitmap_size;
     }
 
-    // 返回指定slot_no的slot存储收地址
+    // 返回指定slot_no的slot存储收地址，只适用于行存布局
     char* get_slot(int slot_no) const {
+        assert(file_hdr->layout == RM_LAYOUT_ROW);
         return slots + slot_no * file_hdr->record_size;  // slots的首地址 + slot个数 * 每个slot的大小(每个record的大小)
     }
+
+    // 返回slot_no上记录中[offset, offset + len)字段的首地址，offset和len都是slot中的存储位置和长度，PAX布局下len必须是该字段的完整长度
+    // PAX布局中，offset处字段的minipage前面是offset之前所有字段的minipage，因此minipage首地址为slots + n * offset
+    char* get_field(int slot_no, int offset, int len) const {
+        if (file_hdr->layout == RM_LAYOUT_PAX) {
+            return slots + file_hdr->num_records_per_page * offset + slot_no * len;
+        }
+        return slots + slot_no * file_hdr->record_size + offset;
+    }
+
+    // 把slot_no上存储的记录拷贝到dest中，PAX布局下需要从各个minipage中拼出整条记录
+    void read_record(int slot_no, char* dest) const {
+        if (file_hdr->layout == RM_LAYOUT_ROW) {
+            memcpy(dest, get_slot(slot_no), file_hdr->record_size);
+            return;
+        }
+        int offset = 0;
+        for (int i = 0; i < file_hdr->num_cols; i++) {
+            int len = file_hdr->stored_col_len(i);
+            memcpy(dest + offset, get_field(slot_no, offset, len), len);
+            offset += len;
+        }
+    }
+
+    // 把src中的记录写到slot_no上，PAX布局下需要把每个字段分散写到对应的minipage中
+    void write_record(int slot_no, const char* src) {
+        if (file_hdr->layout == RM_LAYOUT_ROW) {
+            memcpy(get_slot(slot_no), src, file_hdr->record_size);
+            return;
+        }
+        int offset = 0;
+        for (int i = 0; i < file_hdr->num_cols; i++) {
+            int len = file_hdr->stored_col_len(i);
+            memcpy(get_field(slot_no, offset, len), src + offset, len);
+            offset += len;
+        }
+    }
 };
 
 /* 每个RmFileHandle对应一个表的数据文件，里面有多个page，每个page的数据封装在RmPageHandle中 */
@@ -54,6 +93,21 @@ class RmFileHandle {
 
     // 锁
     std::mutex latch_;
+
+    // 字典编码，记录在slot中只存编码，上层看到的仍然是解码后的记录
+    int record_size_;                               // 解码后的记录大小
+    std::vector<int> col_offsets_;                  // 每个字段解码后在记录中的offset
+    std::vector<int> stored_offsets_;               // 每个字段在slot中的offset
+    std::unordered_map<int, RmColumnDict> dicts_;   // 字段下标 -> 字典
+    std::string dict_path_;                         // 字典文件路径，新编码追加写入
+    mutable std::mutex dict_latch_;                 // 保护dicts_
+
+    // zone map，记录每个页面上各字段出现过的最小值和最大值；删除记录时不收缩，因此范围总是偏大的
+    // zone map只存在内存中，第一次被扫描用到时遍历全表建立，建立之后随插入、更新同步维护
+    std::vector<RmZoneCol> zone_cols_;
+    mutable std::vector<std::vector<RmZone>> zones_;    // page_no -> 每个zone字段的取值范围
+    mutable bool zones_built_ = false;
+    mutable std::mutex zone_latch_;                     // 保护zones_
     
    public:
     RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
@@ -64,9 +118,27 @@ class RmFileHandle {
         disk_manager_->read_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
         // disk_manager管理的fd对应的文件中，设置从file_hdr_.num_pages开始分配page_no
         disk_manager_->set_fd2pageno(fd, file_hdr_.num_pages);
+
+        record_size_ = file_hdr_.record_size;
+        if (file_hdr_.num_cols > 0) {
+            int offset = 0, stored_offset = 0;
+            for (int i = 0; i < file_hdr_.num_cols; i++) {
+                col_offsets_.push_back(offset);
+                stored_offsets_.push_back(stored_offset);
+                offset += file_hdr_.col_lens[i];
+                stored_offset += file_hdr_.stored_col_len(i);
+            }
+            record_size_ = offset;
+        }
+        if (file_hdr_.dict_mask != 0) {
+            dict_path_ = disk_manager_->get_file_name(fd) + RM_DICT_FILE_SUFFIX;
+            load_dicts();
+        }
     }
 
     RmFileHdr get_file_hdr() { return file_hdr_; }
+    // 上层看到的记录大小，有字典编码字段时与file_hdr_.record_size不同
+    int get_record_size() const { return record_size_; }
     int GetFd() { return fd_; }
 
     /* 判断指定位置上是否已经存在一条记录，通过Bitmap来判断 */
@@ -81,6 +153,20 @@ class RmFileHandle {
 
     std::unique_ptr<RmRecord> get_record(const Rid &rid, Context *context) const;
 
+    void get_field(const Rid &rid, int offset, int len, char *dest) const;
+
+    int get_dict_col(int offset) const;
+
+    int lookup_code(int col_idx, const char *value) const;
+
+    bool match_code(const Rid &rid, int col_idx, int code) const;
+
+    void set_zone_cols(const std::vector<RmZoneCol> &zone_cols);
+
+    int get_zone_col(int offset) const;
+
+    bool page_may_match(int page_no, const std::vector<RmZonePred> &preds) const;
+
     Rid insert_record(char *buf, Context *context, const std::string tab_name);
 
     // 用于处理大量插入的情况
@@ -98,8 +184,31 @@ class RmFileHandle {
 
     RmPageHandle fetch_page_handle(int page_no) const;
 
+    bool vacuum_batch(RmVacuumCursor *cursor, int max_moves, std::vector<std::pair<Rid, Rid>> *moved,
+                      const std::string &tab_name, Context *context);
+
+    void vacuum_finish();
+
+    void rebuild_free_list();
+
    private:
     RmPageHandle create_page_handle();
 
+    const char *encode_record(const char *src, char *dest);
+
+    void decode_record(const char *src, char *dest) const;
+
+    void load_dicts();
+
+    char *get_stored_field(const RmPageHandle &page_hdl, int slot_no, int offset, int len) const;
+
+    void update_zone(int page_no, const char *record);
+
+    void merge_zone(int dest_page_no, int src_page_no);
+
+    void build_zones() const;
+
     void release_page_handle(RmPageHandle &page_handle);
+
+    void unlink_free_pages(int last_page_no);
 };
\ No newline at end of file
@@ -30,24 +30,49 @@ class RmManager {
      * @description: 创建表的数据文件并初始化相关信息
      * @param {string&} filename 要创建的文件名称
      * @param {int} record_size 表中记录的大小
+     * @param {RmPageLayout} layout 页面布局
+     * @param {vector<int>&} col_lens 每个字段的长度，PAX布局或者有字典编码字段时需要
+     * @param {int} dict_mask 第i位为1表示第i个字段使用字典编码
      */ 
-    void create_file(const std::string& filename, int record_size) {
+    void create_file(const std::string& filename, int record_size, RmPageLayout layout = RM_LAYOUT_ROW,
+                     const std::vector<int>& col_lens = std::vector<int>(), int dict_mask = 0) {
         if (record_size < 1 || record_size > RM_MAX_RECORD_SIZE) {
             throw InvalidRecordSizeError(record_size);
         }
-        disk_manager_->create_file(filename);
-        int fd = disk_manager_->open_file(filename);
-
+        bool need_cols = layout == RM_LAYOUT_PAX || dict_mask != 0;
+        if (need_cols && (col_lens.empty() || (int)col_lens.size() > RM_MAX_FILE_COLS)) {
+            throw InternalError("PAX layout and dictionary encoding support 1 to " + std::to_string(RM_MAX_FILE_COLS) + " columns");
+        }
         // 初始化file header
         RmFileHdr file_hdr{};
-        file_hdr.record_size = record_size;
         file_hdr.num_pages = 1;
         file_hdr.first_free_page_no = RM_NO_PAGE;
+        file_hdr.layout = layout;
+        file_hdr.num_cols = need_cols ? (int)col_lens.size() : 0;
+        file_hdr.dict_mask = dict_mask;
+        // 字典编码字段在slot中只存编码，slot大小按存储长度重新计算；
+        // CHAR(n<4)的字典编码字段存储时比原来长，存储后的记录也不能超过RM_MAX_RECORD_SIZE
+        if (need_cols) {
+            record_size = 0;
+            for (int i = 0; i < file_hdr.num_cols; i++) {
+                file_hdr.col_lens[i] = col_lens[i];
+                record_size += file_hdr.stored_col_len(i);
+            }
+            if (record_size > RM_MAX_RECORD_SIZE) {
+                throw InvalidRecordSizeError(record_size);
+            }
+        }
+        file_hdr.record_size = record_size;
         // We have: sizeof(hdr) + (n + 7) / 8 + n * record_size <= PAGE_SIZE
+        // 这里的hdr是页面内的lsn和RmPageHdr，RmFileHdr只存在第0页，不占用数据页的空间
+        int page_hdr_size = Page::OFFSET_PAGE_HDR + sizeof(RmPageHdr);
         file_hdr.num_records_per_page =
-            (BITMAP_WIDTH * (PAGE_SIZE - 1 - (int)sizeof(RmFileHdr)) + 1) / (1 + record_size * BITMAP_WIDTH);
+            (BITMAP_WIDTH * (PAGE_SIZE - 1 - page_hdr_size) + 1) / (1 + record_size * BITMAP_WIDTH);
         file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
 
+        disk_manager_->create_file(filename);
+        int fd = disk_manager_->open_file(filename);
+
         // 将file header写入磁盘文件（名为file name，文件描述符为fd）中的第0页
         // head page直接写入磁盘，没有经过缓冲区的NewPage，那么也就不需要FlushPage
         disk_manager_->write_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr, sizeof(file_hdr));
@@ -63,6 +88,10 @@ class RmManager {
         int fd = disk_manager_->get_file_fd(filename);
         disk_manager_->close_file(fd);
         disk_manager_->destroy_file(filename); 
+        // 字典编码字段的字典文件
+        if (disk_manager_->is_file(filename + RM_DICT_FILE_SUFFIX)) {
+            disk_manager_->destroy_file(filename + RM_DICT_FILE_SUFFIX);
+        }
     }
 
     // 注意这里打开文件，创建并返回了record file handle的指针
@@ -15,7 +15,8 @@ See the Mulan PSL v2 for more details. */
  * @brief 初始化file_handle和rid
  * @param file_handle
  */
-RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
+RmScan::RmScan(const RmFileHandle *file_handle, const std::vector<RmZonePred> *zone_preds)
+    : file_handle_(file_handle), zone_preds_(zone_preds) {
   // 初始化file_handle和rid（指向第一个存放了记录的位置）
   rid_.page_no = RM_FIRST_RECORD_PAGE; // 记录所在数据页初始化为1
   rid_.slot_no = -1;
@@ -32,6 +33,10 @@ void RmScan::next() {
   }
   // 遍历所有Page
   for (; rid_.page_no < file_handle_->file_hdr_.num_pages; rid_.page_no++) {
+    // 刚进入一个页面时先查zone map，不可能满足条件的页面不需要读取
+    if (rid_.slot_no == -1 && zone_preds_ != nullptr && !file_handle_->page_may_match(rid_.page_no, *zone_preds_)) {
+      continue;
+    }
     // 用位图找到下一个为1的位, [rid.slot_no + 1, page.num_records)
     int num_record = file_handle_->file_hdr_.num_records_per_page;
     auto page_hdl = file_handle_->fetch_page_handle(rid_.page_no);
@@ -17,8 +17,9 @@ class RmFileHandle;
 class RmScan : public RecScan {
     const RmFileHandle *file_handle_;
     Rid rid_;
+    const std::vector<RmZonePred> *zone_preds_;   // 根据zone map跳过页面的范围条件，为空时扫描所有页面
 public:
-    RmScan(const RmFileHandle *file_handle);
+    RmScan(const RmFileHandle *file_handle, const std::vector<RmZonePred> *zone_preds = nullptr);
 
     void next() override;
 
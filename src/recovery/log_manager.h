@@ -515,6 +515,12 @@ public:
 
     LogBuffer* get_log_buffer() { return &log_buffer_; }
 
+    // 重启之后日志文件中已有的日志不会被覆盖，新日志的lsn要接着文件中最大的lsn继续分配，由故障恢复的analyze阶段设置
+    void set_next_lsn(lsn_t lsn) {
+        global_lsn_ = lsn;
+        persist_lsn_ = lsn - 1;
+    }
+
 private:    
     std::atomic<lsn_t> global_lsn_{0};  // 全局lsn，递增，用于为每条记录分发lsn
     std::mutex latch_;                  // 用于对log_buffer_的互斥访问
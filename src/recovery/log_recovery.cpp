@@ -80,7 +80,7 @@ void RecoveryManager::analyze() {
                         lsn_len_map_[abort_log_rcd->lsn_] = abort_log_rcd->log_tot_len_;
 
                         buffer_offset += abort_log_rcd->log_tot_len_;
-                        file_offset += abort_log_rcd->log_tid_;
+                        file_offset += abort_log_rcd->log_tot_len_;
 
                         // 将该事务从undo map里面删掉
                         undo_latest_lsn_map_.erase(abort_log_rcd->log_tid_);
@@ -181,6 +181,13 @@ void RecoveryManager::analyze() {
             break;
         }
     }
+
+    // 新日志的lsn接着文件中最大的lsn分配，否则重启之后的日志和文件中已有的日志lsn重复，下次恢复时互相覆盖
+    lsn_t max_lsn = INVALID_LSN;
+    for(auto &[lsn, offset] : lsn_offset_map_) {
+        max_lsn = std::max(max_lsn, lsn);
+    }
+    log_manager_->set_next_lsn(max_lsn + 1);
 }
 
 /**
@@ -213,9 +220,13 @@ void RecoveryManager::redo() {
                 //     }
                 //     buffer_pool_manager_->unpin_page(page_hdl.page->get_page_id(),true);
                 // }
+                touched_tabs_.insert(tab_name);
+                // vacuum截断文件之后，截掉的页面上可能还有更早的插入日志，需要把中间的页面一起补建出来
                  if(rm_file_hdl->get_file_hdr().num_pages <= insert_log_rcd->rid_.page_no){
-                    page_id_t new_page_no = rm_file_hdl->create_new_page_handle().page->get_page_id().page_no;
-                    assert(new_page_no == insert_log_rcd->rid_.page_no);
+                    while(rm_file_hdl->get_file_hdr().num_pages <= insert_log_rcd->rid_.page_no) {
+                        RmPageHandle page_hdl = rm_file_hdl->create_new_page_handle();
+                        buffer_pool_manager_->unpin_page(page_hdl.page->get_page_id(), true);
+                    }
                     rm_file_hdl->insert_record(insert_log_rcd->rid_,insert_log_rcd->insert_value_.data);
                 }else{
                     auto page_hdl = rm_file_hdl->fetch_page_handle(insert_log_rcd->rid_.page_no);
@@ -241,8 +252,15 @@ void RecoveryManager::redo() {
                 delete_log_rcd->deserialize(log_buf);
                 std::string tab_name(delete_log_rcd->table_name_,delete_log_rcd->table_name_size_);
                 auto rm_file_hdl = sm_manager_->fhs_[tab_name].get();
+                touched_tabs_.insert(tab_name);
+                // 页面已经被vacuum截掉时，截断之前页面上的记录都已经删除或者搬走了，不需要重做
+                if(rm_file_hdl->get_file_hdr().num_pages <= delete_log_rcd->rid_.page_no) {
+                    delete delete_log_rcd;
+                    break;
+                }
                 auto page_hdl = rm_file_hdl->fetch_page_handle(delete_log_rcd->rid_.page_no);
-                if(page_hdl.page->get_page_lsn() < delete_log_rcd->lsn_){
+                if(page_hdl.page->get_page_lsn() < delete_log_rcd->lsn_ &&
+                   Bitmap::is_set(page_hdl.bitmap, delete_log_rcd->rid_.slot_no)){
                     rm_file_hdl->delete_record(delete_log_rcd->rid_,nullptr);
                 }
                 buffer_pool_manager_->unpin_page(page_hdl.page->get_page_id(),true);
@@ -259,8 +277,15 @@ void RecoveryManager::redo() {
                 update_log_rcd->deserialize(log_buf);
                 std::string tab_name(update_log_rcd->table_name_,update_log_rcd->table_name_size_);
                 auto rm_file_hdl = sm_manager_->fhs_[tab_name].get();
+                touched_tabs_.insert(tab_name);
+                // 同删除，被截掉的页面上的记录后来一定被搬走了，搬移日志里是更新之后的值
+                if(rm_file_hdl->get_file_hdr().num_pages <= update_log_rcd->rid_.page_no) {
+                    delete update_log_rcd;
+                    break;
+                }
                 auto page_hdl = rm_file_hdl->fetch_page_handle(update_log_rcd->rid_.page_no);
-                if(page_hdl.page->get_page_lsn() < update_log_rcd->lsn_){
+                if(page_hdl.page->get_page_lsn() < update_log_rcd->lsn_ &&
+                   Bitmap::is_set(page_hdl.bitmap, update_log_rcd->rid_.slot_no)){
                     rm_file_hdl->update_record(update_log_rcd->rid_,update_log_rcd->after_value_.data,nullptr);
                 }
                 buffer_pool_manager_->unpin_page(page_hdl.page->get_page_id(),true);
@@ -300,6 +325,8 @@ void RecoveryManager::redo() {
 void RecoveryManager::undo() {
     for(auto it = undo_latest_lsn_map_.begin();it!= undo_latest_lsn_map_.end();++it){
         lsn_t lsn = it->second;
+        // 和TransactionManager::abort一样，每回滚一条操作写一条相反操作的补偿日志，之后的重启重做补偿日志，不会把回滚过的修改又做回来
+        lsn_t last_lsn = it->second;
         while(lsn != INVALID_LSN){
             int log_len = lsn_len_map_[lsn];
             char* log_buf = new char[log_len];
@@ -322,6 +349,10 @@ void RecoveryManager::undo() {
                     std::string tab_name(insert_log_rcd->table_name_,insert_log_rcd->table_name_size_);
                     auto rm_file_hdl = sm_manager_->fhs_[tab_name].get();
                     rm_file_hdl->delete_record(insert_log_rcd->rid_,nullptr);
+                    DeleteLogRecord clr_log_rcd(it->first, insert_log_rcd->insert_value_, insert_log_rcd->rid_, tab_name);
+                    clr_log_rcd.prev_lsn_ = last_lsn;
+                    last_lsn = log_manager_->add_log_to_buffer(&clr_log_rcd);
+                    rm_file_hdl->update_page_lsn(insert_log_rcd->rid_.page_no, last_lsn);
                     lsn = insert_log_rcd->prev_lsn_;
 
                     std::cout<<"undo insert "<<insert_log_rcd->lsn_<<std::endl;
@@ -335,6 +366,10 @@ void RecoveryManager::undo() {
                     std::string tab_name(delete_log_rcd->table_name_,delete_log_rcd->table_name_size_);
                     auto rm_file_hdl = sm_manager_->fhs_[tab_name].get();
                     rm_file_hdl->insert_record(delete_log_rcd->rid_,delete_log_rcd->delete_value_.data);
+                    InsertLogRecord clr_log_rcd(it->first, delete_log_rcd->delete_value_, delete_log_rcd->rid_, tab_name);
+                    clr_log_rcd.prev_lsn_ = last_lsn;
+                    last_lsn = log_manager_->add_log_to_buffer(&clr_log_rcd);
+                    rm_file_hdl->update_page_lsn(delete_log_rcd->rid_.page_no, last_lsn);
 
                     lsn = delete_log_rcd->prev_lsn_;
 
@@ -350,6 +385,11 @@ void RecoveryManager::undo() {
                     std::string tab_name(update_log_rcd->table_name_,update_log_rcd->table_name_size_);
                     auto rm_file_hdl = sm_manager_->fhs_[tab_name].get();
                     rm_file_hdl->update_record(update_log_rcd->rid_, update_log_rcd->before_value_.data, nullptr);
+                    UpdateLogRecord clr_log_rcd(it->first, update_log_rcd->after_value_, update_log_rcd->before_value_,
+                                                update_log_rcd->rid_, tab_name);
+                    clr_log_rcd.prev_lsn_ = last_lsn;
+                    last_lsn = log_manager_->add_log_to_buffer(&clr_log_rcd);
+                    rm_file_hdl->update_page_lsn(update_log_rcd->rid_.page_no, last_lsn);
 
                     lsn = update_log_rcd->prev_lsn_;
 
@@ -361,12 +401,23 @@ void RecoveryManager::undo() {
                     
                     ctb_log_rcd->deserialize(log_buf);
                     sm_manager_->drop_table(ctb_log_rcd->table_name_,nullptr);
+                    lsn = ctb_log_rcd->prev_lsn_;
 
                     break;
                 }
                 default:break;
             }
         }
+        // 回滚完成，写abort日志，下次恢复时不会再回滚这个事务
+        AbortLogRecord abort_log_rcd(it->first);
+        abort_log_rcd.prev_lsn_ = last_lsn;
+        log_manager_->flush_log_to_disk(&abort_log_rcd);
     }
 
+    // 重做和回滚都是按rid直接修改页面，没有维护空闲页面链表，最后按页面内容重建
+    for(auto &tab_name : touched_tabs_) {
+        if(sm_manager_->fhs_.count(tab_name)) {
+            sm_manager_->fhs_.at(tab_name)->rebuild_free_list();
+        }
+    }
 }
\ No newline at end of file
@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include "log_manager.h"
 #include "storage/disk_manager.h"
 #include "system/sm_manager.h"
@@ -25,10 +26,12 @@ public:
 
 class RecoveryManager {
 public:
-    RecoveryManager(DiskManager* disk_manager, BufferPoolManager* buffer_pool_manager, SmManager* sm_manager) {
+    RecoveryManager(DiskManager* disk_manager, BufferPoolManager* buffer_pool_manager, SmManager* sm_manager,
+                    LogManager* log_manager) {
         disk_manager_ = disk_manager;
         buffer_pool_manager_ = buffer_pool_manager;
         sm_manager_ = sm_manager;
+        log_manager_ = log_manager;
     }
 
     void analyze();
@@ -39,8 +42,10 @@ private:
     std::vector<lsn_t> redo_list_;                                  // 需要redo的log集合
     std::unordered_map<lsn_t, int> lsn_offset_map_;                 // lsn与offset的对应map
     std::unordered_map<lsn_t, int> lsn_len_map_;                     // 记录每个lsn的size
+    std::unordered_set<std::string> touched_tabs_;                  // redo修改过的表，undo之后重建空闲页面链表
     LogBuffer buffer_;                                              // 读入日志
     DiskManager* disk_manager_;                                     // 用来读写文件
     BufferPoolManager* buffer_pool_manager_;                        // 对页面进行读写
     SmManager* sm_manager_;                                         // 访问数据库元数据
+    LogManager* log_manager_;                                       // 设置重启之后的lsn，为回滚的事务写补偿日志和abort日志
 };
\ No newline at end of file
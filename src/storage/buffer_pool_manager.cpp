@@ -57,7 +57,11 @@ void BufferPoolManager::update_page(Page *page, PageId new_page_id, frame_id_t n
         disk_manager_->write_page(page->id_.fd, page->id_.page_no, page->data_, PAGE_SIZE);
     }
     // 2.更新元数据
-    page_table_.erase(page->id_);
+    // delete_page之后放回free_list_的帧还保留着旧的page id，这个页面号可能已经重新分配给了别的帧，不能把它的映射删掉
+    auto iter = page_table_.find(page->id_);
+    if(iter != page_table_.end() && iter->second == new_frame_id) {
+        page_table_.erase(iter);
+    }
     page->id_ = new_page_id;
     page->is_dirty_ = false;
     page->reset_memory();
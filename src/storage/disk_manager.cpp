@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/disk_manager.h"
 
 #include <assert.h>    // for assert
+#include <stdio.h>     // for rename
 #include <string.h>    // for memset
 #include <sys/stat.h>  // for stat
 #include <unistd.h>    // for lseek
@@ -80,6 +81,19 @@ page_id_t DiskManager::allocate_page(int fd) {
 
 void DiskManager::deallocate_page(__attribute__((unused)) page_id_t page_id) {}
 
+/**
+ * @description: 将文件截断为num_pages个页面，并重置该文件的页面分配起点
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} num_pages 截断后文件保留的页面个数
+ */
+void DiskManager::truncate_file(int fd, page_id_t num_pages) {
+    assert(fd >= 0 && fd < MAX_FD);
+    if (ftruncate(fd, static_cast<off_t>(num_pages) * PAGE_SIZE) == -1) {
+        throw UnixError();
+    }
+    fd2pageno_[fd] = num_pages;
+}
+
 bool DiskManager::is_dir(const std::string& path) {
     struct stat st;
     return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
@@ -162,6 +176,27 @@ void DiskManager::destroy_file(const std::string &path) {
 }
 
 
+/**
+ * @description: 重命名文件，new_path已经存在时原子地替换它
+ * @param {string} &old_path 原文件路径
+ * @param {string} &new_path 新文件路径
+ * @note 两个文件都必须已经关闭
+ */
+void DiskManager::rename_file(const std::string &old_path, const std::string &new_path) {
+    if(!is_file(old_path)) {
+        throw FileNotFoundError(old_path);
+    }
+    if(path2fd_.count(old_path)) {
+        throw FileNotClosedError(old_path);
+    }
+    if(path2fd_.count(new_path)) {
+        throw FileNotClosedError(new_path);
+    }
+    if(rename(old_path.c_str(), new_path.c_str()) == -1) {
+        throw UnixError();
+    }
+}
+
 /**
  * @description: 打开指定路径文件 
  * @return {int} 返回打开的文件的文件句柄 fd
@@ -40,6 +40,8 @@ class DiskManager {
 
     void deallocate_page(page_id_t page_id);
 
+    void truncate_file(int fd, page_id_t num_pages);
+
     /*目录操作*/
     bool is_dir(const std::string &path);
 
@@ -54,6 +56,8 @@ class DiskManager {
 
     void destroy_file(const std::string &path);
 
+    void rename_file(const std::string &old_path, const std::string &new_path);
+
     int open_file(const std::string &path);
 
     void close_file(int fd);
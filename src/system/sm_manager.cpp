@@ -14,12 +14,27 @@ See the Mulan PSL v2 for more details. */
 #include <unistd.h>
 
 #include <fstream>
+#include <iomanip>
 #include <sstream>
 
 #include "index/ix.h"
 #include "record/rm.h"
 #include "record_printer.h"
 
+/**
+ * @description: 获取表中需要维护zone map的字段，即数值和datetime类型的字段
+ * @param {TabMeta&} tab 表的元数据
+ */
+static std::vector<RmZoneCol> get_zone_cols(const TabMeta& tab) {
+    std::vector<RmZoneCol> zone_cols;
+    for (auto& col : tab.cols) {
+        if (col.type == TYPE_INT || col.type == TYPE_FLOAT || col.type == TYPE_BIGINT || col.type == TYPE_DATETIME) {
+            zone_cols.push_back({col.offset, col.len, col.type});
+        }
+    }
+    return zone_cols;
+}
+
 /**
  * @description: 判断是否为一个文件夹
  * @return {bool} 返回是否为一个文件夹
@@ -100,12 +115,34 @@ void SmManager::open_db(const std::string& db_name) {
     //
     for(auto &[table_name, table_meta] : db_.tabs_) {
         fhs_.emplace(table_name, rm_manager_->open_file(table_name));
+        fhs_.at(table_name)->set_zone_cols(get_zone_cols(table_meta));
+
+        // 打开表上的索引，索引类型不写入元数据文件，从索引文件头中读取
+        for(auto &index_meta : table_meta.indexes) {
+            auto index_name = ix_manager_->get_index_name(table_name, index_meta.cols);
+            // vacuum重建索引时在rename之前崩溃，会留下没有建完的临时文件，旧的索引文件是完好的
+            if(disk_manager_->is_file(index_name + IX_COMPACT_FILE_SUFFIX)) {
+                disk_manager_->destroy_file(index_name + IX_COMPACT_FILE_SUFFIX);
+            }
+            ihs_.emplace(index_name, ix_manager_->open_index(table_name, index_meta.cols));
+            index_meta.is_hash = ihs_.at(index_name)->is_hash();
+            index_meta.is_art = ihs_.at(index_name)->is_art();
+        }
+    }
+}
 
-        // // ihs_?
-        // for(auto &index_meta : table_meta.indexes) {    
-        //     int ifd = disk_manager_->open_file(index_meta.);
-        //     ihs_.emplace(index_name, RmFileHandle(disk_manager_, buffer_pool_manager_, ifd));
-        // }
+/**
+ * @description: 从表中重建只在内存中的ART索引，打开数据库时ART索引为空
+ * @note 必须在故障恢复的redo和undo之后调用，否则索引和恢复之后的表不一致
+ */
+void SmManager::rebuild_memory_indexes() {
+    for(auto &[table_name, table_meta] : db_.tabs_) {
+        for(auto &index_meta : table_meta.indexes) {
+            if(index_meta.is_art) {
+                auto index_name = ix_manager_->get_index_name(table_name, index_meta.cols);
+                build_index(table_name, index_meta, ihs_.at(index_name).get(), nullptr);
+            }
+        }
     }
 }
 
@@ -125,8 +162,12 @@ void SmManager::close_db() {
     // 
     for(auto &[tab_name, tabfilehandle] : fhs_) {
         rm_manager_->close_file(&(*tabfilehandle));
-        fhs_.erase(tab_name);
     }
+    fhs_.clear();
+    for(auto &[index_name, index_handle] : ihs_) {
+        ix_manager_->close_index(index_handle.get());
+    }
+    ihs_.clear();
     flush_meta();
     db_.name_.clear();
     db_.tabs_.clear();
@@ -195,6 +236,65 @@ void SmManager::show_index(std::string tab_name,Context* context) {
     }
 }
 
+/**
+ * @description: 显示表上各个索引的统计信息：类型、树高、叶子和内部结点个数、键值对个数、叶子平均填充率和各前缀的不同取值个数
+ * 叶子多于IX_STATS_SAMPLE_LEAVES时抽样估计，估计值前面加~
+ * @param {string&} tab_name 表名称
+ * @param {Context*} context 
+ */
+void SmManager::show_index_stats(const std::string& tab_name, Context* context) {
+    TabMeta &tab = db_.get_table(tab_name);
+
+    // 统计期间加S锁，阻塞写操作和vacuum
+    if(context != nullptr) {
+        context->lock_mgr_->lock_shared_on_table_wait_time(context->txn_, fhs_.at(tab_name)->GetFd());
+    }
+
+    std::vector<std::string> captions = {"Index", "Type", "Height", "Leaves", "Inner", "Keys", "Fill", "Prefix", "Distinct"};
+    RecordPrinter printer(captions.size());
+    printer.print_separator(context);
+    printer.print_record(captions, context);
+    printer.print_separator(context);
+    for(auto &index : tab.indexes) {
+        auto ih = ihs_.at(ix_manager_->get_index_name(tab_name, index.cols)).get();
+        IxIndexStats stats = ih->get_stats(IX_STATS_SAMPLE_LEAVES);
+        std::string approx = stats.sampled_leaves < stats.num_leaves ? "~" : "";
+
+        std::string type = "btree";
+        if(ih->is_hash()) {
+            type = "hash";
+        } else if(ih->is_art()) {
+            type = "art";
+        } else if(ih->get_file_hdr()->is_blink_) {
+            type = "blink";
+        } else if(ih->get_file_hdr()->is_lazy_delete_) {
+            type = "btree lazy";
+        }
+        std::stringstream fill;
+        fill << std::fixed << std::setprecision(1) << stats.avg_fill * 100 << "%";
+
+        // 每个前缀一行，第一行同时输出整个索引的统计信息
+        std::string cols;
+        for(auto &col : index.cols) {
+            cols += (cols.empty() ? "" : ",") + col.name;
+        }
+        std::string prefix;
+        for(size_t i = 0; i < index.cols.size(); i++) {
+            prefix += (i == 0 ? "" : ",") + index.cols[i].name;
+            std::string distinct = stats.distinct[i] >= 0 ? approx + std::to_string(stats.distinct[i]) : "-";
+            if(i == 0) {
+                printer.print_record({"(" + cols + ")", type, std::to_string(stats.height), std::to_string(stats.num_leaves),
+                                      std::to_string(stats.num_inner), approx + std::to_string(stats.num_keys),
+                                      fill.str(), "(" + prefix + ")", distinct},
+                                     context);
+            } else {
+                printer.print_record({"", "", "", "", "", "", "", "(" + prefix + ")", distinct}, context);
+            }
+        }
+    }
+    printer.print_separator(context);
+}
+
 /**
  * @description: 显示表的元数据
  * @param {string&} tab_name 表名称
@@ -224,7 +324,7 @@ void SmManager::desc_table(const std::string& tab_name, Context* context) {
  * @param {vector<ColDef>&} col_defs 表的字段
  * @param {Context*} context 
  */
-void SmManager::create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context) {
+void SmManager::create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context, bool is_pax) {
     // 1. 检查表是否已经存在
     if (db_.is_table(tab_name)) {
         throw TableExistsError(tab_name);
@@ -245,10 +345,31 @@ void SmManager::create_table(const std::string& tab_name, const std::vector<ColD
     }
     // Create & open record file
     int record_size = curr_offset;  // record_size就是col meta所占的大小（表的元数据也是以记录的形式进行存储的）
-    rm_manager_->create_file(tab_name, record_size);
+    // 字典编码字段在数据文件中只存编码
+    int dict_mask = 0;
+    for (size_t i = 0; i < col_defs.size(); i++) {
+        if (col_defs[i].dict) {
+            if (col_defs[i].type != TYPE_STRING || i >= RM_MAX_FILE_COLS) {
+                throw RMDBError("Dictionary encoding is only supported on CHAR columns among the first "
+                                + std::to_string(RM_MAX_FILE_COLS) + " columns");
+            }
+            dict_mask |= 1 << i;
+        }
+    }
+    if (is_pax || dict_mask != 0) {
+        // PAX布局需要知道每个字段的长度，用于在页面内划分minipage，字典编码需要知道每个字段的位置
+        std::vector<int> col_lens;
+        for (auto &col : tab.cols) {
+            col_lens.push_back(col.len);
+        }
+        rm_manager_->create_file(tab_name, record_size, is_pax ? RM_LAYOUT_PAX : RM_LAYOUT_ROW, col_lens, dict_mask);
+    } else {
+        rm_manager_->create_file(tab_name, record_size);
+    }
     db_.tabs_[tab_name] = tab;
     // fhs_[tab_name] = rm_manager_->open_file(tab_name);
     fhs_.emplace(tab_name, rm_manager_->open_file(tab_name));
+    fhs_.at(tab_name)->set_zone_cols(get_zone_cols(tab));
 
     // create_table加X锁
     if(context != nullptr) {
@@ -292,13 +413,22 @@ void SmManager::drop_table(const std::string& tab_name, Context* context) {
  * @param {string&} tab_name 表的名称
  * @param {vector<string>&} col_names 索引包含的字段名称
  * @param {Context*} context
+ * @param {bool} is_blink 是否建立B-link树索引
+ * @param {bool} is_hash 是否建立哈希索引
+ * @param {int} fill_factor B+树的填充率(%)，取值10~100
+ * @param {bool} is_art 是否建立内存中的ART索引
+ * @param {bool} is_lazy_delete B+树删除时是否只修改叶子结点，不合并结点，由vacuum重建
  */
-void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
+void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context, bool is_blink,
+                             bool is_hash, int fill_factor, bool is_art, bool is_lazy_delete) {
     
     // 1. 判断该索引是否已经被创建
     if(ix_manager_->exists(tab_name,col_names)){
         throw IndexExistsError(tab_name,col_names);
     }
+    if(fill_factor < 10 || fill_factor > 100) {
+        throw InternalError("Fill factor must be between 10 and 100");
+    }
     std::string index_name = ix_manager_->get_index_name(tab_name,col_names);
 
     // create index加S锁
@@ -317,7 +447,7 @@ void SmManager::create_index(const std::string& tab_name, const std::vector<std:
     }
 
     // 3. 调用IxManager的createIndex方法初始化index文件
-    ix_manager_->create_index(tab_name,col_metas);
+    ix_manager_->create_index(tab_name,col_metas,is_blink,is_hash,fill_factor,is_art,is_lazy_delete);
 
 
     // 4. 更新TableMeta
@@ -331,14 +461,16 @@ void SmManager::create_index(const std::string& tab_name, const std::vector<std:
     ix_file_hdl.deserialize(page->get_data());
     index.col_tot_len = ix_file_hdl.col_tot_len_;
     index.col_num = ix_file_hdl.col_num_;
+    index.is_hash = is_hash;
+    index.is_art = is_art;
     for(auto &col_meta : col_metas){
         index.cols.push_back(col_meta);
     }
     db_.get_table(tab_name).indexes.push_back(index);
 
-    char key[index.col_tot_len];
-
     buffer_pool_manager_->unpin_page(page->get_page_id(),false);
+    // 下面重新打开索引时通常复用这个fd，缓冲池中留下的文件头页面会在关闭索引时覆盖新写入的文件头
+    buffer_pool_manager_->delete_all_pages(fd);
     disk_manager_->close_file(fd);
 
     // 5. 更新sm_manager
@@ -346,22 +478,40 @@ void SmManager::create_index(const std::string& tab_name, const std::vector<std:
     ihs_.emplace(index_name, ix_manager_->open_index(tab_name,col_names));
     auto ix_hdl = ihs_.at(index_name).get();
     
-    // 6. 将表已存在的record创建索引
-    auto tab = db_.get_table(tab_name);
+    // 6. 将表已存在的record创建索引，有重复的key时删除建了一半的索引
+    try {
+        build_index(tab_name, index, ix_hdl, context);
+    } catch(RMDBError &) {
+        drop_index(tab_name, col_names, context);
+        throw;
+    }
+
+    // TODO test
+    // show_index(tab_name,context);
+}
+
+/**
+ * @description: 把表中已有的记录加入索引：先收集所有(key, rid)排序，数据量超过内存限制时会写入临时文件做外部排序，再批量建树
+ * @param {string&} tab_name 表名称
+ * @param {IndexMeta&} index 索引的元数据
+ * @param {IxIndexHandle*} ih 新建的空索引
+ * @param {Context*} context 故障恢复之后重建ART索引时为空
+ */
+void SmManager::build_index(const std::string& tab_name, const IndexMeta& index, IxIndexHandle* ih, Context* context) {
+    char key[index.col_tot_len];
     auto file_hdl = fhs_.at(tab_name).get();
+    IxBulkSorter sorter(ih->get_file_hdr());
     for (RmScan rm_scan(file_hdl); !rm_scan.is_end(); rm_scan.next()) {
-        auto rec = file_hdl->get_record(rm_scan.rid(), context);  
+        auto rec = file_hdl->get_record(rm_scan.rid(), context);
         int offset = 0;
         for(int i = 0; i < index.col_num; ++i) {
-                memcpy(key + offset, rec->data + index.cols[i].offset, index.cols[i].len);
-                offset += index.cols[i].len;
-            }
-        ix_hdl->insert_entry(key, rm_scan.rid(), context->txn_);
+            memcpy(key + offset, rec->data + index.cols[i].offset, index.cols[i].len);
+            offset += index.cols[i].len;
+        }
+        sorter.add(key, rm_scan.rid());
     }
-
-
-    // TODO test
-    // show_index(tab_name,context);
+    sorter.finish();
+    ih->bulk_load(&sorter, context != nullptr ? context->txn_ : nullptr);
 }
 
 /**
@@ -415,3 +565,140 @@ void SmManager::drop_index(const std::string& tab_name, const std::vector<ColMet
     }
     drop_index(tab_name, col_names, context);
 }
+
+
+/**
+ * @description: 整理表的数据文件的一批：把文件尾部页面中的记录搬到前部页面的空闲slot中，更新索引中被搬移记录的rid
+ * @return {bool} 是否还可能有需要搬移的记录
+ * @param {string&} tab_name 表名称
+ * @param {RmVacuumCursor*} cursor 搬移游标，跨批次保存
+ * @param {Context*} context
+ * @note 每一批由上层作为一个单独的短事务执行，这里加表的X锁，事务提交后释放，批与批之间其它事务可以正常读写；
+ *       扫描得到的rid在读事务结束前一直受表的S锁保护，不会被搬走
+ */
+bool SmManager::vacuum_batch(const std::string& tab_name, RmVacuumCursor* cursor, Context* context) {
+    if(!db_.is_table(tab_name)) {
+        throw TableNotFoundError(tab_name);
+    }
+    TabMeta &tab = db_.get_table(tab_name);
+    auto file_hdl = fhs_.at(tab_name).get();
+
+    if(context != nullptr) {
+        context->lock_mgr_->lock_exclusive_on_table_wait_time(context->txn_, file_hdl->GetFd());
+    }
+    Transaction *txn = context != nullptr ? context->txn_ : nullptr;
+
+    std::vector<std::pair<Rid, Rid>> moved;
+    bool has_more = file_hdl->vacuum_batch(cursor, VACUUM_BATCH_SIZE, &moved, tab_name, context);
+
+    // 记录内容没有变化，索引中只需要把旧rid替换为新rid
+    for(auto &index : tab.indexes) {
+        auto ih = ihs_.at(ix_manager_->get_index_name(tab_name, index.cols)).get();
+        char key[index.col_tot_len];
+        for(auto &move : moved) {
+            auto &new_rid = move.second;
+            auto rec = file_hdl->get_record(new_rid, nullptr);
+            int offset = 0;
+            for(int i = 0; i < index.col_num; ++i) {
+                memcpy(key + offset, rec->data + index.cols[i].offset, index.cols[i].len);
+                offset += index.cols[i].len;
+            }
+            ih->delete_entry(key, txn);
+            ih->insert_entry(key, new_rid, txn);
+        }
+    }
+    return has_more;
+}
+
+/**
+ * @description: 所有批次搬移完成后截断表文件尾部的空页面，并重建叶子填充率过低的B+树索引
+ * @param {string&} tab_name 表名称
+ * @param {Context*} context
+ * @note 加表的X锁，其它事务访问索引都要先加表锁，替换索引文件时没有其它线程访问索引
+ */
+void SmManager::vacuum_finish(const std::string& tab_name, Context* context) {
+    if(!db_.is_table(tab_name)) {
+        throw TableNotFoundError(tab_name);
+    }
+    TabMeta &tab = db_.get_table(tab_name);
+    auto file_hdl = fhs_.at(tab_name).get();
+
+    if(context != nullptr) {
+        context->lock_mgr_->lock_exclusive_on_table_wait_time(context->txn_, file_hdl->GetFd());
+    }
+
+    file_hdl->vacuum_finish();
+    // B+树删除时不合并结点，这里顺便重建叶子填充率过低的索引
+    for(auto &index : tab.indexes) {
+        if(ihs_.at(ix_manager_->get_index_name(tab_name, index.cols))->needs_compact(IX_COMPACT_FILL_THRESHOLD)) {
+            compact_index(tab_name, index);
+        }
+    }
+    buffer_pool_manager_->flush_all_pages(file_hdl->GetFd());
+}
+
+/**
+ * @description: 重建一个B+树索引：新树先按表中的记录建在临时文件中，刷盘之后rename覆盖旧的索引文件，再重新打开
+ * @param {string&} tab_name 表名称
+ * @param {IndexMeta&} index 要重建的索引
+ * @note 任何时刻磁盘上都有一个完整的索引文件：rename之前崩溃时旧文件完好，打开数据库时删除残留的临时文件；
+ *       rename是原子的，之后崩溃看到的是完整的新索引
+ */
+void SmManager::compact_index(const std::string& tab_name, const IndexMeta& index) {
+    std::string index_name = ix_manager_->get_index_name(tab_name, index.cols);
+    std::string tmp_name = index_name + IX_COMPACT_FILE_SUFFIX;
+    auto file_hdr = ihs_.at(index_name)->get_file_hdr();
+    if(disk_manager_->is_file(tmp_name)) {
+        disk_manager_->destroy_file(tmp_name);
+    }
+
+    // 1. 在临时文件中建新树，出错时删除临时文件，旧索引不受影响
+    ix_manager_->create_index_file(tmp_name, index.cols, file_hdr->is_blink_, false, file_hdr->fill_factor_, false,
+                                   file_hdr->is_lazy_delete_);
+    auto tmp_ih = ix_manager_->open_index_file(tmp_name);
+    try {
+        build_index(tab_name, index, tmp_ih.get(), nullptr);
+    } catch(RMDBError &) {
+        ix_manager_->close_and_evict_index(tmp_ih.get());
+        disk_manager_->destroy_file(tmp_name);
+        throw;
+    }
+    ix_manager_->close_and_evict_index(tmp_ih.get());
+
+    // 2. 关闭旧索引，用新文件替换旧文件后重新打开
+    ix_manager_->close_and_evict_index(ihs_.at(index_name).get());
+    ihs_.erase(index_name);
+    disk_manager_->rename_file(tmp_name, index_name);
+    ihs_.emplace(index_name, ix_manager_->open_index_file(index_name));
+}
+
+/**
+ * @description: 重建表上的所有索引，新文件使用当前的索引格式（多字段索引的key编码为可memcmp比较的格式），B-link、哈希、ART属性和填充率保持不变
+ * @param {string&} tab_name 表名称
+ * @param {Context*} context
+ */
+void SmManager::reindex_table(const std::string& tab_name, Context* context) {
+    if(!db_.is_table(tab_name)) {
+        throw TableNotFoundError(tab_name);
+    }
+
+    // reindex加X锁，重建期间索引不可用
+    if(context != nullptr) {
+        context->lock_mgr_->lock_exclusive_on_table_wait_time(context->txn_, fhs_.at(tab_name)->GetFd());
+    }
+
+    std::vector<std::tuple<std::vector<std::string>, bool, bool, int, bool, bool>> indexes;
+    for(auto &index : db_.get_table(tab_name).indexes) {
+        std::vector<std::string> col_names;
+        for(auto &col : index.cols) {
+            col_names.push_back(col.name);
+        }
+        auto file_hdr = ihs_.at(ix_manager_->get_index_name(tab_name, index.cols))->get_file_hdr();
+        indexes.emplace_back(std::move(col_names), file_hdr->is_blink_, index.is_hash, file_hdr->fill_factor_, index.is_art,
+                             file_hdr->is_lazy_delete_);
+    }
+    for(auto &[col_names, is_blink, is_hash, fill_factor, is_art, is_lazy_delete] : indexes) {
+        drop_index(tab_name, col_names, context);
+        create_index(tab_name, col_names, context, is_blink, is_hash, fill_factor, is_art, is_lazy_delete);
+    }
+}
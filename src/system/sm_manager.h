@@ -63,21 +63,38 @@ class SmManager {
 
     void close_db();
 
+    void rebuild_memory_indexes();
+
     void flush_meta();
 
     void show_tables(Context* context);
 
     void show_index(std::string tab_name,Context* context);
 
+    void show_index_stats(const std::string& tab_name, Context* context);
+
     void desc_table(const std::string& tab_name, Context* context);
 
-    void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context);
+    void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context, bool is_pax = false);
 
     void drop_table(const std::string& tab_name, Context* context);
 
-    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context, bool is_blink = false,
+                      bool is_hash = false, int fill_factor = IX_DEFAULT_FILL_FACTOR, bool is_art = false,
+                      bool is_lazy_delete = false);
 
     void drop_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+
+    bool vacuum_batch(const std::string& tab_name, RmVacuumCursor* cursor, Context* context);
+
+    void vacuum_finish(const std::string& tab_name, Context* context);
+
+    void reindex_table(const std::string& tab_name, Context* context);
     
     void drop_index(const std::string& tab_name, const std::vector<ColMeta>& col_names, Context* context);
+
+   private:
+    void build_index(const std::string& tab_name, const IndexMeta& index, IxIndexHandle* ih, Context* context);
+
+    void compact_index(const std::string& tab_name, const IndexMeta& index);
 };
\ No newline at end of file
@@ -45,6 +45,8 @@ struct IndexMeta {
     int col_tot_len;                // 索引字段长度总和
     int col_num;                    // 索引字段数量
     std::vector<ColMeta> cols;      // 索引包含的字段
+    bool is_hash = false;           // 是否为哈希索引，不写入元数据文件，打开索引时根据索引文件头设置
+    bool is_art = false;            // 是否为内存中的ART索引，同样根据索引文件头设置
 
     friend std::ostream &operator<<(std::ostream &os, const IndexMeta &index) {
         os << index.tab_name << " " << index.col_tot_len << " " << index.col_num;
@@ -107,7 +109,7 @@ struct TabMeta {
     // 第一个参数返回索引匹配的mode
     // mode = -1，索引不匹配
     // mode = 0, 索引满足最左匹配
-    // mode = 1，索引满足下面这种匹配情况，在(a, b, c)列上建索引，查询条件在(b, c)列上
+    // mode = 1，最左匹配失败但第二个字段有条件，如在(a, b, c)列上建索引，查询条件在b列上，逐个枚举a的取值做跳跃扫描
     std::pair<int, IndexMeta> have_index(const std::vector<std::string>& col_names) const {
         // int mode = -1;
 
@@ -117,12 +119,15 @@ struct TabMeta {
             col2bool[col_name] = true;
         }
         // 目前：支持最左匹配，且会自动调换顺序
+        const IndexMeta *skip_scan_index = nullptr;
         for(auto &index : indexes) {
+            // 哈希索引和ART索引只用于所有字段都是等值条件的查询，由planner单独判断
+            if(index.is_hash || index.is_art) {
+                continue;
+            }
             // 检查是否符合index需求
             // 1. 统计有多少连续的列用到了index
             int prefix_match_cols = 0;
-            int suffix_not_match_cols = 0;
-            int suffix_match_cols = 0;
 
             int i = 0;
             while(i < index.col_num) {
@@ -134,34 +139,12 @@ struct TabMeta {
                 }
             }
 
-            i = index.col_num - 1;
-            while(i >= 0) {
-                if(!col2bool[index.cols[i].name]) {
-                    i--;
-                    suffix_not_match_cols++;
-                }else {
-                    break;
-                }
-            }
-
-            while(i >= 0) {
-                if(col2bool[index.cols[i].name]) {
-                    i--;
-                    suffix_match_cols++;
-                }else{
-                    break;
-                }
-            }
-
-            // 
             if(prefix_match_cols != 0) {
                 // 最左匹配成功
                 return {0, index};
-            }else if(prefix_match_cols == 0 && suffix_match_cols != 0 && suffix_match_cols + suffix_not_match_cols == index.col_num -1 && index.cols[0].type == TYPE_INT){
-                // 最左匹配失败，最右匹配成功
-                return {1, index};
-            }else{
-                continue;
+            }else if(skip_scan_index == nullptr && index.col_num > 1 && col2bool[index.cols[1].name]){
+                // 最左匹配失败，但第二个字段有条件，可以逐个枚举第一个字段的取值做跳跃扫描；继续寻找最左匹配的索引
+                skip_scan_index = &index;
             }
             // // 2. 如果没有发现，那么该索引不匹配
             // if(i == 0) {
@@ -184,6 +167,9 @@ struct TabMeta {
             //     continue;
             // }
         }
+        if(skip_scan_index != nullptr) {
+            return {1, *skip_scan_index};
+        }
         return {-1, IndexMeta()};
     }
 
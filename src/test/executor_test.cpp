@@ -0,0 +1,393 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// 执行器的测试，表t(a INT, b INT, s CHAR(8))上有(a)、(b, a)和(s)三个索引：
+// 1. 插入和更新在后面的索引上遇到重复key时抛出异常，前面索引中已经插入的key被撤销，表中的记录不变
+// 2. 索引扫描的LIMIT、逆序和index-only，结果和逐条过滤表中记录得到的结果比较
+// 3. (b, a)上只有a的条件时的跳跃扫描
+// 4. 用索引区间端点计算MIN/MAX，包括删除端点上的记录之后
+
+#undef NDEBUG
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <functional>
+#include <map>
+
+#include "execution/execution_aggregation.h"
+#include "execution/execution_index_scan_mode1.h"
+#include "execution/executor_delete.h"
+#include "execution/executor_index_scan.h"
+#include "execution/executor_insert.h"
+#include "execution/executor_update.h"
+#include "record/rm_scan.h"
+#include "test_db.h"
+
+static const std::string TAB = "t";
+static const int NUM_ROWS = 3000;
+static const int NUM_B = 7;
+static const int STR_LEN = 8;
+
+struct Row {
+    int a;
+    int b;
+    std::string s;
+};
+
+static std::string str_of(int a) {
+    char buf[STR_LEN + 1];
+    snprintf(buf, sizeof(buf), "s%05d", a);
+    return buf;
+}
+
+static Value int_value(int v) {
+    Value value;
+    value.set_int(v);
+    value.init_raw(sizeof(int));
+    return value;
+}
+
+static Value str_value(const std::string &s) {
+    Value value;
+    value.set_str(s);
+    value.init_raw(STR_LEN);
+    return value;
+}
+
+static Condition cond(const std::string &col, CompOp op, int v) {
+    return Condition{TabCol{TAB, col}, op, true, TabCol{}, int_value(v)};
+}
+
+static Row row_of(const RmRecord &rec) {
+    return Row{*reinterpret_cast<int *>(rec.data), *reinterpret_cast<int *>(rec.data + sizeof(int)),
+               std::string(rec.data + 2 * sizeof(int), STR_LEN).c_str()};
+}
+
+// 表中的所有记录，按a排序
+static std::map<int, Row> table_rows(TestDb &db) {
+    auto fh = db.sm_manager->fhs_.at(TAB).get();
+    std::map<int, Row> rows;
+    for(RmScan scan(fh); !scan.is_end(); scan.next()) {
+        Row row = row_of(*fh->get_record(scan.rid(), nullptr));
+        rows[row.a] = row;
+    }
+    return rows;
+}
+
+static IndexMeta index_meta(TestDb &db, const std::vector<std::string> &col_names) {
+    return *db.sm_manager->db_.get_table(TAB).get_index_meta(col_names);
+}
+
+static IxIndexHandle *index_handle(TestDb &db, const std::vector<std::string> &col_names) {
+    return db.sm_manager->ihs_.at(db.ix_manager->get_index_name(TAB, col_names)).get();
+}
+
+// 每条记录在三个索引中都能找到并指向记录的rid，每个索引的项数等于记录数
+static void check_indexes(TestDb &db) {
+    auto fh = db.sm_manager->fhs_.at(TAB).get();
+    Transaction txn(INVALID_TXN_ID);
+    size_t num_records = 0;
+    for(RmScan scan(fh); !scan.is_end(); scan.next()) {
+        auto rec = fh->get_record(scan.rid(), nullptr);
+        for(auto &index : db.sm_manager->db_.get_table(TAB).indexes) {
+            char key[index.col_tot_len];
+            int offset = 0;
+            for(auto &col : index.cols) {
+                memcpy(key + offset, rec->data + col.offset, col.len);
+                offset += col.len;
+            }
+            auto ih = db.sm_manager->ihs_.at(db.ix_manager->get_index_name(TAB, index.cols)).get();
+            std::vector<Rid> result;
+            assert(ih->get_value(key, &result, &txn) && result[0] == scan.rid());
+        }
+        num_records++;
+    }
+    for(auto &index : db.sm_manager->db_.get_table(TAB).indexes) {
+        auto ih = db.sm_manager->ihs_.at(db.ix_manager->get_index_name(TAB, index.cols)).get();
+        size_t num_entries = 0;
+        for(IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), db.buffer_pool_manager.get()); !scan.is_end();
+            scan.next()) {
+            num_entries++;
+        }
+        assert(num_entries == num_records);
+    }
+}
+
+static Rid rid_of(TestDb &db, int a) {
+    Transaction txn(INVALID_TXN_ID);
+    std::vector<Rid> result;
+    assert(index_handle(db, {"a"})->get_value(reinterpret_cast<char *>(&a), &result, &txn));
+    return result[0];
+}
+
+// InsertExecutor自己按列长度初始化raw，传入的值不带raw
+static void insert_row(TestDb &db, Context *context, int a, int b, const std::string &s) {
+    Value va, vb, vs;
+    va.set_int(a);
+    vb.set_int(b);
+    vs.set_str(s);
+    InsertExecutor(db.sm_manager.get(), TAB, {va, vb, vs}, context).Next();
+}
+
+static void setup(TestDb &db) {
+    Transaction *txn = db.begin();
+    auto context = db.context(txn);
+    db.sm_manager->create_table(
+        TAB, {{"a", TYPE_INT, sizeof(int)}, {"b", TYPE_INT, sizeof(int)}, {"s", TYPE_STRING, STR_LEN}}, context.get());
+    db.sm_manager->create_index(TAB, {"a"}, context.get());
+    db.sm_manager->create_index(TAB, {"b", "a"}, context.get());
+    db.sm_manager->create_index(TAB, {"s"}, context.get());
+    for(int a = 0; a < NUM_ROWS; a++) {
+        insert_row(db, context.get(), a, a % NUM_B, str_of(a));
+    }
+    db.commit(txn);
+}
+
+// 运行扫描算子，返回输出的所有记录
+static std::vector<Row> run(AbstractExecutor *executor) {
+    std::vector<Row> rows;
+    for(executor->beginTuple(); !executor->is_end(); executor->nextTuple()) {
+        rows.push_back(row_of(*executor->Next()));
+    }
+    return rows;
+}
+
+// 逐条过滤表中的记录，按(key(row))排序
+static std::vector<Row> brute_force(TestDb &db, const std::function<bool(const Row &)> &pred,
+                                    const std::function<std::pair<int, int>(const Row &)> &key) {
+    std::vector<Row> rows;
+    for(auto &[a, row] : table_rows(db)) {
+        if(pred(row)) {
+            rows.push_back(row);
+        }
+    }
+    std::sort(rows.begin(), rows.end(), [&](const Row &x, const Row &y) { return key(x) < key(y); });
+    return rows;
+}
+
+static void assert_same(const std::vector<Row> &rows, const std::vector<Row> &expected, bool index_only = false) {
+    assert(rows.size() == expected.size());
+    for(size_t i = 0; i < rows.size(); i++) {
+        assert(rows[i].a == expected[i].a && rows[i].b == expected[i].b);
+        // index-only扫描只填充索引中的字段
+        assert(index_only || rows[i].s == expected[i].s);
+    }
+}
+
+static void test_insert_duplicate(TestDb &db) {
+    auto before = table_rows(db);
+    Transaction *txn = db.begin();
+    auto context = db.context(txn);
+
+    // (a)和(b, a)中插入成功之后在(s)上重复
+    bool thrown = false;
+    try {
+        insert_row(db, context.get(), NUM_ROWS, 1, str_of(5));
+    } catch(InternalError &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // 第一个索引上就重复
+    thrown = false;
+    try {
+        insert_row(db, context.get(), 5, 1, str_of(NUM_ROWS));
+    } catch(InternalError &) {
+        thrown = true;
+    }
+    assert(thrown);
+    db.commit(txn);
+
+    auto after = table_rows(db);
+    assert(after.size() == before.size());
+    Transaction check_txn(INVALID_TXN_ID);
+    std::vector<Rid> result;
+    int a = NUM_ROWS;
+    assert(!index_handle(db, {"a"})->get_value(reinterpret_cast<char *>(&a), &result, &check_txn));
+    check_indexes(db);
+}
+
+static void test_update_duplicate(TestDb &db) {
+    auto before = table_rows(db);
+    Transaction *txn = db.begin();
+    auto context = db.context(txn);
+    Rid rid = rid_of(db, 10);
+
+    // a改成已经存在的值
+    bool thrown = false;
+    try {
+        UpdateExecutor(db.sm_manager.get(), TAB, {SetClause{TabCol{TAB, "a"}, int_value(20), TabCol{}, true}}, {},
+                       {rid}, context.get())
+            .Next();
+    } catch(InternalError &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // a改成新值，(a)和(b, a)中插入新key之后在(s)上重复
+    thrown = false;
+    try {
+        UpdateExecutor(db.sm_manager.get(), TAB,
+                       {SetClause{TabCol{TAB, "a"}, int_value(NUM_ROWS + 5), TabCol{}, true},
+                        SetClause{TabCol{TAB, "s"}, str_value(str_of(11)), TabCol{}, true}},
+                       {}, {rid}, context.get())
+            .Next();
+    } catch(InternalError &) {
+        thrown = true;
+    }
+    assert(thrown);
+    db.commit(txn);
+
+    auto after = table_rows(db);
+    assert(after.size() == before.size() && after.at(10).s == str_of(10));
+    assert(rid_of(db, 10) == rid);
+    check_indexes(db);
+
+    // 不重复的更新，索引中的key随之改变
+    txn = db.begin();
+    context = db.context(txn);
+    UpdateExecutor(db.sm_manager.get(), TAB,
+                   {SetClause{TabCol{TAB, "a"}, int_value(NUM_ROWS + 5), TabCol{}, true},
+                    SetClause{TabCol{TAB, "s"}, str_value(str_of(NUM_ROWS + 5)), TabCol{}, true}},
+                   {}, {rid}, context.get())
+        .Next();
+    db.commit(txn);
+    assert(rid_of(db, NUM_ROWS + 5) == rid);
+    check_indexes(db);
+}
+
+static void test_index_scan(TestDb &db) {
+    Transaction *txn = db.begin();
+    auto context = db.context(txn);
+    auto by_a = [](const Row &row) { return std::make_pair(row.a, 0); };
+    auto by_a_desc = [](const Row &row) { return std::make_pair(-row.a, 0); };
+    auto in_range = [](const Row &row) { return row.a >= 100 && row.a < 500; };
+    std::vector<Condition> conds = {cond("a", OP_GE, 100), cond("a", OP_LT, 500)};
+    auto expected = brute_force(db, in_range, by_a);
+    auto expected_desc = brute_force(db, in_range, by_a_desc);
+    auto meta = index_meta(db, {"a"});
+
+    IndexScanExecutor scan(db.sm_manager.get(), TAB, conds, {"a"}, meta, context.get());
+    assert_same(run(&scan), expected);
+
+    // LIMIT
+    IndexScanExecutor limit_scan(db.sm_manager.get(), TAB, conds, {"a"}, meta, context.get(), 10);
+    assert_same(run(&limit_scan), std::vector<Row>(expected.begin(), expected.begin() + 10));
+    IndexScanExecutor zero_scan(db.sm_manager.get(), TAB, conds, {"a"}, meta, context.get(), 0);
+    assert(run(&zero_scan).empty());
+
+    // 逆序，逆序加LIMIT
+    IndexScanExecutor reverse_scan(db.sm_manager.get(), TAB, conds, {"a"}, meta, context.get(), -1, false, true);
+    assert_same(run(&reverse_scan), expected_desc);
+    IndexScanExecutor reverse_limit_scan(db.sm_manager.get(), TAB, conds, {"a"}, meta, context.get(), 7, false, true);
+    assert_same(run(&reverse_limit_scan), std::vector<Row>(expected_desc.begin(), expected_desc.begin() + 7));
+
+    // (b, a)上的index-only扫描，正序和逆序
+    auto by_b_a = [](const Row &row) { return std::make_pair(row.b, row.a); };
+    auto by_b_a_desc = [](const Row &row) { return std::make_pair(-row.b, -row.a); };
+    auto b_range = [](const Row &row) { return row.b == 3 && row.a > 1000; };
+    std::vector<Condition> b_conds = {cond("b", OP_EQ, 3), cond("a", OP_GT, 1000)};
+    auto b_meta = index_meta(db, {"b", "a"});
+    IndexScanExecutor only_scan(db.sm_manager.get(), TAB, b_conds, {"b", "a"}, b_meta, context.get(), -1, true);
+    assert_same(run(&only_scan), brute_force(db, b_range, by_b_a), true);
+    IndexScanExecutor only_reverse_scan(db.sm_manager.get(), TAB, b_conds, {"b", "a"}, b_meta, context.get(), 5, true,
+                                        true);
+    auto b_expected_desc = brute_force(db, b_range, by_b_a_desc);
+    assert_same(run(&only_reverse_scan), std::vector<Row>(b_expected_desc.begin(), b_expected_desc.begin() + 5), true);
+    db.commit(txn);
+}
+
+static void test_skip_scan(TestDb &db) {
+    Transaction *txn = db.begin();
+    auto context = db.context(txn);
+    auto by_b_a = [](const Row &row) { return std::make_pair(row.b, row.a); };
+    // (b, a)上只有a的条件，b的每个取值各扫描一段
+    std::vector<Condition> conds = {cond("a", OP_GE, 100), cond("a", OP_LE, 130)};
+    IndexScanModeOneExecutor scan(db.sm_manager.get(), TAB, conds, {"b", "a"}, index_meta(db, {"b", "a"}),
+                                  context.get());
+    assert_same(run(&scan), brute_force(db, [](const Row &row) { return row.a >= 100 && row.a <= 130; }, by_b_a));
+
+    // 没有满足条件的记录
+    std::vector<Condition> empty_conds = {cond("a", OP_GT, 1000000)};
+    IndexScanModeOneExecutor empty_scan(db.sm_manager.get(), TAB, empty_conds, {"b", "a"},
+                                        index_meta(db, {"b", "a"}), context.get());
+    assert(run(&empty_scan).empty());
+    db.commit(txn);
+}
+
+static int aggregate(TestDb &db, Context *context, AggreOp op, const std::vector<Condition> &conds,
+                     const std::vector<std::string> &index_cols) {
+    AggregationExecutor agg(db.sm_manager.get(), TAB, conds, AggreMeta{op, TabCol{TAB, "a"}},
+                            index_meta(db, index_cols), context);
+    agg.beginTuple();
+    return *reinterpret_cast<int *>(agg.Next()->data);
+}
+
+static void test_min_max(TestDb &db) {
+    Transaction *txn = db.begin();
+    auto context = db.context(txn);
+    auto rows = table_rows(db);
+    auto expected = [&](AggreOp op, const std::function<bool(const Row &)> &pred) {
+        int result = op == AG_MAX ? INT_MIN : INT_MAX;
+        for(auto &[a, row] : rows) {
+            if(pred(row)) {
+                result = op == AG_MAX ? std::max(result, a) : std::min(result, a);
+            }
+        }
+        return result;
+    };
+    auto b3 = [](const Row &row) { return row.b == 3; };
+    auto b3_range = [](const Row &row) { return row.b == 3 && row.a > 50 && row.a < 1000; };
+    std::vector<Condition> b3_conds = {cond("b", OP_EQ, 3)};
+    std::vector<Condition> b3_range_conds = {cond("b", OP_EQ, 3), cond("a", OP_GT, 50), cond("a", OP_LT, 1000)};
+
+    assert(aggregate(db, context.get(), AG_MIN, {}, {"a"}) == rows.begin()->first);
+    assert(aggregate(db, context.get(), AG_MAX, {}, {"a"}) == rows.rbegin()->first);
+    assert(aggregate(db, context.get(), AG_MIN, b3_conds, {"b", "a"}) == expected(AG_MIN, b3));
+    assert(aggregate(db, context.get(), AG_MAX, b3_conds, {"b", "a"}) == expected(AG_MAX, b3));
+    assert(aggregate(db, context.get(), AG_MIN, b3_range_conds, {"b", "a"}) == expected(AG_MIN, b3_range));
+    assert(aggregate(db, context.get(), AG_MAX, b3_range_conds, {"b", "a"}) == expected(AG_MAX, b3_range));
+    db.commit(txn);
+
+    // 删除b = 3的最小和最大的记录之后端点移动到下一条记录
+    txn = db.begin();
+    context = db.context(txn);
+    int min_a = expected(AG_MIN, b3);
+    int max_a = expected(AG_MAX, b3);
+    DeleteExecutor(db.sm_manager.get(), TAB, {}, {rid_of(db, min_a), rid_of(db, max_a)}, context.get()).Next();
+    db.commit(txn);
+    rows.erase(min_a);
+    rows.erase(max_a);
+
+    txn = db.begin();
+    context = db.context(txn);
+    assert(aggregate(db, context.get(), AG_MIN, b3_conds, {"b", "a"}) == expected(AG_MIN, b3));
+    assert(aggregate(db, context.get(), AG_MAX, b3_conds, {"b", "a"}) == expected(AG_MAX, b3));
+    // 没有满足条件的记录时和逐条比较的结果相同
+    std::vector<Condition> none_conds = {cond("b", OP_EQ, NUM_B)};
+    assert(aggregate(db, context.get(), AG_MAX, none_conds, {"b", "a"}) == INT_MIN);
+    db.commit(txn);
+}
+
+int main() {
+    enter_empty_dir("executor_test_dir");
+    TestDb db("executor_db");
+    setup(db);
+    check_indexes(db);
+    test_insert_duplicate(db);
+    test_update_duplicate(db);
+    test_index_scan(db);
+    test_skip_scan(db);
+    test_min_max(db);
+    db.close();
+    printf("executor_test passed\n");
+    return 0;
+}
@@ -0,0 +1,141 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// ART索引和B+树（普通、B-link）、哈希索引的点查延迟对比：每种索引按随机顺序插入相同的N个key，
+// 再用若干个线程查找同一组随机的已有key，输出每个key的插入时间、每次点查的平均延迟和总吞吐，并检查rid
+//
+// 用法: ix_art_bench [key个数] [点查次数] [线程数]
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "index/ix.h"
+#include "recovery/log_manager.h"
+#include "test_util.h"
+
+struct IndexKind {
+    const char *name;
+    bool is_blink;
+    bool is_hash;
+    bool is_art;
+};
+
+// 一个INT字段和一个CHAR(12)字段组成的key，对应多字段索引
+struct CompositeKey {
+    int a;
+    char s[12];
+};
+
+int main(int argc, char **argv) {
+    int num_keys = argc > 1 ? atoi(argv[1]) : 1000000;
+    int num_probes = argc > 2 ? atoi(argv[2]) : 2000000;
+    int num_threads = argc > 3 ? atoi(argv[3]) : 1;
+
+    std::vector<IndexKind> kinds = {
+        {"btree", false, false, false},
+        {"blink", true, false, false},
+        {"hash", false, true, false},
+        {"art", false, false, true},
+    };
+
+    enter_empty_dir("ix_art_bench_db");
+    DiskManager disk_manager;
+    LogManager log_manager(&disk_manager);
+    BufferPoolManager buffer_pool_manager(BUFFER_POOL_SIZE, &disk_manager, &log_manager);
+    IxManager ix_manager(&disk_manager, &buffer_pool_manager);
+
+    std::mt19937 rng(1);
+    std::vector<int> order(num_keys);
+    for(int i = 0; i < num_keys; i++) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<int> probes(num_probes);
+    for(auto &p : probes) {
+        p = rng() % num_keys;
+    }
+
+    // key_of(i)把第i个key写入buf；INT key取稀疏的取值，让ART的路径上有分叉
+    auto int_key = [](int i, char *buf) {
+        int v = i * 7 + 3;
+        memcpy(buf, &v, sizeof(int));
+    };
+    auto composite_key = [](int i, char *buf) {
+        CompositeKey key;
+        memset(&key, 0, sizeof(key));
+        key.a = i % 97 - 40;
+        snprintf(key.s, sizeof(key.s), "k%d", i / 97);
+        memcpy(buf, &key, sizeof(key));
+    };
+
+    bool ok = true;
+    for(int composite = 0; composite < 2; composite++) {
+        auto key_of = composite ? composite_key : int_key;
+        int key_len = composite ? sizeof(CompositeKey) : sizeof(int);
+        for(auto &kind : kinds) {
+            std::string tab_name = std::string(kind.name) + (composite ? "_composite" : "_int");
+            std::vector<ColMeta> cols = {make_col(tab_name, "a", TYPE_INT, sizeof(int), 0)};
+            if(composite) {
+                cols.push_back(make_col(tab_name, "s", TYPE_STRING, sizeof(CompositeKey::s), sizeof(int)));
+            }
+            ix_manager.create_index(tab_name, cols, kind.is_blink, kind.is_hash, IX_DEFAULT_FILL_FACTOR, kind.is_art);
+            auto ih = ix_manager.open_index(tab_name, cols);
+
+            Transaction txn(0);
+            std::vector<char> buf(key_len);
+            Timer insert_timer;
+            for(int i : order) {
+                key_of(i, buf.data());
+                ih->insert_entry(buf.data(), Rid{i, 0}, &txn);
+            }
+            double insert_time = insert_timer.seconds();
+
+            // 每个线程查找probes中下标模num_threads同余的部分，先预热一遍
+            std::atomic<long> misses{0};
+            double lookup_time = 0;
+            for(int round = 0; round < 2; round++) {
+                std::vector<std::thread> threads;
+                Timer lookup_timer;
+                for(int t = 0; t < num_threads; t++) {
+                    threads.emplace_back([&, t] {
+                        Transaction thread_txn(t + 1);
+                        std::vector<char> key(key_len);
+                        std::vector<Rid> result;
+                        long thread_misses = 0;
+                        for(int j = t; j < num_probes; j += num_threads) {
+                            key_of(probes[j], key.data());
+                            result.clear();
+                            if(!ih->get_value(key.data(), &result, &thread_txn) || result[0].page_no != probes[j]) {
+                                thread_misses++;
+                            }
+                        }
+                        misses += thread_misses;
+                    });
+                }
+                for(auto &thread : threads) {
+                    thread.join();
+                }
+                lookup_time = lookup_timer.seconds();
+            }
+
+            printf("%-6s %-9s keys=%d threads=%d insert %5.0f ns/key lookup %5.0f ns/op (%6.2f Mops/s) misses=%ld\n",
+                   kind.name, composite ? "int+char" : "int", num_keys, num_threads, insert_time * 1e9 / num_keys,
+                   lookup_time * 1e9 * num_threads / num_probes, num_probes / lookup_time / 1e6, misses.load());
+            ok &= misses == 0;
+            ix_manager.close_and_evict_index(ih.get());
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,252 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// 各种索引（B+树、B-link树、lazy delete的B+树、哈希、ART）的并发测试：
+// 1. 多个线程用insert_entry_if_absent插入同一组key，每个key恰好一个线程成功，最后查到的是成功的线程插入的rid
+// 2. 多个线程各自插入、删除、再插入互不相交的key，同时读线程查找不会被修改的key，结束后和预期的key集合比较，
+//    有序索引再顺着叶子链表检查顺序和个数
+// 3. 删除最小和最大的一批key之后，get_min_key/get_max_key返回剩下的最小和最大key
+
+#undef NDEBUG
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "index/ix.h"
+#include "recovery/log_manager.h"
+#include "test_util.h"
+
+struct IndexKind {
+    const char *name;
+    bool is_blink;
+    bool is_hash;
+    bool is_art;
+    bool is_lazy_delete;
+};
+
+static const int NUM_THREADS = 4;
+
+// 乘以奇数在模2^32下是双射，让相邻的i落在树的不同位置
+static int scramble(int i) { return static_cast<int>(static_cast<unsigned>(i) * 2654435761u); }
+
+class IndexTest {
+   public:
+    IndexTest(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
+        : buffer_pool_manager_(buffer_pool_manager), ix_manager_(disk_manager, buffer_pool_manager) {}
+
+    std::unique_ptr<IxIndexHandle> create(const IndexKind &kind, const std::string &name) {
+        cols_ = {make_col(name, "k", TYPE_INT, sizeof(int), 0)};
+        ix_manager_.create_index(name, cols_, kind.is_blink, kind.is_hash, IX_DEFAULT_FILL_FACTOR, kind.is_art,
+                                 kind.is_lazy_delete);
+        return ix_manager_.open_index(name, cols_);
+    }
+
+    void close(IxIndexHandle *ih) { ix_manager_.close_and_evict_index(ih); }
+
+    // 有序索引顺着叶子链表扫描，返回key的个数，检查key严格递增；rid.slot_no是key的下标
+    long scan(IxIndexHandle *ih) {
+        long count = 0;
+        int prev = 0;
+        for(IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), buffer_pool_manager_); !scan.is_end(); scan.next()) {
+            int key = scramble(scan.rid().slot_no);
+            assert(count == 0 || key > prev);
+            prev = key;
+            count++;
+        }
+        return count;
+    }
+
+   private:
+    BufferPoolManager *buffer_pool_manager_;
+    IxManager ix_manager_;
+    std::vector<ColMeta> cols_;
+};
+
+static bool find(IxIndexHandle *ih, int key, Rid *rid, Transaction *txn) {
+    std::vector<Rid> result;
+    if(!ih->get_value(reinterpret_cast<const char *>(&key), &result, txn)) {
+        return false;
+    }
+    assert(result.size() == 1);
+    *rid = result[0];
+    return true;
+}
+
+// 所有线程插入同一组key，每个key只有一个线程成功
+static void test_insert_race(IndexTest *test, const IndexKind &kind, int num_keys) {
+    auto ih = test->create(kind, std::string(kind.name) + "_race");
+    std::vector<std::atomic<int>> winners(num_keys);
+    for(auto &w : winners) {
+        w = 0;
+    }
+    std::vector<std::thread> threads;
+    for(int t = 0; t < NUM_THREADS; t++) {
+        threads.emplace_back([&, t] {
+            Transaction txn(t);
+            // 各线程从不同的位置开始，让同一个key的竞争发生在插入的不同阶段
+            for(int j = 0; j < num_keys; j++) {
+                int i = (j + t * num_keys / NUM_THREADS) % num_keys;
+                int key = scramble(i);
+                if(ih->insert_entry_if_absent(reinterpret_cast<const char *>(&key), Rid{t, i}, &txn)) {
+                    winners[i] += 1 << (8 * t);
+                }
+            }
+        });
+    }
+    for(auto &thread : threads) {
+        thread.join();
+    }
+
+    Transaction txn(NUM_THREADS);
+    for(int i = 0; i < num_keys; i++) {
+        int w = winners[i];
+        // 恰好有一个线程成功，并且查到的是它插入的rid
+        assert(w != 0 && (w & (w - 1)) == 0);
+        Rid rid;
+        assert(find(ih.get(), scramble(i), &rid, &txn));
+        assert(w == 1 << (8 * rid.page_no) && rid.slot_no == i);
+    }
+    if(!kind.is_hash && !kind.is_art) {
+        assert(test->scan(ih.get()) == num_keys);
+    }
+    test->close(ih.get());
+}
+
+// 线程t负责下标模NUM_THREADS等于t的key：全部插入，删除其中下标是3的倍数的，再把下标是6的倍数的用新的rid插回去。
+// 下标在[num_keys, num_keys + num_stable)的key事先插入，读线程在修改期间不断查找它们
+static void test_insert_delete_mix(IndexTest *test, const IndexKind &kind, int num_keys, int num_stable) {
+    auto ih = test->create(kind, std::string(kind.name) + "_mix");
+    {
+        Transaction txn(0);
+        for(int i = num_keys; i < num_keys + num_stable; i++) {
+            int key = scramble(i);
+            ih->insert_entry(reinterpret_cast<const char *>(&key), Rid{0, i}, &txn);
+        }
+    }
+
+    std::atomic<bool> writers_done{false};
+    std::atomic<long> read_misses{0};
+    std::vector<std::thread> readers;
+    for(int r = 0; r < 2; r++) {
+        readers.emplace_back([&, r] {
+            Transaction txn(NUM_THREADS + r);
+            unsigned seed = r + 1;
+            Rid rid;
+            while(!writers_done) {
+                seed = seed * 1103515245 + 12345;
+                int i = num_keys + static_cast<int>(seed >> 8) % num_stable;
+                if(!find(ih.get(), scramble(i), &rid, &txn) || rid.slot_no != i) {
+                    read_misses++;
+                }
+            }
+        });
+    }
+
+    std::vector<std::thread> writers;
+    for(int t = 0; t < NUM_THREADS; t++) {
+        writers.emplace_back([&, t] {
+            Transaction txn(t);
+            for(int i = t; i < num_keys; i += NUM_THREADS) {
+                int key = scramble(i);
+                ih->insert_entry(reinterpret_cast<const char *>(&key), Rid{1, i}, &txn);
+            }
+            for(int i = t; i < num_keys; i += NUM_THREADS) {
+                int key = scramble(i);
+                if(i % 3 == 0) {
+                    assert(ih->delete_entry(reinterpret_cast<const char *>(&key), &txn));
+                }
+            }
+            for(int i = t; i < num_keys; i += NUM_THREADS) {
+                int key = scramble(i);
+                if(i % 6 == 0) {
+                    assert(ih->insert_entry_if_absent(reinterpret_cast<const char *>(&key), Rid{2, i}, &txn));
+                }
+            }
+        });
+    }
+    for(auto &thread : writers) {
+        thread.join();
+    }
+    writers_done = true;
+    for(auto &thread : readers) {
+        thread.join();
+    }
+    assert(read_misses == 0);
+
+    Transaction txn(0);
+    long expected = num_stable;
+    for(int i = 0; i < num_keys; i++) {
+        Rid rid;
+        bool found = find(ih.get(), scramble(i), &rid, &txn);
+        if(i % 6 == 0) {
+            assert(found && rid.page_no == 2 && rid.slot_no == i);
+        } else if(i % 3 == 0) {
+            assert(!found);
+            continue;
+        } else {
+            assert(found && rid.page_no == 1 && rid.slot_no == i);
+        }
+        expected++;
+    }
+    if(!kind.is_hash && !kind.is_art) {
+        assert(test->scan(ih.get()) == expected);
+    }
+    test->close(ih.get());
+}
+
+// 删除最小和最大的num_deleted个key之后检查最小值和最大值，B-link树和lazy delete的B+树中会留下空的叶子
+static void test_min_max(IndexTest *test, const IndexKind &kind, int num_keys, int num_deleted) {
+    auto ih = test->create(kind, std::string(kind.name) + "_minmax");
+    Transaction txn(0);
+    for(int i = 0; i < num_keys; i++) {
+        ih->insert_entry(reinterpret_cast<const char *>(&i), Rid{0, i}, &txn);
+    }
+    for(int i = 0; i < num_deleted; i++) {
+        int low = i;
+        int high = num_keys - 1 - i;
+        assert(ih->delete_entry(reinterpret_cast<const char *>(&low), &txn));
+        assert(ih->delete_entry(reinterpret_cast<const char *>(&high), &txn));
+    }
+    auto min_key = ih->get_min_key(&txn);
+    auto max_key = ih->get_max_key(&txn);
+    assert(min_key.first && *reinterpret_cast<int *>(min_key.second->data) == num_deleted);
+    assert(max_key.first && *reinterpret_cast<int *>(max_key.second->data) == num_keys - 1 - num_deleted);
+    test->close(ih.get());
+}
+
+int main() {
+    std::vector<IndexKind> kinds = {
+        {"btree", false, false, false, false},
+        {"blink", true, false, false, false},
+        {"lazy", false, false, false, true},
+        {"hash", false, true, false, false},
+        {"art", false, false, true, false},
+    };
+
+    enter_empty_dir("ix_concurrency_test_db");
+    DiskManager disk_manager;
+    LogManager log_manager(&disk_manager);
+    BufferPoolManager buffer_pool_manager(BUFFER_POOL_SIZE, &disk_manager, &log_manager);
+    IndexTest test(&disk_manager, &buffer_pool_manager);
+
+    for(auto &kind : kinds) {
+        test_insert_race(&test, kind, 50000);
+        test_insert_delete_mix(&test, kind, 100000, 10000);
+        if(!kind.is_hash && !kind.is_art) {
+            test_min_max(&test, kind, 50000, 5000);
+        }
+        printf("%s ok\n", kind.name);
+    }
+    printf("ix_concurrency_test passed\n");
+    return 0;
+}
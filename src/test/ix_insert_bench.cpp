@@ -0,0 +1,137 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// 多个线程向同一个B+树索引并发插入的benchmark，同时检查正确性：
+// 插入期间读线程不断查找已经插入完成的key，必须都能找到；插入结束后检查所有key都能找到，并且叶子链表有序、个数正确
+//
+// 用法: ix_insert_bench [最大写线程数] [key个数] [读线程数] [blink(0/1)]
+// 写线程数从1开始每次翻倍，直到最大写线程数，每一轮使用一个新的索引
+
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "index/ix.h"
+#include "recovery/log_manager.h"
+#include "test_util.h"
+
+// 乘以奇数在模2^32下是双射，把0..n-1打散成互不相同的整数，让各个线程的插入落在整棵树上
+static int scramble(int i) { return static_cast<int>(static_cast<unsigned>(i) * 2654435761u); }
+
+int main(int argc, char **argv) {
+    int max_writers = argc > 1 ? atoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    int num_keys = argc > 2 ? atoi(argv[2]) : 1000000;
+    int num_readers = argc > 3 ? atoi(argv[3]) : 2;
+    bool is_blink = argc > 4 && atoi(argv[4]) != 0;
+
+    enter_empty_dir("ix_insert_bench_db");
+    DiskManager disk_manager;
+    LogManager log_manager(&disk_manager);
+    BufferPoolManager buffer_pool_manager(BUFFER_POOL_SIZE, &disk_manager, &log_manager);
+    IxManager ix_manager(&disk_manager, &buffer_pool_manager);
+
+    bool ok = true;
+    for(int num_writers = 1; num_writers <= max_writers; num_writers *= 2) {
+        std::string tab_name = "t" + std::to_string(num_writers);
+        std::vector<ColMeta> cols = {make_col(tab_name, "k", TYPE_INT, sizeof(int), 0)};
+        ix_manager.create_index(tab_name, cols, is_blink);
+        auto ih = ix_manager.open_index(tab_name, cols);
+
+        // 写线程w插入下标为w, w+num_writers, ...的key，published[w]是它已经插入完成的key个数
+        std::vector<std::atomic<int>> published(num_writers);
+        for(auto &p : published) {
+            p = 0;
+        }
+        std::atomic<bool> writers_done{false};
+        std::atomic<long> read_misses{0};
+        std::atomic<long> reads{0};
+
+        std::vector<std::thread> readers;
+        for(int r = 0; r < num_readers; r++) {
+            readers.emplace_back([&, r] {
+                Transaction txn(num_writers + r);
+                std::mt19937 rng(r);
+                std::vector<Rid> result;
+                long n = 0;
+                while(!writers_done) {
+                    int w = rng() % num_writers;
+                    int done = published[w].load(std::memory_order_acquire);
+                    if(done == 0) {
+                        continue;
+                    }
+                    int i = w + static_cast<int>(rng() % done) * num_writers;
+                    int key = scramble(i);
+                    result.clear();
+                    if(!ih->get_value(reinterpret_cast<char *>(&key), &result, &txn) || result[0].page_no != i) {
+                        read_misses++;
+                    }
+                    n++;
+                }
+                reads += n;
+            });
+        }
+
+        Timer timer;
+        std::vector<std::thread> writers;
+        for(int w = 0; w < num_writers; w++) {
+            writers.emplace_back([&, w] {
+                Transaction txn(w);
+                int done = 0;
+                for(int i = w; i < num_keys; i += num_writers) {
+                    int key = scramble(i);
+                    ih->insert_entry(reinterpret_cast<char *>(&key), Rid{i, 0}, &txn);
+                    published[w].store(++done, std::memory_order_release);
+                }
+            });
+        }
+        for(auto &t : writers) {
+            t.join();
+        }
+        double elapsed = timer.seconds();
+        writers_done = true;
+        for(auto &t : readers) {
+            t.join();
+        }
+
+        // 插入结束后逐个检查，再顺着叶子链表检查有序和个数
+        Transaction txn(0);
+        long lost = 0;
+        std::vector<Rid> result;
+        for(int i = 0; i < num_keys; i++) {
+            int key = scramble(i);
+            result.clear();
+            if(!ih->get_value(reinterpret_cast<char *>(&key), &result, &txn) || result[0].page_no != i) {
+                lost++;
+            }
+        }
+        long scanned = 0;
+        long misordered = 0;
+        int prev = 0;
+        IxScan scan(ih.get(), ih->leaf_begin(), ih->leaf_end(), &buffer_pool_manager);
+        for(; !scan.is_end(); scan.next()) {
+            int key = scramble(scan.rid().page_no);
+            misordered += scanned > 0 && key <= prev;
+            prev = key;
+            scanned++;
+        }
+
+        bool round_ok = read_misses == 0 && lost == 0 && misordered == 0 && scanned == num_keys;
+        ok &= round_ok;
+        printf("writers=%2d readers=%d keys=%d insert %8.0f kops/s  reads=%ld read_misses=%ld lost=%ld scanned=%ld "
+               "misordered=%ld %s\n",
+               num_writers, num_readers, num_keys, num_keys / elapsed / 1000, reads.load(), read_misses.load(), lost,
+               scanned, misordered, round_ok ? "ok" : "FAILED");
+        // 下一轮的索引文件可能复用同一个fd，缓冲池中不能留下这一轮的页面
+        ix_manager.close_and_evict_index(ih.get());
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// 字符串索引的树高和点查延迟benchmark：按随机顺序插入N个key，输出树高、叶子个数、每片叶子的平均键值对个数，
+// 再随机点查所有key并检查rid。btree_order是不压缩时每个结点能放下的键值对个数，叶子平均键值对个数超过它说明压缩起了作用
+//
+// 用法: ix_string_key_bench [key个数] [点查轮数]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "index/ix.h"
+#include "recovery/log_manager.h"
+#include "test_util.h"
+
+struct KeyPattern {
+    const char *name;
+    int len;
+    std::function<void(int, char *, int)> make;    // 把第i个key写入长度为len的缓冲区，不足的部分补0
+};
+
+int main(int argc, char **argv) {
+    int num_keys = argc > 1 ? atoi(argv[1]) : 1000000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 3;
+
+    std::vector<KeyPattern> patterns = {
+        {"user_id", 24, [](int i, char *buf, int len) { snprintf(buf, len, "user%010d", i); }},
+        {"url", 64,
+         [](int i, char *buf, int len) {
+             snprintf(buf, len, "https://example.com/items/category-%03d/product/%08d", i % 200, i);
+         }},
+        {"random", 32,
+         [](int i, char *buf, int len) {
+             // 前16个字符由i的哈希值决定，没有公共前缀
+             uint64_t h = static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ull;
+             for(int j = 0; j < 16; j++) {
+                 h ^= h >> 29;
+                 h *= 0xBF58476D1CE4E5B9ull;
+                 buf[j] = 'a' + h % 26;
+             }
+             snprintf(buf + 16, len - 16, "%08d", i);
+         }},
+    };
+
+    enter_empty_dir("ix_string_key_bench_db");
+    DiskManager disk_manager;
+    LogManager log_manager(&disk_manager);
+    BufferPoolManager buffer_pool_manager(BUFFER_POOL_SIZE, &disk_manager, &log_manager);
+    IxManager ix_manager(&disk_manager, &buffer_pool_manager);
+    Transaction txn(0);
+
+    std::vector<int> order(num_keys);
+    for(int i = 0; i < num_keys; i++) {
+        order[i] = i;
+    }
+    std::mt19937 rng(1);
+
+    bool ok = true;
+    for(auto &pattern : patterns) {
+        std::vector<ColMeta> cols = {make_col(pattern.name, "k", TYPE_STRING, pattern.len, 0)};
+        ix_manager.create_index(pattern.name, cols);
+        auto ih = ix_manager.open_index(pattern.name, cols);
+        std::vector<char> buf(pattern.len);
+        auto make_key = [&](int i) {
+            memset(buf.data(), 0, pattern.len);
+            pattern.make(i, buf.data(), pattern.len);
+            return buf.data();
+        };
+
+        std::shuffle(order.begin(), order.end(), rng);
+        Timer insert_timer;
+        for(int i : order) {
+            ih->insert_entry(make_key(i), Rid{i, 0}, &txn);
+        }
+        double insert_time = insert_timer.seconds();
+
+        // 先查一遍预热缓冲池，再计时
+        std::shuffle(order.begin(), order.end(), rng);
+        long misses = 0;
+        std::vector<Rid> result;
+        for(int round = 0; round <= rounds; round++) {
+            Timer lookup_timer;
+            for(int i : order) {
+                result.clear();
+                if(!ih->get_value(make_key(i), &result, &txn) || result[0].page_no != i) {
+                    misses++;
+                }
+            }
+            if(round == rounds) {
+                IxIndexStats stats = ih->get_stats(INT32_MAX);
+                printf("%-8s len=%2d keys=%d btree_order=%3d height=%d leaves=%6d inner=%4d keys/leaf=%6.1f "
+                       "insert %5.0f ns/key lookup %5.0f ns/op misses=%ld\n",
+                       pattern.name, pattern.len, num_keys, ih->get_file_hdr()->btree_order_, stats.height,
+                       stats.num_leaves, stats.num_inner, static_cast<double>(stats.num_keys) / stats.num_leaves,
+                       insert_time * 1e9 / num_keys, lookup_timer.seconds() * 1e9 / num_keys, misses);
+            }
+        }
+        ok &= misses == 0;
+        ix_manager.close_and_evict_index(ih.get());
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "execution/execution_manager.h"
+#include "recovery/log_recovery.h"
+#include "test_util.h"
+#include "transaction/transaction_manager.h"
+
+/**
+ * @description: 测试用的数据库实例，按rmdb.cpp中的方式构造各个管理器。
+ * 构造时打开数据库并做一次故障恢复，close()正常关闭；不调用close()直接析构时缓冲池中的脏页不会写回，相当于进程崩溃
+ */
+class TestDb {
+   public:
+    std::unique_ptr<DiskManager> disk_manager;
+    std::unique_ptr<LogManager> log_manager;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager;
+    std::unique_ptr<RmManager> rm_manager;
+    std::unique_ptr<IxManager> ix_manager;
+    std::unique_ptr<SmManager> sm_manager;
+    std::unique_ptr<LockManager> lock_manager;
+    std::unique_ptr<TransactionManager> txn_manager;
+    std::unique_ptr<QlManager> ql_manager;
+
+    // 在当前目录下打开数据库db_name，不存在时先创建
+    explicit TestDb(const std::string &db_name) : db_name_(db_name) {
+        disk_manager = std::make_unique<DiskManager>();
+        log_manager = std::make_unique<LogManager>(disk_manager.get());
+        buffer_pool_manager =
+            std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get(), log_manager.get());
+        rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+        ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+        sm_manager = std::make_unique<SmManager>(disk_manager.get(), buffer_pool_manager.get(), rm_manager.get(),
+                                                 ix_manager.get());
+        lock_manager = std::make_unique<LockManager>();
+        txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), sm_manager.get());
+        ql_manager = std::make_unique<QlManager>(sm_manager.get(), txn_manager.get());
+
+        if(!sm_manager->is_dir(db_name_)) {
+            sm_manager->create_db(db_name_);
+        }
+        sm_manager->open_db(db_name_);
+        RecoveryManager recovery(disk_manager.get(), buffer_pool_manager.get(), sm_manager.get(), log_manager.get());
+        recovery.analyze();
+        recovery.redo();
+        recovery.undo();
+        sm_manager->rebuild_memory_indexes();
+    }
+
+    // 没有调用close()时直接回到上一级目录，脏页留在缓冲池中被丢弃
+    ~TestDb() {
+        if(open_) {
+            chdir("..");
+        }
+    }
+
+    void close() {
+        sm_manager->close_db();
+        chdir("..");
+        open_ = false;
+    }
+
+    // 开始一个单条语句的隐式事务
+    Transaction *begin() {
+        Transaction *txn = txn_manager->begin(nullptr, log_manager.get());
+        txn->set_txn_mode(false);
+        return txn;
+    }
+
+    void commit(Transaction *txn) {
+        txn_manager->commit(txn, log_manager.get());
+        txn_manager->delete_transaction(txn->get_transaction_id());
+    }
+
+    void abort(Transaction *txn) {
+        txn_manager->abort(txn, log_manager.get());
+        txn_manager->delete_transaction(txn->get_transaction_id());
+    }
+
+    std::unique_ptr<Context> context(Transaction *txn) {
+        auto context = std::make_unique<Context>(lock_manager.get(), log_manager.get(), txn, data_send_, &offset_);
+        context->outputFile_ = &output_file_;
+        return context;
+    }
+
+   private:
+    std::string db_name_;
+    bool open_ = true;
+    char data_send_[BUFFER_LENGTH];
+    int offset_ = 0;
+    bool output_file_ = false;
+};
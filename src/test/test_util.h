@@ -0,0 +1,56 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "common/config.h"
+#include "system/sm_meta.h"
+
+// 测试和benchmark共用的小工具
+
+/**
+ * @description: 删除并重新创建目录dir，然后进入该目录，其中放一个空的日志文件
+ * DiskManager使用相对路径，各个组件都以当前目录作为数据库目录
+ */
+inline void enter_empty_dir(const std::string &dir) {
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::filesystem::current_path(dir);
+    std::ofstream(LOG_FILE_NAME).close();
+}
+
+inline ColMeta make_col(const std::string &tab_name, const std::string &col_name, ColType type, int len, int offset) {
+    ColMeta col;
+    col.tab_name = tab_name;
+    col.name = col_name;
+    col.type = type;
+    col.len = len;
+    col.offset = offset;
+    col.index = true;
+    return col;
+}
+
+// 从构造开始计时，seconds()返回经过的秒数
+class Timer {
+   public:
+    Timer() : start_(std::chrono::steady_clock::now()) {}
+
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+   private:
+    std::chrono::steady_clock::time_point start_;
+};
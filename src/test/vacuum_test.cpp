@@ -0,0 +1,229 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// VACUUM和故障恢复的测试：
+// 1. 删除大部分记录后VACUUM，检查记录都还在、每个索引项指向记录搬移后的新位置、表文件变小
+// 2. 正常关闭后重启，检查内容不变，并且重启后还能继续插入
+// 3. 子进程在VACUUM进行到一半时不刷脏页直接退出，重启后恢复出已提交的删除和搬移，未提交的插入被回滚；
+//    再重启一次，第一次恢复回滚过的事务不会被再次回滚
+
+#undef NDEBUG
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdio>
+#include <functional>
+#include <map>
+
+#include "execution/executor_delete.h"
+#include "execution/executor_insert.h"
+#include "index/ix.h"
+#include "record/rm_scan.h"
+#include "test_db.h"
+
+static const std::string TAB = "t";
+static const int STR_LEN = 16;
+
+static std::string str_of(int a) {
+    char buf[STR_LEN];
+    snprintf(buf, sizeof(buf), "v%08d", a);
+    return buf;
+}
+
+// 表t(a INT, b CHAR(16))，在a和b上各建一个索引
+static void create_table(TestDb &db) {
+    Transaction *txn = db.begin();
+    auto context = db.context(txn);
+    db.sm_manager->create_table(TAB, {{"a", TYPE_INT, sizeof(int)}, {"b", TYPE_STRING, STR_LEN}}, context.get());
+    db.sm_manager->create_index(TAB, {"a"}, context.get());
+    db.sm_manager->create_index(TAB, {"b"}, context.get());
+    db.commit(txn);
+}
+
+static void insert_rows(TestDb &db, Transaction *txn, int from, int to, std::map<int, std::string> *expected) {
+    auto context = db.context(txn);
+    for(int a = from; a < to; a++) {
+        Value va, vb;
+        va.set_int(a);
+        vb.set_str(str_of(a));
+        InsertExecutor(db.sm_manager.get(), TAB, {va, vb}, context.get()).Next();
+        if(expected != nullptr) {
+            (*expected)[a] = str_of(a);
+        }
+    }
+}
+
+// 删除a满足pred的所有记录
+static void delete_rows(TestDb &db, Transaction *txn, const std::function<bool(int)> &pred,
+                        std::map<int, std::string> *expected) {
+    auto fh = db.sm_manager->fhs_.at(TAB).get();
+    std::vector<Rid> rids;
+    for(RmScan scan(fh); !scan.is_end(); scan.next()) {
+        int a = *reinterpret_cast<int *>(fh->get_record(scan.rid(), nullptr)->data);
+        if(pred(a)) {
+            rids.push_back(scan.rid());
+            expected->erase(a);
+        }
+    }
+    auto context = db.context(txn);
+    DeleteExecutor(db.sm_manager.get(), TAB, {}, rids, context.get()).Next();
+}
+
+static void vacuum(TestDb &db) {
+    Transaction *txn = db.begin();
+    auto context = db.context(txn);
+    txn_id_t txn_id = txn->get_transaction_id();
+    db.ql_manager->run_cmd_utility(std::make_shared<OtherPlan>(T_Vacuum, TAB), &txn_id, context.get());
+    db.commit(txn);
+}
+
+// 表中的记录和expected相同；check_indexes时每条记录在每个索引中都能找到，并且指向记录当前的rid，索引中没有多余的项
+static void check(TestDb &db, const std::map<int, std::string> &expected, bool check_indexes = true) {
+    auto fh = db.sm_manager->fhs_.at(TAB).get();
+    auto &tab = db.sm_manager->db_.get_table(TAB);
+    Transaction txn(INVALID_TXN_ID);
+    size_t num_records = 0;
+    for(RmScan scan(fh); !scan.is_end(); scan.next()) {
+        auto rec = fh->get_record(scan.rid(), nullptr);
+        int a = *reinterpret_cast<int *>(rec->data);
+        auto it = expected.find(a);
+        assert(it != expected.end());
+        assert(std::string(rec->data + sizeof(int), STR_LEN).c_str() == it->second);
+        num_records++;
+        if(!check_indexes) {
+            continue;
+        }
+        for(auto &index : tab.indexes) {
+            auto ih = db.sm_manager->ihs_.at(db.ix_manager->get_index_name(TAB, index.cols)).get();
+            std::vector<Rid> result;
+            assert(ih->get_value(rec->data + index.cols[0].offset, &result, &txn));
+            assert(result.size() == 1 && result[0] == scan.rid());
+        }
+    }
+    assert(num_records == expected.size());
+    if(!check_indexes) {
+        return;
+    }
+    for(auto &index : tab.indexes) {
+        auto ih = db.sm_manager->ihs_.at(db.ix_manager->get_index_name(TAB, index.cols)).get();
+        size_t num_entries = 0;
+        for(IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), db.buffer_pool_manager.get()); !scan.is_end();
+            scan.next()) {
+            num_entries++;
+        }
+        assert(num_entries == expected.size());
+    }
+}
+
+static int num_pages(TestDb &db) { return db.sm_manager->fhs_.at(TAB)->get_file_hdr().num_pages; }
+
+// 删除九成记录后VACUUM，再重启检查
+static void test_vacuum_and_restart() {
+    std::map<int, std::string> expected;
+    {
+        TestDb db("vacuum_db");
+        create_table(db);
+        Transaction *txn = db.begin();
+        insert_rows(db, txn, 0, 20000, &expected);
+        db.commit(txn);
+        txn = db.begin();
+        delete_rows(db, txn, [](int a) { return a % 10 != 3; }, &expected);
+        db.commit(txn);
+
+        int pages_before = num_pages(db);
+        vacuum(db);
+        check(db, expected);
+        assert(num_pages(db) * 5 < pages_before);
+        db.close();
+    }
+    {
+        TestDb db("vacuum_db");
+        check(db, expected);
+        Transaction *txn = db.begin();
+        insert_rows(db, txn, 20000, 21000, &expected);
+        db.commit(txn);
+        check(db, expected);
+        db.close();
+    }
+}
+
+// 子进程删除记录并做一部分VACUUM批次后崩溃，父进程恢复
+static void test_crash_during_vacuum() {
+    std::map<int, std::string> expected;
+    {
+        TestDb db("crash_db");
+        create_table(db);
+        Transaction *txn = db.begin();
+        insert_rows(db, txn, 0, 20000, &expected);
+        db.commit(txn);
+        db.close();
+    }
+    // 子进程删除的记录
+    for(auto it = expected.begin(); it != expected.end();) {
+        it = it->first % 10 != 3 ? expected.erase(it) : std::next(it);
+    }
+
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if(pid == 0) {
+        TestDb db("crash_db");
+        std::map<int, std::string> unused = expected;
+        Transaction *txn = db.begin();
+        delete_rows(db, txn, [](int a) { return a % 10 != 3; }, &unused);
+        db.commit(txn);
+
+        // 两个批次，每个批次是一个单独的事务，和QlManager中的VACUUM相同
+        RmVacuumCursor cursor{RM_FIRST_RECORD_PAGE, RM_NO_PAGE};
+        for(int batch = 0; batch < 2; batch++) {
+            txn = db.begin();
+            auto context = db.context(txn);
+            db.sm_manager->vacuum_batch(TAB, &cursor, context.get());
+            db.commit(txn);
+        }
+
+        // 未提交的插入，下一个事务的begin日志会把它的日志刷盘
+        txn = db.begin();
+        insert_rows(db, txn, 30000, 30100, nullptr);
+        db.begin();
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    {
+        TestDb db("crash_db");
+        // 索引的修改不写日志，恢复之后需要重建
+        check(db, expected, false);
+        Transaction *txn = db.begin();
+        auto context = db.context(txn);
+        db.sm_manager->reindex_table(TAB, context.get());
+        db.commit(txn);
+        check(db, expected);
+        vacuum(db);
+        check(db, expected);
+        db.close();
+    }
+    {
+        TestDb db("crash_db");
+        check(db, expected);
+        db.close();
+    }
+}
+
+int main() {
+    enter_empty_dir("vacuum_test_dir");
+    test_vacuum_and_restart();
+    test_crash_during_vacuum();
+    printf("vacuum_test passed\n");
+    return 0;
+}
@@ -75,7 +75,7 @@ class IndexWriteRecord{
             memcpy(key_, key, size);
         }
      ~IndexWriteRecord() {
-        delete key_;
+        delete[] key_;
      }
 
     //  ~IndexWriteRecord() = default;